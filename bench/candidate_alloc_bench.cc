@@ -0,0 +1,93 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+// Counts heap allocations per keystroke through RimeProcessKey,
+// RimeGetContext and RimeGetContextSnapshot.
+//
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <rime_api.h>
+
+namespace {
+
+std::atomic<size_t> num_allocations{0};
+
+const char kInput[] =
+    "womendoushizhongguoren"
+    "tamenzaixuexiaolixuexizhongwen";
+
+const int kRepeat = 20;
+const int kEscape = 0xff1b;
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+  ++num_allocations;
+  if (void* p = std::malloc(size ? size : 1))
+    return p;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+  std::free(p);
+}
+
+int main(int argc, char* argv[]) {
+  const char* schema_id = argc > 1 ? argv[1] : "luna_pinyin";
+  RimeApi* rime = rime_get_api();
+  RIME_STRUCT(RimeTraits, traits);
+  traits.app_name = "rime.bench";
+  traits.shared_data_dir = ".";
+  traits.user_data_dir = ".";
+  rime->setup(&traits);
+  rime->initialize(NULL);
+  if (rime->start_maintenance(True))
+    rime->join_maintenance_thread();
+
+  RimeSessionId session_id = rime->create_session();
+  if (!session_id || !rime->select_schema(session_id, schema_id)) {
+    std::cerr << "failed to start a session with schema " << schema_id
+              << std::endl;
+    return 1;
+  }
+
+  size_t num_keys = 0;
+  size_t process_key_allocations = 0;
+  size_t get_context_allocations = 0;
+  size_t snapshot_allocations = 0;
+  RIME_STRUCT(RimeContextSnapshot, snapshot);
+  for (int i = 0; i < kRepeat; ++i) {
+    for (const char* p = kInput; *p; ++p) {
+      size_t before = num_allocations;
+      rime->process_key(session_id, *p, 0);
+      size_t after_process_key = num_allocations;
+      RIME_STRUCT(RimeContext, context);
+      if (rime->get_context(session_id, &context))
+        rime->free_context(&context);
+      size_t after_get_context = num_allocations;
+      rime->get_context_snapshot(session_id, &snapshot);
+      process_key_allocations += after_process_key - before;
+      get_context_allocations += after_get_context - after_process_key;
+      snapshot_allocations += num_allocations - after_get_context;
+      ++num_keys;
+    }
+    rime->process_key(session_id, kEscape, 0);
+  }
+  rime->free_context_snapshot(&snapshot);
+  std::cout << "allocations per keystroke" << std::endl
+            << "process_key\tget_context\tget_context_snapshot" << std::endl
+            << double(process_key_allocations) / num_keys << "\t"
+            << double(get_context_allocations) / num_keys << "\t"
+            << double(snapshot_allocations) / num_keys << std::endl;
+
+  rime->destroy_session(session_id);
+  rime->finalize();
+  return 0;
+}
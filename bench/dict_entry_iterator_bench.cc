@@ -0,0 +1,131 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+// Micro benchmark for merging dictionary chunks in DictEntryIterator.
+//
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <rime/common.h>
+#include <rime/dict/dictionary.h>
+
+using namespace rime;
+
+namespace {
+
+const size_t kEntriesPerChunk = 20;
+
+struct ChunkSet {
+  vector<vector<table::Entry>> entries;
+
+  explicit ChunkSet(size_t num_chunks) : entries(num_chunks) {
+    std::mt19937 rng(20110705);
+    std::uniform_real_distribution<float> weight(-20.f, 0.f);
+    for (auto& chunk_entries : entries) {
+      chunk_entries.resize(kEntriesPerChunk);
+      for (auto& e : chunk_entries) {
+        e.text.str_id() = 0;
+        e.weight = weight(rng);
+      }
+      // entries in a table chunk are sorted by weight desc
+      std::sort(chunk_entries.begin(), chunk_entries.end(),
+                [](const table::Entry& a, const table::Entry& b) {
+                  return a.weight > b.weight;
+                });
+    }
+  }
+
+  dictionary::Chunk MakeChunk(size_t i) const {
+    dictionary::Chunk chunk;
+    chunk.code.push_back(static_cast<SyllableId>(i));
+    chunk.entries = &entries[i][0];
+    chunk.size = entries[i].size();
+    chunk.credibility = -0.01 * (i % 7);
+    return chunk;
+  }
+};
+
+bool compare_chunk_by_head_element(const dictionary::Chunk& a,
+                                   const dictionary::Chunk& b) {
+  if (!a.entries || a.cursor >= a.size) return false;
+  if (!b.entries || b.cursor >= b.size) return true;
+  if (a.remaining_code.length() != b.remaining_code.length())
+    return a.remaining_code.length() < b.remaining_code.length();
+  return a.credibility + a.entries[a.cursor].weight >
+         b.credibility + b.entries[b.cursor].weight;
+}
+
+// the previous implementation: re-sorts remaining chunks on every step
+size_t IterateWithPartialSort(const ChunkSet& set) {
+  vector<dictionary::Chunk> chunks;
+  for (size_t i = 0; i < set.entries.size(); ++i) {
+    chunks.push_back(set.MakeChunk(i));
+  }
+  size_t chunk_index = 0;
+  auto sort = [&]() {
+    std::partial_sort(chunks.begin() + chunk_index,
+                      chunks.begin() + chunk_index + 1,
+                      chunks.end(),
+                      compare_chunk_by_head_element);
+  };
+  sort();
+  size_t count = 0;
+  while (chunk_index < chunks.size()) {
+    ++count;
+    auto& chunk(chunks[chunk_index]);
+    if (++chunk.cursor >= chunk.size) {
+      ++chunk_index;
+    }
+    else {
+      sort();
+    }
+  }
+  return count;
+}
+
+size_t IterateWithHeap(const ChunkSet& set) {
+  DictEntryIterator iter;
+  for (size_t i = 0; i < set.entries.size(); ++i) {
+    iter.AddChunk(set.MakeChunk(i), nullptr);
+  }
+  size_t count = 0;
+  while (!iter.exhausted()) {
+    ++count;
+    iter.Next();
+  }
+  return count;
+}
+
+template <class F>
+double Measure(F f, const ChunkSet& set, size_t repeat, size_t* count) {
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < repeat; ++i) {
+    *count = f(set);
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::micro>(end - start).count() /
+      repeat;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  std::cout << "chunks\tentries\tpartial_sort (us)\theap (us)" << std::endl;
+  for (size_t num_chunks : {10, 100, 1000}) {
+    ChunkSet set(num_chunks);
+    size_t repeat = 100000 / num_chunks;
+    size_t count1 = 0, count2 = 0;
+    double t1 = Measure(IterateWithPartialSort, set, repeat, &count1);
+    double t2 = Measure(IterateWithHeap, set, repeat, &count2);
+    if (count1 != count2) {
+      std::cerr << "entry count mismatch: " << count1 << " vs. " << count2
+                << std::endl;
+      return 1;
+    }
+    std::cout << num_chunks << "\t" << count1 << "\t"
+              << t1 << "\t" << t2 << std::endl;
+  }
+  return 0;
+}
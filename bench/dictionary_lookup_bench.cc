@@ -0,0 +1,171 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+// Micro benchmark for Dictionary::Lookup on a long input.
+//
+#include <chrono>
+#include <iostream>
+#include <queue>
+#include <rime/common.h>
+#include <rime/setup.h>
+#include <rime/algo/syllabifier.h>
+#include <rime/dict/dict_compiler.h>
+#include <rime/dict/dictionary.h>
+
+using namespace rime;
+
+namespace {
+
+// 30 syllables
+const char kInput[] =
+    "womendoushizhongguoren"
+    "womenaizhonghuarenmingongheguo"
+    "tamenzaixuexiaolixuexizhongwen"
+    "henyouyi";
+
+// exposes the table index to the legacy lookup
+class BenchTable : public Table {
+ public:
+  using Table::Table;
+  table::Index* index() const { return index_; }
+};
+
+size_t match_extra_code(const table::Code* extra_code, size_t depth,
+                        const SyllableGraph& syll_graph, size_t current_pos) {
+  if (!extra_code || depth >= extra_code->size)
+    return current_pos;
+  if (current_pos >= syll_graph.interpreted_length)
+    return 0;
+  auto index = syll_graph.indices.find(current_pos);
+  if (index == syll_graph.indices.end())
+    return 0;
+  auto spellings = index->second.find(extra_code->at[depth]);
+  if (spellings == index->second.end())
+    return 0;
+  size_t best_match = 0;
+  for (const SpellingProperties* props : spellings->second) {
+    size_t match_end_pos = match_extra_code(extra_code, depth + 1,
+                                            syll_graph, props->end_pos);
+    if (match_end_pos > best_match)
+      best_match = match_end_pos;
+  }
+  return best_match;
+}
+
+// the previous implementation: breadth-first search copying the query
+// state into a queue, collecting results in nested maps
+an<DictEntryCollector> LegacyLookup(BenchTable* table,
+                                    const SyllableGraph& syll_graph,
+                                    size_t start_pos) {
+  map<int, vector<TableAccessor>> result;
+  std::queue<pair<size_t, TableQuery>> q;
+  q.push({start_pos, TableQuery(table->index())});
+  while (!q.empty()) {
+    size_t current_pos = q.front().first;
+    TableQuery query(q.front().second);
+    q.pop();
+    auto index = syll_graph.indices.find(current_pos);
+    if (index == syll_graph.indices.end())
+      continue;
+    if (query.level() == Code::kIndexCodeMaxLength) {
+      TableAccessor accessor(query.Access(-1));
+      if (!accessor.exhausted())
+        result[current_pos].push_back(accessor);
+      continue;
+    }
+    for (const auto& spellings : index->second) {
+      SyllableId syll_id = spellings.first;
+      TableAccessor accessor(query.Access(syll_id));
+      for (auto props : spellings.second) {
+        size_t end_pos = props->end_pos;
+        if (!accessor.exhausted())
+          result[end_pos].push_back(accessor);
+        if (end_pos < syll_graph.interpreted_length &&
+            query.Advance(syll_id, props->credibility)) {
+          q.push({end_pos, query});
+          query.Backdate();
+        }
+      }
+    }
+  }
+  if (result.empty())
+    return nullptr;
+  auto collector = New<DictEntryCollector>();
+  for (auto& v : result) {
+    size_t end_pos = v.first;
+    for (TableAccessor& a : v.second) {
+      if (a.extra_code()) {
+        do {
+          size_t actual_end_pos = match_extra_code(
+              a.extra_code(), 0, syll_graph, end_pos);
+          if (actual_end_pos == 0) continue;
+          (*collector)[actual_end_pos].AddChunk(
+              {a.code(), a.entry(), a.credibility()}, table);
+        }
+        while (a.Next());
+      }
+      else {
+        (*collector)[end_pos].AddChunk({a, a.credibility()}, table);
+      }
+    }
+  }
+  return collector;
+}
+
+template <class F>
+double Measure(F f, const SyllableGraph& graph, size_t repeat,
+               size_t* count) {
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < repeat; ++i) {
+    *count = 0;
+    for (const auto& v : graph.vertices) {
+      if (auto collector = f(graph, v.first))
+        *count += collector->size();
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::micro>(end - start).count() /
+      repeat;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  SetupLogging("rime.bench");
+  LoadModules(kDefaultModules);
+
+  string dict_name = argc > 1 ? argv[1] : "luna_pinyin";
+  auto table = New<BenchTable>(dict_name + ".table.bin");
+  Dictionary dict(dict_name,
+                  table,
+                  New<Prism>(dict_name + ".prism.bin"));
+  DictCompiler dict_compiler(&dict);
+  if (!dict_compiler.Compile("") || !dict.Load()) {
+    std::cerr << "failed to load dictionary " << dict_name << std::endl;
+    return 1;
+  }
+
+  SyllableGraph graph;
+  Syllabifier syllabifier;
+  syllabifier.BuildSyllableGraph(kInput, *dict.prism(), &graph);
+  std::cout << "input: " << kInput << " (" << graph.vertices.size()
+            << " vertices)" << std::endl;
+
+  const size_t kRepeat = 200;
+  size_t count1 = 0, count2 = 0;
+  double t1 = Measure([&](const SyllableGraph& g, size_t start_pos) {
+    return LegacyLookup(table.get(), g, start_pos);
+  }, graph, kRepeat, &count1);
+  double t2 = Measure([&](const SyllableGraph& g, size_t start_pos) {
+    return dict.Lookup(g, start_pos);
+  }, graph, kRepeat, &count2);
+  if (count1 != count2) {
+    std::cerr << "result mismatch: " << count1 << " vs. " << count2
+              << std::endl;
+    return 1;
+  }
+  std::cout << "map + queue (us)\tflat (us)" << std::endl
+            << t1 << "\t" << t2 << std::endl;
+  return 0;
+}
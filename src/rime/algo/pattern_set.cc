@@ -0,0 +1,567 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+#include <algorithm>
+#include <cctype>
+#include <rime/algo/pattern_set.h>
+
+namespace rime {
+
+using Charset = std::bitset<256>;
+
+namespace {
+
+const int kMaxRepeat = 32;
+const size_t kMaxNfaStates = 4096;
+
+struct Node {
+  enum Kind { kBytes, kConcat, kAlternate, kRepeat };
+  Kind kind;
+  Charset bytes;
+  vector<an<Node>> children;
+  int min = 0;
+  int max = -1;  // unbounded
+
+  explicit Node(Kind k) : kind(k) {}
+};
+
+struct Alternative {
+  an<Node> body;
+  bool starts_at_begin = false;
+  bool ends_at_end = false;
+};
+
+Charset MakeRange(int first, int last) {
+  Charset charset;
+  for (int c = first; c <= last; ++c)
+    charset.set(c);
+  return charset;
+}
+
+// \d, \w, \s and their complements; false for other escapes
+bool ClassEscape(char c, Charset* charset) {
+  Charset digits = MakeRange('0', '9');
+  Charset word = digits | MakeRange('A', 'Z') | MakeRange('a', 'z');
+  word.set('_');
+  Charset space;
+  for (char s : {' ', '\t', '\n', '\v', '\f', '\r'})
+    space.set(static_cast<unsigned char>(s));
+  switch (c) {
+    case 'd': *charset = digits; return true;
+    case 'D': *charset = ~digits; return true;
+    case 'w': *charset = word; return true;
+    case 'W': *charset = ~word; return true;
+    case 's': *charset = space; return true;
+    case 'S': *charset = ~space; return true;
+  }
+  return false;
+}
+
+// a literal character written as an escape sequence; false for escapes
+// with special meanings, eg. \b or \1
+bool LiteralEscape(char c, unsigned char* literal) {
+  switch (c) {
+    case 'n': *literal = '\n'; return true;
+    case 't': *literal = '\t'; return true;
+    case 'r': *literal = '\r'; return true;
+    case 'f': *literal = '\f'; return true;
+    case 'v': *literal = '\v'; return true;
+  }
+  if (std::isalnum(static_cast<unsigned char>(c)))
+    return false;
+  *literal = static_cast<unsigned char>(c);
+  return true;
+}
+
+}  // namespace
+
+class PatternParser {
+ public:
+  explicit PatternParser(const string& pattern)
+      : pattern_(pattern) {}
+
+  bool Parse(vector<Alternative>* alternatives);
+
+ private:
+  bool done() const { return pos_ >= pattern_.length(); }
+  char peek() const { return pattern_[pos_]; }
+
+  an<Node> ParseAlternation();
+  an<Node> ParseSequence(Alternative* top_level);
+  an<Node> ParseAtom();
+  bool ParseQuantifier(an<Node>* atom);
+  bool ParseClass(Charset* charset);
+  bool ParseNumber(int* number);
+
+  const string& pattern_;
+  size_t pos_ = 0;
+};
+
+bool PatternParser::Parse(vector<Alternative>* alternatives) {
+  while (true) {
+    Alternative alternative;
+    alternative.body = ParseSequence(&alternative);
+    if (!alternative.body)
+      return false;
+    alternatives->push_back(alternative);
+    if (done())
+      return true;
+    if (peek() != '|')
+      return false;
+    ++pos_;
+  }
+}
+
+an<Node> PatternParser::ParseAlternation() {
+  auto alternation = New<Node>(Node::kAlternate);
+  while (true) {
+    auto sequence = ParseSequence(nullptr);
+    if (!sequence)
+      return nullptr;
+    alternation->children.push_back(sequence);
+    if (done() || peek() != '|')
+      break;
+    ++pos_;
+  }
+  return alternation->children.size() == 1 ?
+      alternation->children[0] : alternation;
+}
+
+an<Node> PatternParser::ParseSequence(Alternative* top_level) {
+  auto sequence = New<Node>(Node::kConcat);
+  if (top_level && !done() && peek() == '^') {
+    top_level->starts_at_begin = true;
+    ++pos_;
+  }
+  while (!done() && peek() != '|' && peek() != ')') {
+    if (peek() == '$') {
+      ++pos_;
+      // only allowed at the end of a top-level alternative
+      if (!top_level || !(done() || peek() == '|'))
+        return nullptr;
+      top_level->ends_at_end = true;
+      break;
+    }
+    auto atom = ParseAtom();
+    if (!atom || !ParseQuantifier(&atom))
+      return nullptr;
+    sequence->children.push_back(atom);
+  }
+  return sequence;
+}
+
+an<Node> PatternParser::ParseAtom() {
+  char c = pattern_[pos_++];
+  auto bytes = New<Node>(Node::kBytes);
+  switch (c) {
+    case '(': {
+      if (!done() && peek() == '?') {
+        // only non-capturing groups; no look-around or flags
+        if (pos_ + 1 >= pattern_.length() || pattern_[pos_ + 1] != ':')
+          return nullptr;
+        pos_ += 2;
+      }
+      auto group = ParseAlternation();
+      if (!group || done() || peek() != ')')
+        return nullptr;
+      ++pos_;
+      return group;
+    }
+    case '[':
+      if (!ParseClass(&bytes->bytes))
+        return nullptr;
+      return bytes;
+    case '.':
+      bytes->bytes.set();
+      return bytes;
+    case '\\': {
+      if (done())
+        return nullptr;
+      char e = pattern_[pos_++];
+      unsigned char literal;
+      if (ClassEscape(e, &bytes->bytes))
+        return bytes;
+      if (!LiteralEscape(e, &literal))
+        return nullptr;
+      bytes->bytes.set(literal);
+      return bytes;
+    }
+    case '^': case '$': case '*': case '+': case '?': case '{': case ')':
+    case '|': case ']': case '}':
+      return nullptr;
+  }
+  bytes->bytes.set(static_cast<unsigned char>(c));
+  return bytes;
+}
+
+bool PatternParser::ParseQuantifier(an<Node>* atom) {
+  if (done())
+    return true;
+  int min = 0, max = -1;
+  switch (peek()) {
+    case '*': ++pos_; break;
+    case '+': ++pos_; min = 1; break;
+    case '?': ++pos_; max = 1; break;
+    case '{':
+      ++pos_;
+      if (!ParseNumber(&min))
+        return false;
+      max = min;
+      if (!done() && peek() == ',') {
+        ++pos_;
+        max = -1;
+        if (!done() && peek() != '}' && !ParseNumber(&max))
+          return false;
+      }
+      if (done() || peek() != '}' || min > kMaxRepeat ||
+          (max != -1 && (max < min || max > kMaxRepeat)))
+        return false;
+      ++pos_;
+      break;
+    default:
+      return true;
+  }
+  if (!done()) {
+    // a lazy quantifier matches the same texts, but possessive ones do not
+    if (peek() == '?')
+      ++pos_;
+    else if (peek() == '+')
+      return false;
+  }
+  if (!done() && (peek() == '*' || peek() == '+' || peek() == '?' ||
+                  peek() == '{'))
+    return false;
+  auto repeat = New<Node>(Node::kRepeat);
+  repeat->children.push_back(*atom);
+  repeat->min = min;
+  repeat->max = max;
+  *atom = repeat;
+  return true;
+}
+
+bool PatternParser::ParseClass(Charset* charset) {
+  bool negated = false;
+  if (!done() && peek() == '^') {
+    negated = true;
+    ++pos_;
+  }
+  bool first = true;
+  while (!done()) {
+    char c = pattern_[pos_++];
+    if (c == ']' && !first) {
+      if (negated)
+        charset->flip();
+      return true;
+    }
+    first = false;
+    int low = static_cast<unsigned char>(c);
+    if (c == '[') {
+      // [:alpha:] and the like
+      if (!done() && (peek() == ':' || peek() == '=' || peek() == '.'))
+        return false;
+    }
+    else if (c == '\\') {
+      if (done())
+        return false;
+      char e = pattern_[pos_++];
+      Charset escaped;
+      if (ClassEscape(e, &escaped)) {
+        *charset |= escaped;
+        continue;
+      }
+      unsigned char literal;
+      if (!LiteralEscape(e, &literal))
+        return false;
+      low = literal;
+    }
+    if (pos_ + 1 < pattern_.length() && peek() == '-' &&
+        pattern_[pos_ + 1] != ']') {
+      ++pos_;
+      int high = static_cast<unsigned char>(pattern_[pos_++]);
+      if (high == '\\') {
+        unsigned char literal;
+        if (done() || !LiteralEscape(pattern_[pos_++], &literal))
+          return false;
+        high = literal;
+      }
+      else if (high == '[') {
+        return false;
+      }
+      if (high < low)
+        return false;
+      *charset |= MakeRange(low, high);
+    }
+    else {
+      charset->set(low);
+    }
+  }
+  return false;
+}
+
+bool PatternParser::ParseNumber(int* number) {
+  if (done() || !std::isdigit(static_cast<unsigned char>(peek())))
+    return false;
+  *number = 0;
+  while (!done() && std::isdigit(static_cast<unsigned char>(peek()))) {
+    *number = *number * 10 + (pattern_[pos_++] - '0');
+    if (*number > kMaxRepeat)
+      return false;
+  }
+  return true;
+}
+
+// builds the states of a pattern that read the input backwards
+class ReversedNfaBuilder {
+ public:
+  explicit ReversedNfaBuilder(PatternSet* set) : set_(set) {}
+
+  // returns the first of the states that match node, then go on to next,
+  // or -1 if there would be too many states.
+  int Build(const Node& node, int next);
+  int Accept(int id, bool anchored);
+
+ private:
+  int Split(vector<int> outs);
+
+  PatternSet* set_;
+};
+
+int ReversedNfaBuilder::Build(const Node& node, int next) {
+  if (next < 0)
+    return -1;
+  switch (node.kind) {
+    case Node::kBytes: {
+      PatternSet::NfaState state;
+      state.charset = set_->AddCharset(node.bytes);
+      state.out = next;
+      return set_->AddState(state);
+    }
+    case Node::kConcat: {
+      // the last child is read first
+      int state = next;
+      for (const auto& child : node.children) {
+        state = Build(*child, state);
+      }
+      return state;
+    }
+    case Node::kAlternate: {
+      vector<int> branches;
+      for (const auto& child : node.children) {
+        int branch = Build(*child, next);
+        if (branch < 0)
+          return -1;
+        branches.push_back(branch);
+      }
+      return Split(branches);
+    }
+    case Node::kRepeat:
+      break;
+  }
+  const Node& child(*node.children[0]);
+  int state = next;
+  if (node.max == -1) {
+    int loop = Split({});
+    int body = Build(child, loop);
+    if (body < 0)
+      return -1;
+    set_->nfa_[loop].epsilon = {body, next};
+    state = loop;
+  }
+  else {
+    for (int i = node.min; i < node.max; ++i) {
+      state = Split({Build(child, state), state});
+    }
+  }
+  for (int i = 0; i < node.min; ++i) {
+    state = Build(child, state);
+  }
+  return state;
+}
+
+int ReversedNfaBuilder::Accept(int id, bool anchored) {
+  PatternSet::NfaState state;
+  state.accept = id;
+  state.anchored = anchored;
+  return set_->AddState(state);
+}
+
+int ReversedNfaBuilder::Split(vector<int> outs) {
+  for (int out : outs) {
+    if (out < 0)
+      return -1;
+  }
+  PatternSet::NfaState state;
+  state.epsilon = std::move(outs);
+  return set_->AddState(state);
+}
+
+int PatternSet::Add(const string& pattern, bool match_whole) {
+  vector<Alternative> alternatives;
+  PatternParser parser(pattern);
+  if (!parser.Parse(&alternatives))
+    return -1;
+  for (const auto& alternative : alternatives) {
+    if (!match_whole && !alternative.ends_at_end)
+      return -1;
+  }
+  int id = static_cast<int>(num_patterns_);
+  size_t num_states = nfa_.size();
+  size_t num_starts = starts_.size();
+  ReversedNfaBuilder builder(this);
+  for (const auto& alternative : alternatives) {
+    int accept = builder.Accept(
+        id, match_whole || alternative.starts_at_begin);
+    int start = builder.Build(*alternative.body, accept);
+    if (start < 0) {
+      LOG(WARNING) << "pattern too large: " << pattern;
+      nfa_.resize(num_states);
+      starts_.resize(num_starts);
+      return -1;
+    }
+    starts_.push_back(start);
+  }
+  dfa_.clear();
+  transitions_.clear();
+  ++num_patterns_;
+  return id;
+}
+
+int PatternSet::AddCharset(const Charset& charset) {
+  auto it = std::find(charsets_.begin(), charsets_.end(), charset);
+  if (it != charsets_.end())
+    return static_cast<int>(it - charsets_.begin());
+  charsets_.push_back(charset);
+  return static_cast<int>(charsets_.size() - 1);
+}
+
+int PatternSet::AddState(NfaState state) {
+  if (nfa_.size() >= kMaxNfaStates)
+    return -1;
+  nfa_.push_back(std::move(state));
+  return static_cast<int>(nfa_.size() - 1);
+}
+
+void PatternSet::Closure(vector<int>* states) const {
+  vector<bool> visited(nfa_.size());
+  vector<int> stack(*states);
+  states->clear();
+  while (!stack.empty()) {
+    int s = stack.back();
+    stack.pop_back();
+    if (visited[s])
+      continue;
+    visited[s] = true;
+    const NfaState& state(nfa_[s]);
+    if (state.epsilon.empty())
+      states->push_back(s);
+    for (int out : state.epsilon) {
+      if (!visited[out])
+        stack.push_back(out);
+    }
+  }
+  std::sort(states->begin(), states->end());
+}
+
+bool PatternSet::Compile() {
+  dfa_.clear();
+  transitions_.clear();
+  if (starts_.empty())
+    return false;
+  // bytes that belong to the same charsets are not told apart
+  map<vector<bool>, uint8_t> class_of;
+  for (int c = 0; c < 256; ++c) {
+    vector<bool> signature(charsets_.size());
+    for (size_t i = 0; i < charsets_.size(); ++i)
+      signature[i] = charsets_[i].test(c);
+    auto it = class_of.find(signature);
+    if (it == class_of.end())
+      it = class_of.emplace(signature, uint8_t(class_of.size())).first;
+    classes_[c] = it->second;
+  }
+  num_classes_ = class_of.size();
+  vector<int> representative(num_classes_);
+  for (int c = 255; c >= 0; --c)
+    representative[classes_[c]] = c;
+
+  map<vector<int>, int> dfa_index;
+  vector<vector<int>> pending;
+  auto add_dfa_state = [&](vector<int> states) {
+    auto found = dfa_index.find(states);
+    if (found != dfa_index.end())
+      return found->second;
+    int index = static_cast<int>(dfa_.size());
+    DfaState dfa_state;
+    for (int s : states) {
+      const NfaState& state(nfa_[s]);
+      if (state.accept < 0)
+        continue;
+      auto& accepts(state.anchored ? dfa_state.anchored_accepts
+                                   : dfa_state.accepts);
+      if (std::find(accepts.begin(), accepts.end(), state.accept) ==
+          accepts.end())
+        accepts.push_back(state.accept);
+    }
+    dfa_.push_back(dfa_state);
+    transitions_.resize(dfa_.size() * num_classes_, -1);
+    dfa_index[states] = index;
+    pending.push_back(states);
+    return index;
+  };
+  vector<int> initial(starts_);
+  Closure(&initial);
+  add_dfa_state(initial);
+  for (size_t i = 0; i < pending.size(); ++i) {
+    if (dfa_.size() > kMaxStates) {
+      LOG(WARNING) << "too many states compiling " << num_patterns_
+                   << " patterns.";
+      dfa_.clear();
+      transitions_.clear();
+      return false;
+    }
+    for (size_t k = 0; k < num_classes_; ++k) {
+      int c = representative[k];
+      vector<int> next;
+      for (int s : pending[i]) {
+        const NfaState& state(nfa_[s]);
+        if (state.charset >= 0 && charsets_[state.charset].test(c))
+          next.push_back(state.out);
+      }
+      if (next.empty())
+        continue;
+      Closure(&next);
+      int target = add_dfa_state(next);
+      transitions_[i * num_classes_ + k] = target;
+    }
+  }
+  return true;
+}
+
+void PatternSet::Match(const string& input,
+                       size_t from,
+                       vector<size_t>* starts) const {
+  starts->assign(num_patterns_, string::npos);
+  if (dfa_.empty() || from > input.length())
+    return;
+  auto record = [&](int state, size_t pos) {
+    for (int id : dfa_[state].accepts)
+      (*starts)[id] = pos;
+    if (pos == from) {
+      for (int id : dfa_[state].anchored_accepts)
+        (*starts)[id] = pos;
+    }
+  };
+  int state = 0;
+  size_t pos = input.length();
+  record(state, pos);
+  while (pos > from) {
+    --pos;
+    unsigned char c = static_cast<unsigned char>(input[pos]);
+    state = transitions_[state * num_classes_ + classes_[c]];
+    if (state < 0)
+      break;
+    record(state, pos);
+  }
+}
+
+}  // namespace rime
@@ -0,0 +1,80 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+#ifndef RIME_PATTERN_SET_H_
+#define RIME_PATTERN_SET_H_
+
+#include <stdint.h>
+#include <bitset>
+#include <rime_api.h>
+#include <rime/common.h>
+
+namespace rime {
+
+// Regular expressions compiled together into one DFA, which reads the
+// input once, from the end backwards, and finds for every pattern the
+// leftmost position a match ending at the end of input starts at.
+//
+// Patterns are in the syntax of boost::regex, limited to what a DFA can do:
+// literals, '.', character classes, groups, alternation and quantifiers.
+// '^' may only start, and '$' only end a top-level alternative. Patterns
+// using anything else, eg. back references or look-around assertions, are
+// not added; the caller is expected to match them with boost::regex.
+class PatternSet {
+ public:
+  // the most DFA states to build before giving up
+  static const size_t kMaxStates = 1024;
+
+  // adds a pattern whose matches, like with boost::regex_search(), should
+  // end at the end of input; each alternative of it has to end with '$'.
+  // with match_whole, the pattern should match the whole input instead,
+  // like with boost::regex_match().
+  // returns the index of the pattern, or -1 if it cannot be added.
+  RIME_API int Add(const string& pattern, bool match_whole = false);
+  // builds the DFA; on failure, no pattern will be matched.
+  RIME_API bool Compile();
+  // for each pattern, sets the start of its leftmost match in
+  // input[from, end), or string::npos if there is none.
+  RIME_API void Match(const string& input,
+                      size_t from,
+                      vector<size_t>* starts) const;
+
+  size_t size() const { return num_patterns_; }
+  bool empty() const { return num_patterns_ == 0; }
+  bool compiled() const { return !dfa_.empty(); }
+
+ private:
+  struct NfaState {
+    int charset = -1;
+    int out = -1;
+    vector<int> epsilon;
+    int accept = -1;
+    bool anchored = false;
+  };
+  struct DfaState {
+    vector<int> accepts;
+    // patterns that match only at the start of input
+    vector<int> anchored_accepts;
+  };
+  friend class ReversedNfaBuilder;
+
+  int AddCharset(const std::bitset<256>& charset);
+  int AddState(NfaState state);
+  void Closure(vector<int>* states) const;
+
+  size_t num_patterns_ = 0;
+  vector<std::bitset<256>> charsets_;
+  vector<NfaState> nfa_;
+  vector<int> starts_;
+  // dfa
+  uint8_t classes_[256] = {};
+  size_t num_classes_ = 0;
+  vector<DfaState> dfa_;
+  // indexed by state * num_classes_ + class; -1 for no match
+  vector<int> transitions_;
+};
+
+}  // namespace rime
+
+#endif  // RIME_PATTERN_SET_H_
@@ -5,9 +5,11 @@
 // 2011-07-12 Zou Xu <zouivex@gmail.com>
 // 2012-02-11 GONG Chen <chen.sst@gmail.com>
 //
+#include <algorithm>
 #include <queue>
 #include <boost/range/adaptor/reversed.hpp>
 #include <rime/algo/syllabifier.h>
+#include <rime/algo/utilities.h>
 #include <rime/dict/corrector.h>
 #include <rime/dict/prism.h>
 #include "syllabifier.h"
@@ -29,6 +31,14 @@ int Syllabifier::BuildSyllableGraph(const string &input,
   if (input.empty())
     return 0;
 
+  // spellings matched in the last input stay the same where the search
+  // has only examined the part of input that has not changed
+  size_t stable_length = 0;
+  if (&prism == last_prism_ && !corrector_) {
+    stable_length = CommonPrefixLength(input, last_input_);
+  }
+  vector<PrefixMatches> prefix_matches(input.length() + 1);
+
   size_t farthest = 0;
   VertexQueue queue;
   queue.push(Vertex{0, kNormalSpelling});  // start
@@ -55,19 +65,23 @@ int Syllabifier::BuildSyllableGraph(const string &input,
     vector<Prism::Match> matches;
     set<SyllableId> exact_match_syllables;
     auto current_input = input.substr(current_pos);
-    prism.CommonPrefixSearch(current_input, &matches);
+    auto& found(prefix_matches[current_pos]);
+    MatchSpellings(prism, input, current_pos, stable_length, &found);
+    for (const auto& m : found.spellings) {
+      matches.push_back({m.first, m.second});
+    }
     if (corrector_) {
       for (auto &m : matches) {
         exact_match_syllables.insert(m.value);
       }
       Corrections corrections;
       corrector_->ToleranceSearch(prism, current_input, &corrections, 5);
-      for (const auto &m : corrections) {
-        for (auto accessor = prism.QuerySpelling(m.first);
+      for (const auto &c : corrections) {
+        for (auto accessor = prism.QuerySpelling(c.syllable);
              !accessor.exhausted();
              accessor.Next()) {
           if (accessor.properties().type == kNormalSpelling) {
-            matches.push_back({ m.first, m.second.length });
+            matches.push_back({ c.syllable, c.length });
             break;
           }
         }
@@ -242,10 +256,46 @@ int Syllabifier::BuildSyllableGraph(const string &input,
   DLOG(INFO) << "syllabified length: " << graph->interpreted_length;
 
   Transpose(graph);
+  graph->Flatten();
 
+  last_input_ = input;
+  last_prism_ = &prism;
+  last_matches_.swap(prefix_matches);
   return farthest;
 }
 
+void Syllabifier::MatchSpellings(Prism& prism,
+                                 const string& input,
+                                 size_t pos,
+                                 size_t stable_length,
+                                 PrefixMatches* result) {
+  if (pos < last_matches_.size()) {
+    auto& last(last_matches_[pos]);
+    if (last.searched && last.examined_end <= stable_length) {
+      *result = std::move(last);
+      return;
+    }
+  }
+  result->searched = true;
+  result->spellings.clear();
+  const auto& trie(prism.trie());
+  const char* key = input.c_str() + pos;
+  size_t key_length = input.length() - pos;
+  size_t node_pos = 0;
+  size_t key_pos = 0;
+  while (key_pos < key_length) {
+    auto value = trie.traverse(key, node_pos, key_pos, key_pos + 1);
+    if (value == -2) {
+      // no spelling goes on with the byte at key_pos
+      result->examined_end = pos + key_pos + 1;
+      return;
+    }
+    if (value >= 0)
+      result->spellings.push_back({value, key_pos});
+  }
+  result->examined_end = input.length() + 1;
+}
+
 void Syllabifier::CheckOverlappedSpellings(SyllableGraph *graph,
                                            size_t start, size_t end) {
   const double kPenaltyForAmbiguousSyllable = -23.025850929940457; // log(1e-10)
@@ -289,8 +339,107 @@ void Syllabifier::Transpose(SyllableGraph* graph) {
   }
 }
 
+void FlatSyllableGraph::Clear() {
+  vertices.clear();
+  edge_offsets.clear();
+  edges.clear();
+  index.clear();
+}
+
+const SyllableEdge* FlatSyllableGraph::FindEdge(size_t start_pos,
+                                                size_t end_pos,
+                                                SyllableId syllable_id) const {
+  auto first = edges_begin(start_pos);
+  auto last = edges_end(start_pos);
+  auto it = std::lower_bound(
+      first, last, make_pair(end_pos, syllable_id),
+      [](const SyllableEdge& edge, const pair<size_t, SyllableId>& key) {
+        return edge.properties.end_pos < key.first ||
+            (edge.properties.end_pos == key.first &&
+             edge.syllable_id < key.second);
+      });
+  if (it == last ||
+      it->properties.end_pos != end_pos ||
+      it->syllable_id != syllable_id)
+    return nullptr;
+  return it;
+}
+
+void SyllableGraph::Flatten() {
+  auto& flat(flat_);
+  flat.Clear();
+  size_t length = interpreted_length;
+  if (!vertices.empty())
+    length = (std::max)(length, vertices.rbegin()->first);
+  if (!edges.empty())
+    length = (std::max)(length, edges.rbegin()->first);
+  flat.vertices.resize(length + 1, kInvalidSpelling);
+  for (const auto& v : vertices) {
+    flat.vertices[v.first] = v.second;
+  }
+  flat.edge_offsets.reserve(length + 2);
+  for (size_t pos = 0; pos <= length; ++pos) {
+    size_t offset = flat.edges.size();
+    flat.edge_offsets.push_back(offset);
+    auto start = edges.find(pos);
+    if (start == edges.end())
+      continue;
+    for (const auto& end : start->second) {
+      for (const auto& spelling : end.second) {
+        flat.edges.push_back({spelling.first, spelling.second});
+        // in case the end position was not filled in
+        flat.edges.back().properties.end_pos = end.first;
+        flat.index.push_back(flat.edges.size() - 1);
+      }
+    }
+    const auto& flat_edges(flat.edges);
+    std::stable_sort(flat.index.begin() + offset, flat.index.end(),
+                     [&flat_edges](size_t a, size_t b) {
+                       const auto& x(flat_edges[a]);
+                       const auto& y(flat_edges[b]);
+                       return x.syllable_id < y.syllable_id ||
+                           (x.syllable_id == y.syllable_id &&
+                            x.properties.end_pos > y.properties.end_pos);
+                     });
+  }
+  flat.edge_offsets.push_back(flat.edges.size());
+}
+
+static bool same_edge(const SyllableEdge& a, const SyllableEdge& b) {
+  return a.syllable_id == b.syllable_id &&
+      a.properties.end_pos == b.properties.end_pos &&
+      a.properties.type == b.properties.type &&
+      a.properties.credibility == b.properties.credibility &&
+      a.properties.is_correction == b.properties.is_correction;
+}
+
+size_t SyllableGraph::CommonPrefixLength(const SyllableGraph& other) const {
+  size_t limit = (std::min)(interpreted_length, other.interpreted_length);
+  const auto& graph(flat());
+  const auto& other_graph(other.flat());
+  size_t pos = 0;
+  for (; pos < limit; ++pos) {
+    auto first = graph.edges_begin(pos);
+    auto last = graph.edges_end(pos);
+    auto other_first = other_graph.edges_begin(pos);
+    auto other_last = other_graph.edges_end(pos);
+    if (last - first != other_last - other_first ||
+        !std::equal(first, last, other_first, same_edge))
+      break;
+  }
+  return pos;
+}
+
 void Syllabifier::EnableCorrection(Corrector* corrector) {
   corrector_ = corrector;
 }
 
+void Syllabifier::TakeMatches(Syllabifier* other) {
+  if (!other || other == this)
+    return;
+  last_input_.swap(other->last_input_);
+  std::swap(last_prism_, other->last_prism_);
+  last_matches_.swap(other->last_matches_);
+}
+
 }  // namespace rime
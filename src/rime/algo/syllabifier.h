@@ -34,12 +34,79 @@ using SpellingPropertiesList = vector<const EdgeProperties*>;
 using SpellingIndex = map<SyllableId, SpellingPropertiesList>;
 using SpellingIndices = map<size_t, SpellingIndex>;
 
+struct SyllableEdge {
+  SyllableId syllable_id;
+  EdgeProperties properties;
+};
+
+// compact representation of a syllable graph.
+// edges starting at position pos are stored contiguously in
+// edges[edge_offsets[pos], edge_offsets[pos + 1]), sorted by end position
+// and syllable id. index refers to the same range of edges sorted by
+// syllable id, and longer spellings first.
+struct FlatSyllableGraph {
+  vector<SpellingType> vertices;  // kInvalidSpelling for non-vertices
+  vector<size_t> edge_offsets;
+  vector<SyllableEdge> edges;
+  vector<size_t> index;
+
+  void Clear();
+
+  bool HasVertex(size_t pos) const {
+    return pos < vertices.size() && vertices[pos] != kInvalidSpelling;
+  }
+  const SyllableEdge* edges_begin(size_t pos) const {
+    return edges.data() + offset(pos);
+  }
+  const SyllableEdge* edges_end(size_t pos) const {
+    return edges.data() + offset(pos + 1);
+  }
+  const size_t* index_begin(size_t pos) const {
+    return index.data() + offset(pos);
+  }
+  const size_t* index_end(size_t pos) const {
+    return index.data() + offset(pos + 1);
+  }
+  RIME_API const SyllableEdge* FindEdge(size_t start_pos,
+                                        size_t end_pos,
+                                        SyllableId syllable_id) const;
+
+ private:
+  size_t offset(size_t pos) const {
+    return pos < edge_offsets.size() ? edge_offsets[pos] : edges.size();
+  }
+};
+
 struct SyllableGraph {
   size_t input_length = 0;
   size_t interpreted_length = 0;
+  // map-based view, in which the graph is built
   VertexMap vertices;
   EdgeMap edges;
   SpellingIndices indices;
+
+  // the same graph in compact form, for faster traversal.
+  // Syllabifier makes it at the end of BuildSyllableGraph(); a graph
+  // assembled or modified otherwise has to be flattened again.
+  const FlatSyllableGraph& flat() const { return flat_; }
+  // (re)builds the compact form from the map-based view
+  RIME_API void Flatten();
+  // number of leading positions from which both graphs have identical
+  // outgoing edges, not exceeding either interpreted length
+  RIME_API size_t CommonPrefixLength(const SyllableGraph& other) const;
+
+ private:
+  FlatSyllableGraph flat_;
+};
+
+// spellings that are prefixes of the input at some position
+struct PrefixMatches {
+  // spelling id and length of each match
+  vector<pair<SyllableId, size_t>> spellings;
+  // end of the part of input examined by the search, or one past the end
+  // of input if the search would go on with more input
+  size_t examined_end = 0;
+  bool searched = false;
 };
 
 class Syllabifier {
@@ -57,8 +124,13 @@ class Syllabifier {
                                   Prism &prism,
                                   SyllableGraph *graph);
   RIME_API void EnableCorrection(Corrector* corrector);
+  // takes over the spellings matched by another syllabifier with the same
+  // settings, to save searching them again for the next input
+  RIME_API void TakeMatches(Syllabifier* other);
 
  protected:
+  void MatchSpellings(Prism& prism, const string& input, size_t pos,
+                      size_t stable_length, PrefixMatches* result);
   void CheckOverlappedSpellings(SyllableGraph *graph,
                                 size_t start, size_t end);
   void Transpose(SyllableGraph* graph);
@@ -67,6 +139,11 @@ class Syllabifier {
   bool enable_completion_ = false;
   bool strict_spelling_ = false;
   Corrector* corrector_ = nullptr;
+  // spellings matched at each position of the last input; those found
+  // without examining the part of input that has changed are reused
+  string last_input_;
+  const Prism* last_prism_ = nullptr;
+  vector<PrefixMatches> last_matches_;
 };
 
 }  // namespace rime
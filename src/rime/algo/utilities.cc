@@ -4,6 +4,7 @@
 //
 // 2013-01-30 GONG Chen <chen.sst@gmail.com>
 //
+#include <algorithm>
 #include <fstream>
 #include <boost/algorithm/string.hpp>
 #include <rime/algo/utilities.h>
@@ -30,6 +31,14 @@ int CompareVersionString(const string& x, const string& y) {
   return 0;
 }
 
+size_t CommonPrefixLength(const string& x, const string& y) {
+  size_t length = (std::min)(x.length(), y.length());
+  size_t i = 0;
+  while (i < length && x[i] == y[i])
+    ++i;
+  return i;
+}
+
 void ChecksumComputer::ProcessFile(const string& file_name) {
   std::ifstream fin(file_name.c_str());
   string file_content((std::istreambuf_iterator<char>(fin)),
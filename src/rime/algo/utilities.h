@@ -16,6 +16,9 @@ namespace rime {
 int CompareVersionString(const string& x,
                          const string& y);
 
+// length of the longest common prefix of two strings
+size_t CommonPrefixLength(const string& x, const string& y);
+
 class ChecksumComputer {
  public:
   void ProcessFile(const string& file_name);
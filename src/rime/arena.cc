@@ -0,0 +1,87 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <rime/arena.h>
+
+namespace rime {
+
+struct CompositionArena::Block {
+  // objects allocated from the block, plus one while it is current
+  std::atomic<size_t> refs{1};
+};
+
+// every object is preceded by a pointer to its block
+static const size_t kAlignment = alignof(std::max_align_t);
+static const size_t kHeaderSize =
+    (sizeof(void*) + kAlignment - 1) / kAlignment * kAlignment;
+static const size_t kBlockHeaderSize =
+    (sizeof(std::atomic<size_t>) + kAlignment - 1) / kAlignment * kAlignment;
+
+static std::atomic<size_t> live_blocks{0};
+
+static thread_local CompositionArena* current_arena = nullptr;
+
+template <class Block>
+static void release(Block* block) {
+  if (block->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    block->~Block();
+    ::operator delete(block);
+    --live_blocks;
+  }
+}
+
+CompositionArena::~CompositionArena() {
+  Reset();
+}
+
+void* CompositionArena::Allocate(size_t size) {
+  size_t total = (kHeaderSize + size + kAlignment - 1) / kAlignment *
+      kAlignment;
+  if (!block_ || used_ + total > kBlockSize) {
+    Reset();
+    block_ = new (::operator new(kBlockSize)) Block;
+    used_ = kBlockHeaderSize;
+    ++live_blocks;
+  }
+  char* p = reinterpret_cast<char*>(block_) + used_;
+  *reinterpret_cast<Block**>(p) = block_;
+  block_->refs.fetch_add(1, std::memory_order_relaxed);
+  used_ += total;
+  return p + kHeaderSize;
+}
+
+void CompositionArena::Deallocate(void* ptr) {
+  char* p = static_cast<char*>(ptr) - kHeaderSize;
+  release(*reinterpret_cast<Block**>(p));
+}
+
+void CompositionArena::Reset() {
+  if (block_) {
+    release(block_);
+    block_ = nullptr;
+    used_ = 0;
+  }
+}
+
+CompositionArena* CompositionArena::current() {
+  return current_arena;
+}
+
+size_t CompositionArena::num_live_blocks() {
+  return live_blocks;
+}
+
+ArenaScope::ArenaScope(CompositionArena* arena)
+    : previous_(current_arena) {
+  current_arena = arena;
+}
+
+ArenaScope::~ArenaScope() {
+  current_arena = previous_;
+}
+
+}  // namespace rime
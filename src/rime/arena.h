@@ -0,0 +1,119 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+#ifndef RIME_ARENA_H_
+#define RIME_ARENA_H_
+
+#include <stddef.h>
+#include <rime_api.h>
+#include <rime/common.h>
+
+namespace rime {
+
+// Allocates short-lived objects of a composition, such as candidates and
+// dictionary entries, from large blocks by bumping a pointer.
+//
+// A block counts the objects allocated from it and is freed when the last
+// of them is destroyed, so objects may safely outlive the composition that
+// created them; they only keep their block around. Reset() starts a new
+// block on the next allocation and is called for each composition update.
+class CompositionArena {
+ public:
+  static const size_t kBlockSize = 32 * 1024;
+  // larger objects are allocated on the heap
+  static const size_t kMaxObjectSize = 1024;
+
+  CompositionArena() = default;
+  CompositionArena(const CompositionArena&) = delete;
+  CompositionArena& operator= (const CompositionArena&) = delete;
+  RIME_API ~CompositionArena();
+
+  RIME_API void* Allocate(size_t size);
+  RIME_API static void Deallocate(void* ptr);
+  RIME_API void Reset();
+
+  // the arena to allocate from on the current thread, if any
+  RIME_API static CompositionArena* current();
+  // number of blocks not yet freed, in all arenas
+  RIME_API static size_t num_live_blocks();
+
+ private:
+  struct Block;
+
+  Block* block_ = nullptr;
+  size_t used_ = 0;
+};
+
+// Makes an arena current on this thread for the lifetime of the scope.
+// With a null arena, objects that have to outlive the composition by far,
+// eg. those kept by the user dictionary, are allocated on the heap.
+//
+// A survivor pins a whole block, so caches that live across keystrokes,
+// such as lookup results and the states of the poet, are made in the scope
+// of no arena. What is left to outlive a composition update is bounded:
+// stashed menus (at most 32 segments, dropped with the composition) and
+// the candidates on the page of a context snapshot.
+class ArenaScope {
+ public:
+  RIME_API explicit ArenaScope(CompositionArena* arena);
+  RIME_API ~ArenaScope();
+
+ private:
+  CompositionArena* previous_;
+};
+
+template <class T>
+class ArenaAllocator {
+ public:
+  using value_type = T;
+
+  explicit ArenaAllocator(CompositionArena* arena) : arena_(arena) {}
+  template <class U>
+  ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.arena()) {}
+
+  T* allocate(size_t n) {
+    size_t size = n * sizeof(T);
+    if (arena_ && size <= CompositionArena::kMaxObjectSize)
+      return static_cast<T*>(arena_->Allocate(size));
+    return static_cast<T*>(::operator new(size));
+  }
+  void deallocate(T* p, size_t n) {
+    // the arena itself may be gone by now; its blocks are not
+    if (arena_ && n * sizeof(T) <= CompositionArena::kMaxObjectSize)
+      CompositionArena::Deallocate(p);
+    else
+      ::operator delete(p);
+  }
+
+  CompositionArena* arena() const { return arena_; }
+
+ private:
+  CompositionArena* arena_;
+};
+
+template <class T, class U>
+inline bool operator== (const ArenaAllocator<T>& a,
+                        const ArenaAllocator<U>& b) {
+  return a.arena() == b.arena();
+}
+
+template <class T, class U>
+inline bool operator!= (const ArenaAllocator<T>& a,
+                        const ArenaAllocator<U>& b) {
+  return !(a == b);
+}
+
+// like New<T>(), but allocates from the current arena if there is one
+template <class T, class... Args>
+inline an<T> ArenaNew(Args&&... args) {
+  if (auto arena = CompositionArena::current()) {
+    return std::allocate_shared<T>(ArenaAllocator<T>(arena),
+                                   std::forward<Args>(args)...);
+  }
+  return New<T>(std::forward<Args>(args)...);
+}
+
+}  // namespace rime
+
+#endif  // RIME_ARENA_H_
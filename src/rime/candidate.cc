@@ -8,6 +8,11 @@
 
 namespace rime {
 
+const string& Candidate::empty_string() {
+  static const string empty;
+  return empty;
+}
+
 static an<Candidate>
 UnpackShadowCandidate(const an<Candidate>& cand) {
   auto shadow = As<ShadowCandidate>(cand);
@@ -7,6 +7,7 @@
 #ifndef RIME_CANDIDATE_H_
 #define RIME_CANDIDATE_H_
 
+#include <rime/arena.h>
 #include <rime/common.h>
 
 namespace rime {
@@ -36,15 +37,19 @@ class Candidate {
   // candidate text to commit
   virtual const string& text() const = 0;
   // (optional)
-  virtual string comment() const { return string(); }
+  virtual const string& comment() const { return empty_string(); }
   // text shown in the preedit area, replacing input string (optional)
-  virtual string preedit() const { return string(); }
+  virtual const string& preedit() const { return empty_string(); }
 
   void set_type(const string& type) { type_ = type; }
   void set_start(size_t start) { start_ = start; }
   void set_end(size_t end) { end_ = end; }
   void set_quality(double quality) { quality_ = quality; }
 
+ protected:
+  // returned by accessors of optional text fields that are not set
+  static const string& empty_string();
+
  private:
   string type_;
   size_t start_ = 0;
@@ -63,15 +68,17 @@ class SimpleCandidate : public Candidate {
   SimpleCandidate(const string type,
                   size_t start,
                   size_t end,
-                  const string& text,
-                  const string& comment = string(),
-                  const string& preedit = string())
+                  string text,
+                  string comment = string(),
+                  string preedit = string())
       : Candidate(type, start, end),
-      text_(text), comment_(comment), preedit_(preedit) {}
+      text_(std::move(text)),
+      comment_(std::move(comment)),
+      preedit_(std::move(preedit)) {}
 
   const string& text() const { return text_; }
-  string comment() const { return comment_; }
-  string preedit() const { return preedit_; }
+  const string& comment() const { return comment_; }
+  const string& preedit() const { return preedit_; }
 
   void set_text(const string& text) { text_ = text; }
   void set_comment(const string& comment) { comment_ = comment; }
@@ -87,19 +94,19 @@ class ShadowCandidate : public Candidate {
  public:
   ShadowCandidate(const an<Candidate>& item,
                   const string& type,
-                  const string& text = string(),
-                  const string& comment = string())
+                  string text = string(),
+                  string comment = string())
       : Candidate(type, item->start(), item->end(), item->quality()),
-        text_(text), comment_(comment),
+        text_(std::move(text)), comment_(std::move(comment)),
         item_(item) {}
 
   const string& text() const {
     return text_.empty() ? item_->text() : text_;
   }
-  string comment() const {
+  const string& comment() const {
     return comment_.empty() ? item_->comment() : comment_;
   }
-  string preedit() const {
+  const string& preedit() const {
     return item_->preedit();
   }
 
@@ -115,10 +122,10 @@ class UniquifiedCandidate : public Candidate {
  public:
   UniquifiedCandidate(const an<Candidate>& item,
                       const string& type,
-                      const string& text = string(),
-                      const string& comment = string())
+                      string text = string(),
+                      string comment = string())
       : Candidate(type, item->start(), item->end(), item->quality()),
-        text_(text), comment_(comment) {
+        text_(std::move(text)), comment_(std::move(comment)) {
     Append(item);
   }
 
@@ -126,12 +133,12 @@ class UniquifiedCandidate : public Candidate {
     return text_.empty() && !items_.empty() ?
         items_.front()->text() : text_;
   }
-  string comment() const {
+  const string& comment() const {
     return comment_.empty() && !items_.empty() ?
         items_.front()->comment() : comment_;
   }
-  string preedit() const {
-    return !items_.empty() ? items_.front()->preedit() : string();
+  const string& preedit() const {
+    return !items_.empty() ? items_.front()->preedit() : empty_string();
   }
 
   void Append(an<Candidate> item) {
@@ -12,6 +12,8 @@
 
 namespace rime {
 
+static const TagId kPhonyTag = TagRegistry::Intern("phony");
+
 bool Composition::HasFinishedComposition() const {
   if (empty())
     return false;
@@ -43,7 +45,7 @@ Preedit Composition::GetPreedit(const string& full_input, size_t caret_pos,
       }
       else {  // raw input
         end = at(i).end;
-        if (!at(i).HasTag("phony")) {
+        if (!at(i).HasTag(kPhonyTag)) {
           preedit.text += input_.substr(start, end - start);
         }
       }
@@ -113,7 +115,7 @@ string Composition::GetCommitText() const {
     }
     else {
       end = seg.end;
-      if (!seg.HasTag("phony")) {
+      if (!seg.HasTag(kPhonyTag)) {
         result += input_.substr(seg.start, seg.end - seg.start);
       }
     }
@@ -179,6 +179,7 @@ Config* ConfigComponentBase::Create(const string& file_name) {
 an<ConfigData> ConfigComponentBase::GetConfigData(const string& file_name) {
   auto config_id = resource_resolver_->ToResourceId(file_name);
   // keep a weak reference to the shared config data in the component
+  std::lock_guard<std::mutex> lock(mutex_);
   weak<ConfigData>& wp(cache_[config_id]);
   if (wp.expired()) {  // create a new copy and load it
     auto data = LoadConfig(config_id);
@@ -192,8 +193,13 @@ an<ConfigData> ConfigComponentBase::GetConfigData(const string& file_name) {
 an<ConfigData> ConfigLoader::LoadConfig(ResourceResolver* resource_resolver,
                                         const string& config_id) {
   auto data = New<ConfigData>();
-  data->LoadFromFile(
-      resource_resolver->ResolvePath(config_id).string(), nullptr);
+  auto file_name = resource_resolver->ResolvePath(config_id).string();
+  // configs saved automatically change at runtime; the others are built by
+  // the deployer along with their binary images
+  if (auto_save_ ||
+      !data->LoadFromImage(ConfigData::ImageFileName(file_name), file_name)) {
+    data->LoadFromFile(file_name, nullptr);
+  }
   data->set_auto_save(auto_save_);
   return data;
 }
@@ -8,6 +8,7 @@
 #define RIME_CONFIG_COMPONENT_H_
 
 #include <iostream>
+#include <mutex>
 #include <type_traits>
 #include <rime/common.h>
 #include <rime/component.h>
@@ -92,6 +93,7 @@ class ConfigComponentBase : public Config::Component {
 
  private:
   an<ConfigData> GetConfigData(const string& file_name);
+  std::mutex mutex_;  // guards cache_ shared by sessions
   map<string, weak<ConfigData>> cache_;
 };
 
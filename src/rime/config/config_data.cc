@@ -4,13 +4,18 @@
 //
 #include <cctype>
 #include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <boost/algorithm/string.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/format.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <rime/algo/utilities.h>
 #include <rime/config/config_compiler.h>
 #include <rime/config/config_cow_ref.h>
 #include <rime/config/config_data.h>
+#include <rime/config/config_image.h>
 #include <rime/config/config_types.h>
 
 namespace rime {
@@ -25,6 +30,7 @@ bool ConfigData::LoadFromStream(std::istream& stream) {
     LOG(ERROR) << "failed to load config from stream.";
     return false;
   }
+  path_index_.clear();
   try {
     YAML::Node doc = YAML::Load(stream);
     root = ConvertFromYaml(doc, nullptr);
@@ -58,6 +64,7 @@ bool ConfigData::LoadFromFile(const string& file_name,
   file_name_ = file_name;
   modified_ = false;
   root.reset();
+  path_index_.clear();
   if (!boost::filesystem::exists(file_name)) {
     LOG(WARNING) << "nonexistent config file '" << file_name << "'.";
     return false;
@@ -88,6 +95,294 @@ bool ConfigData::SaveToFile(const string& file_name) {
   return SaveToStream(out);
 }
 
+namespace {
+
+class ConfigImageWriter {
+ public:
+  uint32_t AddNode(const an<ConfigItem>& item);
+
+  vector<config_image::Node> nodes;
+  vector<config_image::Entry> entries;
+  string strings;
+
+ private:
+  uint32_t AddString(const string& str);
+};
+
+uint32_t ConfigImageWriter::AddString(const string& str) {
+  uint32_t offset = static_cast<uint32_t>(strings.length());
+  strings += str;
+  return offset;
+}
+
+// nodes are added depth first, after the entries of their parent
+uint32_t ConfigImageWriter::AddNode(const an<ConfigItem>& item) {
+  uint32_t index = static_cast<uint32_t>(nodes.size());
+  nodes.push_back(config_image::Node());
+  if (!item)
+    return index;
+  nodes[index].type = item->type();
+  if (auto value = As<ConfigValue>(item)) {
+    auto typed = value->ParseTyped();
+    auto& node(nodes[index]);
+    node.is_bool = typed.is_bool;
+    node.is_int = typed.is_int;
+    node.is_double = typed.is_double;
+    node.bool_value = typed.bool_value;
+    node.int_value = typed.int_value;
+    node.double_value = typed.double_value;
+    node.offset = AddString(value->str());
+    node.size = static_cast<uint32_t>(value->str().length());
+  }
+  else if (auto list = As<ConfigList>(item)) {
+    size_t first = entries.size();
+    size_t size = list->size();
+    entries.resize(first + size, config_image::Entry());
+    nodes[index].offset = static_cast<uint32_t>(first);
+    nodes[index].size = static_cast<uint32_t>(size);
+    for (size_t i = 0; i < size; ++i) {
+      uint32_t child = AddNode(list->GetAt(i));
+      entries[first + i].node = child;
+    }
+  }
+  else if (auto map = As<ConfigMap>(item)) {
+    size_t first = entries.size();
+    size_t size = 0;
+    for (auto it = map->begin(); it != map->end(); ++it)
+      ++size;
+    entries.resize(first + size, config_image::Entry());
+    nodes[index].offset = static_cast<uint32_t>(first);
+    nodes[index].size = static_cast<uint32_t>(size);
+    size_t i = first;
+    for (auto it = map->begin(); it != map->end(); ++it, ++i) {
+      entries[i].key_offset = AddString(it->first);
+      entries[i].key_size = static_cast<uint32_t>(it->first.length());
+      uint32_t child = AddNode(it->second);
+      entries[i].node = child;
+    }
+  }
+  return index;
+}
+
+class ConfigImageReader {
+ public:
+  ConfigImageReader(const char* address, size_t size);
+
+  bool valid() const { return metadata_ != nullptr; }
+  bool IsMadeFrom(uint32_t source_checksum) const {
+    return metadata_->source_checksum == source_checksum;
+  }
+  // reads the tree from node index; items under maps are indexed by path,
+  // unless path is null. parent is where the node was indexed, if it was.
+  bool Read(uint32_t index,
+            const string* path,
+            const IndexedConfigItem* parent,
+            an<ConfigItem>* item,
+            hash_map<string, IndexedConfigItem>* path_index) const;
+
+ private:
+  bool GetString(uint32_t offset, uint32_t size, string* str) const {
+    if (uint64_t(offset) + size > metadata_->strings_size)
+      return false;
+    str->assign(strings_ + offset, size);
+    return true;
+  }
+
+  const config_image::Metadata* metadata_ = nullptr;
+  const config_image::Node* nodes_ = nullptr;
+  const config_image::Entry* entries_ = nullptr;
+  const char* strings_ = nullptr;
+};
+
+ConfigImageReader::ConfigImageReader(const char* address, size_t size) {
+  using config_image::Metadata;
+  if (size < sizeof(Metadata))
+    return;
+  auto metadata = reinterpret_cast<const Metadata*>(address);
+  if (std::strncmp(metadata->format, config_image::kFormat,
+                   config_image::kFormatMaxLength) != 0)
+    return;
+  uint64_t expected_size = sizeof(Metadata) +
+      uint64_t(metadata->num_nodes) * sizeof(config_image::Node) +
+      uint64_t(metadata->num_entries) * sizeof(config_image::Entry) +
+      metadata->strings_size;
+  if (expected_size != size || metadata->num_nodes == 0)
+    return;
+  nodes_ = reinterpret_cast<const config_image::Node*>(
+      address + sizeof(Metadata));
+  entries_ = reinterpret_cast<const config_image::Entry*>(
+      nodes_ + metadata->num_nodes);
+  strings_ = reinterpret_cast<const char*>(
+      entries_ + metadata->num_entries);
+  metadata_ = metadata;
+}
+
+bool ConfigImageReader::Read(
+    uint32_t index,
+    const string* path,
+    const IndexedConfigItem* parent,
+    an<ConfigItem>* item,
+    hash_map<string, IndexedConfigItem>* path_index) const {
+  const config_image::Node& node(nodes_[index]);
+  if (node.type == ConfigItem::kNull) {
+    item->reset();
+    return true;
+  }
+  if (node.type == ConfigItem::kScalar) {
+    string str;
+    if (!GetString(node.offset, node.size, &str))
+      return false;
+    auto value = New<ConfigValue>(str);
+    ConfigValue::Typed typed;
+    typed.is_bool = node.is_bool != 0;
+    typed.is_int = node.is_int != 0;
+    typed.is_double = node.is_double != 0;
+    typed.bool_value = node.bool_value != 0;
+    typed.int_value = node.int_value;
+    typed.double_value = node.double_value;
+    value->set_typed(typed);
+    *item = value;
+    return true;
+  }
+  if (node.type != ConfigItem::kList && node.type != ConfigItem::kMap)
+    return false;
+  if (uint64_t(node.offset) + node.size > metadata_->num_entries)
+    return false;
+  an<ConfigList> list;
+  an<ConfigMap> map;
+  if (node.type == ConfigItem::kList)
+    list = New<ConfigList>();
+  else
+    map = New<ConfigMap>();
+  for (uint32_t i = 0; i < node.size; ++i) {
+    const config_image::Entry& entry(entries_[node.offset + i]);
+    // children come after their parent, so there are no cycles
+    if (entry.node <= index || entry.node >= metadata_->num_nodes)
+      return false;
+    an<ConfigItem> child;
+    if (list) {
+      if (!Read(entry.node, nullptr, nullptr, &child, path_index))
+        return false;
+      list->Append(child);
+      continue;
+    }
+    string key;
+    if (!GetString(entry.key_offset, entry.key_size, &key))
+      return false;
+    // keys with a slash cannot be on a path
+    string child_path;
+    IndexedConfigItem* indexed = nullptr;
+    if (path && key.find('/') == string::npos) {
+      child_path = path->empty() ? key : *path + "/" + key;
+      // elements of the index stay where they are as it grows
+      indexed = &(*path_index)[child_path];
+      indexed->map = map;
+      indexed->key = key;
+      indexed->parent = parent;
+    }
+    if (!Read(entry.node, indexed ? &child_path : nullptr, indexed, &child,
+              path_index))
+      return false;
+    map->Set(key, child);
+    if (indexed)
+      indexed->item = child;
+  }
+  if (list)
+    *item = list;
+  else
+    *item = map;
+  return true;
+}
+
+}  // namespace
+
+bool ConfigData::LoadFromImage(const string& image_file,
+                               const string& source_file) {
+  namespace fs = boost::filesystem;
+  using namespace boost::interprocess;
+  // update status
+  file_name_ = source_file;
+  modified_ = false;
+  root.reset();
+  path_index_.clear();
+  boost::system::error_code ec;
+  if (!fs::exists(image_file, ec) || !fs::exists(source_file, ec))
+    return false;
+  // the write time may not change with the content, eg. within a second
+  uint32_t source_checksum = Checksum(source_file);
+  try {
+    file_mapping file(image_file.c_str(), read_only);
+    mapped_region region(file, read_only);
+    ConfigImageReader reader(static_cast<const char*>(region.get_address()),
+                             region.get_size());
+    if (!reader.valid()) {
+      LOG(WARNING) << "invalid config image '" << image_file << "'.";
+      return false;
+    }
+    if (!reader.IsMadeFrom(source_checksum)) {
+      LOG(INFO) << "config image '" << image_file << "' is out of date.";
+      return false;
+    }
+    LOG(INFO) << "loading config image '" << image_file << "'.";
+    string root_path;
+    if (!reader.Read(0, &root_path, nullptr, &root, &path_index_)) {
+      LOG(ERROR) << "corrupted config image '" << image_file << "'.";
+      root.reset();
+      path_index_.clear();
+      return false;
+    }
+  }
+  catch (interprocess_exception& e) {
+    LOG(ERROR) << "error mapping config image '" << image_file << "': "
+               << e.what();
+    return false;
+  }
+  return true;
+}
+
+bool ConfigData::SaveToImage(const string& image_file,
+                             const string& source_file) {
+  namespace fs = boost::filesystem;
+  boost::system::error_code ec;
+  if (!fs::exists(source_file, ec))
+    return false;
+  ConfigImageWriter writer;
+  writer.AddNode(root);
+  config_image::Metadata metadata;
+  std::memset(&metadata, 0, sizeof(metadata));
+  std::strncpy(metadata.format, config_image::kFormat,
+               config_image::kFormatMaxLength - 1);
+  metadata.source_checksum = Checksum(source_file);
+  metadata.num_nodes = static_cast<uint32_t>(writer.nodes.size());
+  metadata.num_entries = static_cast<uint32_t>(writer.entries.size());
+  metadata.strings_size = static_cast<uint32_t>(writer.strings.length());
+  LOG(INFO) << "saving config image '" << image_file << "'.";
+  // written aside and renamed, so that no one loads a partial image
+  string temp_file = image_file + ".tmp";
+  {
+    std::ofstream out(temp_file.c_str(), std::ios::binary);
+    out.write(reinterpret_cast<const char*>(&metadata), sizeof(metadata));
+    out.write(reinterpret_cast<const char*>(writer.nodes.data()),
+              writer.nodes.size() * sizeof(config_image::Node));
+    out.write(reinterpret_cast<const char*>(writer.entries.data()),
+              writer.entries.size() * sizeof(config_image::Entry));
+    out.write(writer.strings.data(), writer.strings.length());
+    if (!out) {
+      LOG(ERROR) << "error writing config image '" << image_file << "'.";
+      out.close();
+      fs::remove(temp_file, ec);
+      return false;
+    }
+  }
+  fs::rename(temp_file, image_file, ec);
+  if (ec) {
+    LOG(ERROR) << "error saving config image '" << image_file << "'.";
+    fs::remove(temp_file, ec);
+    return false;
+  }
+  return true;
+}
+
 bool ConfigData::IsListItemReference(const string& key) {
   return key.length() > 1 && key[0] == '@' && std::isalnum(key[1]);
 }
@@ -224,6 +519,14 @@ an<ConfigItem> ConfigData::Traverse(const string& path) {
   if (path.empty() || path == "/") {
     return root;
   }
+  // items added to or replaced in the tree in place are not in the index,
+  // so a miss still walks the tree
+  if (!path_index_.empty() && path[0] != '/' &&
+      path.find('@') == string::npos) {
+    auto found = path_index_.find(path);
+    if (found != path_index_.end() && IsInPlace(found->second))
+      return found->second.item;
+  }
   vector<string> keys = SplitPath(path);
   // find the YAML::Node, and wrap it!
   an<ConfigItem> p = root;
@@ -247,6 +550,15 @@ an<ConfigItem> ConfigData::Traverse(const string& path) {
   return p;
 }
 
+bool ConfigData::IsInPlace(const IndexedConfigItem& indexed) const {
+  const IndexedConfigItem* x = &indexed;
+  for (; x->parent; x = x->parent) {
+    if (x->map->Get(x->key) != x->item)
+      return false;
+  }
+  return x->map == root && x->map->Get(x->key) == x->item;
+}
+
 an<ConfigItem> ConfigData::ConvertFromYaml(
     const YAML::Node& node, ConfigCompiler* compiler) {
   if (YAML::NodeType::Null == node.Type()) {
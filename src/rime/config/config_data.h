@@ -14,6 +14,16 @@ namespace rime {
 
 class ConfigCompiler;
 class ConfigItem;
+class ConfigMap;
+
+// an item in a map of a config tree, and where it was when indexed
+struct IndexedConfigItem {
+  an<ConfigItem> item;
+  an<ConfigMap> map;
+  string key;
+  // where the map was, or null for the root
+  const IndexedConfigItem* parent = nullptr;
+};
 
 class ConfigData {
  public:
@@ -24,6 +34,13 @@ class ConfigData {
   bool SaveToStream(std::ostream& stream);
   bool LoadFromFile(const string& file_name, ConfigCompiler* compiler);
   bool SaveToFile(const string& file_name);
+  // a binary image is loaded in place of the yaml file it was made from,
+  // as long as that file is unchanged.
+  bool LoadFromImage(const string& image_file, const string& source_file);
+  bool SaveToImage(const string& image_file, const string& source_file);
+  static string ImageFileName(const string& file_name) {
+    return file_name + ".bin";
+  }
   bool TraverseWrite(const string& path, an<ConfigItem> item);
   an<ConfigItem> Traverse(const string& path);
 
@@ -36,7 +53,10 @@ class ConfigData {
 
   const string& file_name() const { return file_name_; }
   bool modified() const { return modified_; }
-  void set_modified() { modified_ = true; }
+  void set_modified() {
+    modified_ = true;
+    path_index_.clear();
+  }
   void set_auto_save(bool auto_save) { auto_save_ = auto_save; }
 
   an<ConfigItem> root;
@@ -49,10 +69,15 @@ class ConfigData {
                        int depth);
   static void EmitScalar(const string& str_value,
                          YAML::Emitter* emitter);
+  // whether an indexed item is still on its path, as the maps along it
+  // may have been modified in place
+  bool IsInPlace(const IndexedConfigItem& indexed) const;
 
   string file_name_;
   bool modified_ = false;
   bool auto_save_ = false;
+  // items in maps of a tree loaded from an image, by path
+  hash_map<string, IndexedConfigItem> path_index_;
 };
 
 }  // namespace rime
@@ -0,0 +1,58 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+#ifndef RIME_CONFIG_IMAGE_H_
+#define RIME_CONFIG_IMAGE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace rime {
+
+// A compiled config tree stored in a file that is read in place, in the
+// byte order of the machine that wrote it:
+//   Metadata | Node[num_nodes] | Entry[num_entries] | char[strings_size]
+// The root is node 0, and children always come after their parent.
+namespace config_image {
+
+const char kFormat[] = "Rime::ConfigImage/1.1";
+const size_t kFormatMaxLength = 32;
+
+struct Metadata {
+  char format[kFormatMaxLength];
+  // checksum of the content of the yaml file the image was made from
+  uint32_t source_checksum;
+  uint32_t num_nodes;
+  uint32_t num_entries;
+  uint32_t strings_size;
+};
+
+struct Node {
+  uint8_t type;  // ConfigItem::ValueType
+  // scalar values parsed at deploy time
+  uint8_t is_bool;
+  uint8_t is_int;
+  uint8_t is_double;
+  uint8_t bool_value;
+  uint8_t reserved[3];
+  int32_t int_value;
+  uint32_t reserved2;
+  double double_value;
+  // a scalar's text in strings, or the range of a list or map in entries
+  uint32_t offset;
+  uint32_t size;
+};
+
+struct Entry {
+  // map key in strings; empty for list items
+  uint32_t key_offset;
+  uint32_t key_size;
+  uint32_t node;
+};
+
+}  // namespace config_image
+
+}  // namespace rime
+
+#endif  // RIME_CONFIG_IMAGE_H_
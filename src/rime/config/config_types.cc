@@ -37,10 +37,10 @@ ConfigValue::ConfigValue(const string& value)
     : ConfigItem(kScalar), value_(value) {
 }
 
-bool ConfigValue::GetBool(bool* value) const {
-  if (!value || value_.empty())
+bool ConfigValue::ParseBool(const string& str, bool* value) {
+  if (str.empty())
     return false;
-  string bstr = value_;
+  string bstr = str;
   boost::to_lower(bstr);
   if ("true" == bstr) {
     *value = true;
@@ -54,13 +54,13 @@ bool ConfigValue::GetBool(bool* value) const {
     return false;
 }
 
-bool ConfigValue::GetInt(int* value) const {
-  if (!value || value_.empty())
+bool ConfigValue::ParseInt(const string& str, int* value) {
+  if (str.empty())
     return false;
   // try to parse hex number
-  if (boost::starts_with(value_, "0x")) {
+  if (boost::starts_with(str, "0x")) {
     char* p = NULL;
-    unsigned int hex = std::strtoul(value_.c_str(), &p, 16);
+    unsigned int hex = std::strtoul(str.c_str(), &p, 16);
     if (*p == '\0') {
       *value = static_cast<int>(hex);
       return true;
@@ -68,7 +68,7 @@ bool ConfigValue::GetInt(int* value) const {
   }
   // decimal
   try {
-    *value = boost::lexical_cast<int>(value_);
+    *value = boost::lexical_cast<int>(str);
   }
   catch (...) {
     return false;
@@ -76,11 +76,11 @@ bool ConfigValue::GetInt(int* value) const {
   return true;
 }
 
-bool ConfigValue::GetDouble(double* value) const {
-  if (!value || value_.empty())
+bool ConfigValue::ParseDouble(const string& str, double* value) {
+  if (str.empty())
     return false;
   try {
-    *value = boost::lexical_cast<double>(value_);
+    *value = boost::lexical_cast<double>(str);
   }
   catch (...) {
     return false;
@@ -88,6 +88,47 @@ bool ConfigValue::GetDouble(double* value) const {
   return true;
 }
 
+ConfigValue::Typed ConfigValue::ParseTyped() const {
+  Typed typed;
+  typed.is_bool = ParseBool(value_, &typed.bool_value);
+  typed.is_int = ParseInt(value_, &typed.int_value);
+  typed.is_double = ParseDouble(value_, &typed.double_value);
+  return typed;
+}
+
+bool ConfigValue::GetBool(bool* value) const {
+  if (!value)
+    return false;
+  if (has_typed_) {
+    if (typed_.is_bool)
+      *value = typed_.bool_value;
+    return typed_.is_bool;
+  }
+  return ParseBool(value_, value);
+}
+
+bool ConfigValue::GetInt(int* value) const {
+  if (!value)
+    return false;
+  if (has_typed_) {
+    if (typed_.is_int)
+      *value = typed_.int_value;
+    return typed_.is_int;
+  }
+  return ParseInt(value_, value);
+}
+
+bool ConfigValue::GetDouble(double* value) const {
+  if (!value)
+    return false;
+  if (has_typed_) {
+    if (typed_.is_double)
+      *value = typed_.double_value;
+    return typed_.is_double;
+  }
+  return ParseDouble(value_, value);
+}
+
 bool ConfigValue::GetString(string* value) const {
   if (!value) return false;
   *value = value_;
@@ -95,26 +136,31 @@ bool ConfigValue::GetString(string* value) const {
 }
 
 bool ConfigValue::SetBool(bool value) {
+  has_typed_ = false;
   value_ = value ? "true" : "false";
   return true;
 }
 
 bool ConfigValue::SetInt(int value) {
+  has_typed_ = false;
   value_ = boost::lexical_cast<string>(value);
   return true;
 }
 
 bool ConfigValue::SetDouble(double value) {
+  has_typed_ = false;
   value_ = boost::lexical_cast<string>(value);
   return true;
 }
 
 bool ConfigValue::SetString(const char* value) {
+  has_typed_ = false;
   value_ = value;
   return true;
 }
 
 bool ConfigValue::SetString(const string& value) {
+  has_typed_ = false;
   value_ = value;
   return true;
 }
@@ -35,6 +35,16 @@ class ConfigItem {
 
 class ConfigValue : public ConfigItem {
  public:
+  // what the value reads as with the typed accessors
+  struct Typed {
+    bool is_bool = false;
+    bool is_int = false;
+    bool is_double = false;
+    bool bool_value = false;
+    int int_value = 0;
+    double double_value = 0.;
+  };
+
   ConfigValue() : ConfigItem(kScalar) {}
   RIME_API ConfigValue(bool value);
   RIME_API ConfigValue(int value);
@@ -55,12 +65,25 @@ class ConfigValue : public ConfigItem {
 
   const string& str() const { return value_; }
 
+  Typed ParseTyped() const;
+  // spares the typed accessors parsing the value, until it is set again
+  void set_typed(const Typed& typed) {
+    typed_ = typed;
+    has_typed_ = true;
+  }
+
   bool empty() const override {
     return value_.empty();
   }
 
  protected:
+  static bool ParseBool(const string& str, bool* value);
+  static bool ParseInt(const string& str, int* value);
+  static bool ParseDouble(const string& str, double* value);
+
   string value_;
+  bool has_typed_ = false;
+  Typed typed_;
 };
 
 class ConfigList : public ConfigItem {
@@ -215,6 +215,7 @@ bool Context::ClearNonConfirmedComposition() {
     reverted = true;
   }
   if (reverted) {
+    ++refresh_count_;
     composition_.Forward();
     DLOG(INFO) << "composition: " << composition_.GetDebugText();
   }
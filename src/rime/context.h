@@ -55,6 +55,8 @@ class Context {
   bool ReopenPreviousSelection();
   bool ClearNonConfirmedComposition();
   bool RefreshNonConfirmedComposition();
+  // counts the times unconfirmed segments were cleared, to be translated anew
+  int refresh_count() const { return refresh_count_; }
 
   void set_input(const string& value);
   const string& input() const { return input_; }
@@ -96,6 +98,7 @@ class Context {
   string input_;
   size_t caret_pos_ = 0;
   Composition composition_;
+  int refresh_count_ = 0;
   CommitHistory commit_history_;
   map<string, bool> options_;
   map<string, string> properties_;
@@ -39,6 +39,10 @@ class Deployer : public Messenger {
   string distribution_name;
   string distribution_code_name;
   string distribution_version;
+  // bytes of memory mapped dictionaries to keep loaded while not in use
+  size_t resource_cache_size = 0;
+  // see MappedFileLoadPolicy
+  string mapped_file_policy;
   // }
 
   Deployer();
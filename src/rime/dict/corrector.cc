@@ -8,7 +8,6 @@
 #include "corrector.h"
 #include <algorithm>
 #include <numeric>
-#include <queue>
 #include <rime/schema.h>
 #include <rime/service.h>
 #include <rime/ticket.h>
@@ -16,7 +15,10 @@
 using namespace rime;
 using namespace corrector;
 
-static hash_map<char, hash_set<char>> keyboard_map = {
+// a function-local static, in case corrections are searched during static
+// initialization of another translation unit
+static const hash_map<char, hash_set<char>>& keyboard_map() {
+  static const hash_map<char, hash_set<char>> map = {
     {'1', {'2', 'q', 'w'}},
     {'2', {'1', '3', 'q', 'w', 'e'}},
     {'3', {'2', '4', 'w', 'e', 'r'}},
@@ -63,8 +65,43 @@ static hash_map<char, hash_set<char>> keyboard_map = {
     {',', {'m', '.'}},
     {'.', {',', '/'}},
     {'/', {'.'}},
+  };
+  return map;
+}
+
+namespace {
+
+// keyboard_map flattened into arrays indexed by character, so that the
+// distance and search loops do no hashing. neighbors keep the iteration
+// order of keyboard_map, which decides the order of search results.
+struct KeyboardTable {
+  uint8_t subst_cost[256][256];
+  string neighbors[256];
+
+  KeyboardTable() {
+    for (int i = 0; i < 256; ++i) {
+      for (int j = 0; j < 256; ++j) {
+        subst_cost[i][j] = i == j ? 0 : 4;
+      }
+    }
+    for (const auto &key : keyboard_map()) {
+      auto left = (uint8_t)key.first;
+      for (char right : key.second) {
+        if (key.first != right)
+          subst_cost[left][(uint8_t)right] = 1;
+      }
+      neighbors[left].assign(key.second.begin(), key.second.end());
+    }
+  }
 };
 
+const KeyboardTable &keyboard_table() {
+  static const KeyboardTable table;
+  return table;
+}
+
+}  // namespace
+
 void DFSCollect(const string &origin, const string &current, size_t ed, Script &result);
 
 Script SymDeleteCollector::Collect(size_t edit_distance) {
@@ -106,11 +143,11 @@ void EditDistanceCorrector::ToleranceSearch(const Prism &prism,
     if (res_val >= 0) {
       for (auto accessor = QuerySpelling(res_val); !accessor.exhausted(); accessor.Next()) {
         auto origin = accessor.properties().tips;
-        auto current_input = key.substr(0, point);
-        if (origin == current_input) {
+        if (origin.length() == point && key.compare(0, point, origin) == 0) {
           continue; // early termination: this comparision is O(n)
         }
-        auto distance = RestrictedDistance(origin, current_input, threshold);
+        auto distance = RestrictedDistance(origin.data(), origin.length(),
+                                           key.data(), point, threshold);
         if (distance <= threshold) { // only trace near words
           SyllableId corrected;
           if (prism.GetValue(origin, &corrected)) {
@@ -141,79 +178,94 @@ void EditDistanceCorrector::ToleranceSearch(const Prism &prism,
 
 
 inline uint8_t SubstCost(char left, char right) {
-  if (left == right) return 0;
-  if (keyboard_map[left].find(right) != keyboard_map[left].end()) {
-    return 1;
-  }
-  return 4;
+  return keyboard_table().subst_cost[(uint8_t)left][(uint8_t)right];
 }
 
+// rows of the distance matrices live on the stack for syllable-sized keys
+static const size_t kMaxStackRowLength = 32;
+
 // This nice O(min(m, n)) implementation is from
 // https://en.wikibooks.org/wiki/Algorithm_Implementation/Strings/Levenshtein_distance#C++
 Distance EditDistanceCorrector::LevenshteinDistance(const std::string &s1, const std::string &s2) {
-  // To change the type this function manipulates and returns, change
-  // the return type and the types of the two variables below.
-  auto s1len = (size_t)s1.size();
-  auto s2len = (size_t)s2.size();
-
-  auto column_start = (decltype(s1len))1;
-
-  auto column = new decltype(s1len)[s1len + 1];
-  std::iota(column + column_start - 1, column + s1len + 1, column_start - 1);
+  auto s1len = s1.size();
+  auto s2len = s2.size();
+
+  size_t stack_column[kMaxStackRowLength + 1];
+  vector<size_t> heap_column;
+  size_t *column = stack_column;
+  if (s1len > kMaxStackRowLength) {
+    heap_column.resize(s1len + 1);
+    column = heap_column.data();
+  }
+  std::iota(column, column + s1len + 1, (size_t)0);
 
-  for (auto x = column_start; x <= s2len; x++) {
+  for (size_t x = 1; x <= s2len; x++) {
     column[0] = x;
-    auto last_diagonal = x - column_start;
-    for (auto y = column_start; y <= s1len; y++) {
+    auto last_diagonal = x - 1;
+    for (size_t y = 1; y <= s1len; y++) {
       auto old_diagonal = column[y];
-      auto possibilities = {
+      column[y] = std::min({
           column[y] + 1,
           column[y - 1] + 1,
           last_diagonal + SubstCost(s1[y - 1], s2[x - 1])
-      };
-
-      column[y] = std::min(possibilities);
+      });
       last_diagonal = old_diagonal;
     }
   }
-  auto result = column[s1len];
-  delete[] column;
-  return result;
+  return column[s1len];
 }
 
-// L's distance with transposition allowed
 Distance EditDistanceCorrector::RestrictedDistance(const std::string& s1,
-                                                              const std::string& s2,
-                                                              Distance threshold) {
-  auto len1 = s1.size(), len2 = s2.size();
-  vector<size_t> d((len1 + 1) * (len2 + 1));
+                                                   const std::string& s2,
+                                                   Distance threshold) {
+  return RestrictedDistance(s1.data(), s1.length(),
+                            s2.data(), s2.length(), threshold);
+}
 
-  auto index = [len1, len2](size_t i, size_t j) {
-    return i * (len2 + 1) + j;
-  };
+// L's distance with transposition allowed.
+// only the last three rows of the matrix are kept, as the transposition
+// looks two rows back.
+Distance EditDistanceCorrector::RestrictedDistance(const char* s1,
+                                                   size_t len1,
+                                                   const char* s2,
+                                                   size_t len2,
+                                                   Distance threshold) {
+  const size_t width = len2 + 1;
+  size_t stack_rows[3 * (kMaxStackRowLength + 1)];
+  vector<size_t> heap_rows;
+  size_t *rows = stack_rows;
+  if (len2 > kMaxStackRowLength) {
+    heap_rows.resize(3 * width);
+    rows = heap_rows.data();
+  }
+  size_t *before_last = rows;
+  size_t *last = rows + width;
+  size_t *current = rows + 2 * width;
 
-  d[0] = 0;
-  for(size_t i = 1; i <= len1; ++i) d[index(i, 0)] = i * 2;
-  for(size_t i = 1; i <= len2; ++i) d[index(0, i)] = i * 2;
+  for(size_t j = 0; j <= len2; ++j) last[j] = j * 2;
 
   for(size_t i = 1; i <= len1; ++i) {
+    current[0] = i * 2;
     auto min_d = threshold + 1;
+    const auto *cost = keyboard_table().subst_cost[(uint8_t)s1[i - 1]];
     for(size_t j = 1; j <= len2; ++j) {
-      d[index(i, j)] = std::min({
-                                    d[index(i - 1, j)] + 2,
-                                    d[index(i, j - 1)] + 2,
-                                    d[index(i - 1, j - 1)] + SubstCost(s1[i - 1], s2[j - 1])
-                                });
+      current[j] = std::min({
+                                last[j] + 2,
+                                current[j - 1] + 2,
+                                last[j - 1] + cost[(uint8_t)s2[j - 1]]
+                            });
       if (i > 1 && j > 1 && s1[i - 2] == s2[j - 1] && s1[i - 1] == s2[j - 2]) {
-        d[index(i, j)] = std::min(d[index(i, j)], d[index(i - 2, j - 2)] + 2);
+        current[j] = std::min(current[j], before_last[j - 2] + 2);
       }
-      min_d = std::min(min_d, d[index(i, j)]);
+      min_d = std::min(min_d, current[j]);
     }
     // early termination: do not continue if too far
     if (min_d > threshold)
       return min_d;
+    std::swap(before_last, last);
+    std::swap(last, current);
   }
-  return (uint8_t)d[index(len1, len2)];
+  return (uint8_t)last[len2];
 }
 bool EditDistanceCorrector::Build(const Syllabary &syllabary,
                                   const Script *script,
@@ -235,6 +287,40 @@ bool EditDistanceCorrector::Build(const Syllabary &syllabary,
 }
 EditDistanceCorrector::EditDistanceCorrector(const string &file_name) : Prism(file_name) {}
 
+namespace {
+
+// walks the prism's double array along the key, trying neighboring keys
+// in place of each character within the tolerance.
+struct NearSearch {
+  const Darts::DoubleArray &trie;
+  const string &key;
+  size_t threshold;
+  Corrections *results;
+
+  void Advance(size_t node_pos, size_t idx, size_t distance, char ch) {
+    size_t key_pos = 0;
+    auto val = trie.traverse(&ch, node_pos, key_pos, 1);
+    if (val == -2) return;
+    if (val >= 0) {
+      results->Alter(val, { distance, val, idx + 1 });
+    }
+    if (idx + 1 < key.size()) {
+      Search(node_pos, idx + 1, distance);
+    }
+  }
+
+  void Search(size_t node_pos, size_t idx, size_t distance) {
+    Advance(node_pos, idx, distance, key[idx]);
+    if (distance < threshold) {
+      for (auto subst : keyboard_table().neighbors[(uint8_t)key[idx]]) {
+        Advance(node_pos, idx, distance + 1, subst);
+      }
+    }
+  }
+};
+
+}  // namespace
+
 void
 NearSearchCorrector::ToleranceSearch(const Prism &prism,
                                      const string &key,
@@ -242,39 +328,11 @@ NearSearchCorrector::ToleranceSearch(const Prism &prism,
                                      size_t threshold) {
   if (key.empty())
     return ;
-
-  using record = struct {
-    size_t node_pos;
-    size_t idx;
-    size_t distance;
-    char ch;
-  };
-
-  std::queue<record> queue;
-  queue.push({ 0, 0, 0, key[0] });
-  for (auto subst : keyboard_map[key[0]]) {
-    queue.push({ 0, 0, 1, subst });
-  }
-  for (; !queue.empty(); queue.pop()) {
-    auto &rec = queue.front();
-    char ch = rec.ch;
-    char &exchange(const_cast<char *>(key.c_str())[rec.idx]);
-    std::swap(ch, exchange);
-    auto val = prism.trie().traverse(key.c_str(), rec.node_pos, rec.idx, rec.idx + 1);
-    std::swap(ch, exchange);
-
-    if (val == -2) continue;
-    if (val >= 0) {
-      results->Alter(val, { rec.distance, val, rec.idx });
-    }
-    if (rec.idx < key.size()) {
-      queue.push({ rec.node_pos, rec.idx, rec.distance, key[rec.idx] });
-      if (rec.distance < threshold) {
-        for (auto subst : keyboard_map[key[rec.idx]]) {
-          queue.push({ rec.node_pos, rec.idx, rec.distance + 1, subst });
-        }
-      }
-    }
+  NearSearch search{ prism.trie(), key, threshold, results };
+  // the first character is always open to substitution
+  search.Advance(0, 0, 0, key[0]);
+  for (auto subst : keyboard_table().neighbors[(uint8_t)key[0]]) {
+    search.Advance(0, 0, 1, subst);
   }
 }
 void CorrectorComponent::Unified::ToleranceSearch(const Prism &prism,
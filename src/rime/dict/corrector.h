@@ -35,16 +35,33 @@ struct Correction {
   SyllableId syllable;
   size_t length;
 };
-class Corrections : public hash_map<SyllableId, Correction> {
+// at most one correction per syllable, kept in a flat array as a query
+// yields a few dozen of them at most.
+class Corrections {
  public:
+  using const_iterator = vector<Correction>::const_iterator;
+
   /// Update for better correction
   /// \param syllable
   /// \param correction
   inline void Alter(SyllableId syllable, Correction correction) {
-    if (find(syllable) == end() || correction.distance < (*this)[syllable].distance) {
-      (*this)[syllable] = correction;
+    for (auto& existing : corrections_) {
+      if (existing.syllable == syllable) {
+        if (correction.distance < existing.distance)
+          existing = correction;
+        return;
+      }
     }
+    corrections_.push_back(correction);
   };
+  const_iterator begin() const { return corrections_.begin(); }
+  const_iterator end() const { return corrections_.end(); }
+  size_t size() const { return corrections_.size(); }
+  bool empty() const { return corrections_.empty(); }
+  void clear() { corrections_.clear(); }
+
+ private:
+  vector<Correction> corrections_;
 };
 } // namespace corrector
 
@@ -107,6 +124,9 @@ class EditDistanceCorrector : public Corrector,
                                 size_t tolerance) override;
   corrector::Distance LevenshteinDistance(const std::string &s1, const std::string &s2);
   corrector::Distance RestrictedDistance(const std::string& s1, const std::string& s2, corrector::Distance threshold);
+  corrector::Distance RestrictedDistance(const char* s1, size_t len1,
+                                         const char* s2, size_t len2,
+                                         corrector::Distance threshold);
 };
 
 class NearSearchCorrector : public Corrector {
@@ -7,6 +7,7 @@
 #ifndef RIME_DB_H_
 #define RIME_DB_H_
 
+#include <atomic>
 #include <rime_api.h>
 #include <rime/common.h>
 #include <rime/component.h>
@@ -64,13 +65,19 @@ class Db : public Class<Db, const string&> {
   bool disabled() const { return disabled_; }
   void disable() { disabled_ = true; }
   void enable() { disabled_ = false; }
+  // counts changes made to the db by any of its users; cached query
+  // results are outdated once it has changed
+  uint64_t revision() const { return revision_; }
 
  protected:
+  void set_modified() { ++revision_; }
+
   string name_;
   string file_name_;
   bool loaded_ = false;
   bool readonly_ = false;
   bool disabled_ = false;
+  std::atomic<uint64_t> revision_{0};
 };
 
 class Transactional {
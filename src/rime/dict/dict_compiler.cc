@@ -4,6 +4,7 @@
 //
 // 2011-11-27 GONG Chen <chen.sst@gmail.com>
 //
+#include <boost/algorithm/string.hpp>
 #include <boost/filesystem.hpp>
 #include <cfloat>
 #include <cmath>
@@ -20,7 +21,9 @@
 #include <rime/dict/reverse_lookup_dictionary.h>
 #include <rime/dict/table.h>
 #include <rime/resource.h>
+#include <rime/resource_pool.h>
 #include <rime/service.h>
+#include <rime/thread_pool.h>
 
 namespace rime {
 
@@ -28,7 +31,8 @@ DictCompiler::DictCompiler(Dictionary *dictionary, const string& prefix)
     : dict_name_(dictionary->name()),
       prism_(dictionary->prism()),
       table_(dictionary->table()),
-      prefix_(prefix) {
+      prefix_(prefix),
+      thread_pool_(&ThreadPool::instance()) {
 }
 
 static string LocateFile(const string& file_name) {
@@ -37,6 +41,15 @@ static string LocateFile(const string& file_name) {
   return resolver->ResolvePath(file_name).string();
 }
 
+// the name a prism is pooled by, from its file name "<name>.prism.bin"
+static string PrismName(const string& file_name) {
+  string name = boost::filesystem::path(file_name).filename().string();
+  const string suffix(".prism.bin");
+  if (boost::ends_with(name, suffix))
+    name.resize(name.length() - suffix.length());
+  return name;
+}
+
 bool DictCompiler::Compile(const string &schema_file) {
   LOG(INFO) << "compiling dictionary for " << schema_file;
   bool build_table_from_source = true;
@@ -126,11 +139,31 @@ bool DictCompiler::Compile(const string &schema_file) {
   if (options_ & kRebuildPrism) {
     rebuild_prism = true;
   }
-  if (rebuild_table && !BuildTable(&settings, dict_files, dict_file_checksum))
-    return false;
-  if (rebuild_prism && !BuildPrism(schema_file,
-                                   dict_file_checksum, schema_file_checksum))
+  if (rebuild_table) {
+    // the prism depends only on the syllabary, so build both at once
+    function<bool (const Syllabary&)> build_prism;
+    if (rebuild_prism) {
+      build_prism = [&](const Syllabary& syllabary) {
+        return BuildPrism(schema_file,
+                          dict_file_checksum, schema_file_checksum,
+                          &syllabary);
+      };
+    }
+    if (!BuildTable(&settings, dict_files, dict_file_checksum, build_prism))
+      return false;
+  }
+  else if (rebuild_prism && !BuildPrism(schema_file,
+                                        dict_file_checksum,
+                                        schema_file_checksum))
     return false;
+  // pooled resources may still map the replaced files
+  if (rebuild_table) {
+    ResourcePoolBase::Invalidate("table", dict_name_);
+    ResourcePoolBase::Invalidate("reverse_db", dict_name_);
+  }
+  if (rebuild_prism) {
+    ResourcePoolBase::Invalidate("prism", PrismName(prism_->file_name()));
+  }
   // done!
   return true;
 }
@@ -145,11 +178,12 @@ static string RelocateToUserDirectory(const string& prefix,
 
 bool DictCompiler::BuildTable(DictSettings* settings,
                               const vector<string>& dict_files,
-                              uint32_t dict_file_checksum) {
+                              uint32_t dict_file_checksum,
+                              function<bool (const Syllabary&)> build_prism) {
   LOG(INFO) << "building table...";
   table_ = New<Table>(RelocateToUserDirectory(prefix_, table_->file_name()));
 
-  EntryCollector collector;
+  EntryCollector collector(thread_pool_);
   collector.Configure(settings);
   collector.Collect(dict_files);
   if (options_ & kDump) {
@@ -157,8 +191,20 @@ bool DictCompiler::BuildTable(DictSettings* settings,
     path.replace_extension(".txt");
     collector.Dump(path.string());
   }
+  // the prism, table and reverse db are built concurrently on the pool
+  the<TaskGroup> tasks(thread_pool_ ? new TaskGroup(thread_pool_) : nullptr);
+  auto run = [&tasks](ThreadPool::Task task) {
+    if (tasks)
+      tasks->Run(task);
+    else
+      task();
+  };
+  bool prism_built = true;
+  if (build_prism) {
+    run([&] { prism_built = build_prism(collector.syllabary); });
+  }
   Vocabulary vocabulary;
-  // build .table.bin
+  // collect entries into vocabulary
   {
     map<string, SyllableId> syllable_to_id;
     SyllableId syllable_id = 0;
@@ -184,36 +230,46 @@ bool DictCompiler::BuildTable(DictSettings* settings,
     if (settings->sort_order() != "original") {
       vocabulary.SortHomophones();
     }
-    table_->Remove();
-    if (!table_->Build(collector.syllabary, vocabulary, collector.num_entries,
-                       dict_file_checksum) ||
-        !table_->Save()) {
-      return false;
-    }
   }
-  // build .reverse.bin
-  ReverseDb reverse_db(RelocateToUserDirectory(prefix_,
-                                               dict_name_ + ".reverse.bin"));
-  if (!reverse_db.Build(settings,
-                        collector.syllabary,
-                        vocabulary,
-                        collector.stems,
-                        dict_file_checksum)) {
-    LOG(ERROR) << "error building reversedb.";
-    return false;
-  }
-  return true;
+  // build .table.bin and .reverse.bin from the same vocabulary
+  bool reverse_db_built = true;
+  run([&] {
+    ReverseDb reverse_db(RelocateToUserDirectory(prefix_,
+                                                 dict_name_ + ".reverse.bin"));
+    if (!reverse_db.Build(settings,
+                          collector.syllabary,
+                          vocabulary,
+                          collector.stems,
+                          dict_file_checksum)) {
+      LOG(ERROR) << "error building reversedb.";
+      reverse_db_built = false;
+    }
+  });
+  table_->Remove();
+  bool success = table_->Build(collector.syllabary, vocabulary,
+                               collector.num_entries, dict_file_checksum) &&
+      table_->Save();
+  if (tasks)
+    tasks->Wait();
+  return success && reverse_db_built && prism_built;
 }
 
 bool DictCompiler::BuildPrism(const string &schema_file,
                               uint32_t dict_file_checksum,
-                              uint32_t schema_file_checksum) {
+                              uint32_t schema_file_checksum,
+                              const Syllabary* collected_syllabary) {
   LOG(INFO) << "building prism...";
   prism_ = New<Prism>(RelocateToUserDirectory(prefix_, prism_->file_name()));
 
   // get syllabary from table
   Syllabary syllabary;
-  if (!table_->Load() || !table_->GetSyllabary(&syllabary) || syllabary.empty())
+  if (collected_syllabary) {
+    syllabary = *collected_syllabary;
+  }
+  else if (!table_->Load() || !table_->GetSyllabary(&syllabary)) {
+    return false;
+  }
+  if (syllabary.empty())
     return false;
   // apply spelling algebra and prepare corrections (if enabled)
   Script script;
@@ -9,6 +9,7 @@
 
 #include <rime_api.h>
 #include <rime/common.h>
+#include <rime/dict/vocabulary.h>
 
 namespace rime {
 
@@ -18,6 +19,7 @@ class Table;
 class ReverseDb;
 class DictSettings;
 class EditDistanceCorrector;
+class ThreadPool;
 
 class DictCompiler {
  public:
@@ -32,14 +34,24 @@ class DictCompiler {
 
   RIME_API bool Compile(const string &schema_file);
   void set_options(int options) { options_ = options; }
+  // the shared thread pool by default; compiles on the calling thread
+  // only, if set to nullptr
+  void set_thread_pool(ThreadPool* thread_pool) {
+    thread_pool_ = thread_pool;
+  }
 
  private:
+  // calls build_prism, if given, with the collected syllabary concurrently
+  // with building the table.
   bool BuildTable(DictSettings* settings,
                   const vector<string>& dict_files,
-                  uint32_t dict_file_checksum);
+                  uint32_t dict_file_checksum,
+                  function<bool (const Syllabary& syllabary)> build_prism);
+  // reads the syllabary from table unless one is provided.
   bool BuildPrism(const string& schema_file,
                   uint32_t dict_file_checksum,
-                  uint32_t schema_file_checksum);
+                  uint32_t schema_file_checksum,
+                  const Syllabary* syllabary = nullptr);
   bool BuildReverseLookupDict(ReverseDb* db, uint32_t dict_file_checksum);
 
   string dict_name_;
@@ -48,6 +60,7 @@ class DictCompiler {
   an<Table> table_;
   int options_ = 0;
   string prefix_;
+  ThreadPool* thread_pool_;
 };
 
 }  // namespace rime
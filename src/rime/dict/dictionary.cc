@@ -4,8 +4,10 @@
 //
 // 2011-07-05 GONG Chen <chen.sst@gmail.com>
 //
+#include <algorithm>
 #include <boost/filesystem.hpp>
 #include <rime/algo/syllabifier.h>
+#include <rime/arena.h>
 #include <rime/common.h>
 #include <rime/dict/dictionary.h>
 #include <rime/resource.h>
@@ -27,23 +29,37 @@ bool compare_chunk_by_head_element(const Chunk& a, const Chunk& b) {
          b.credibility + b.entries[b.cursor].weight;  // by weight desc
 }
 
+// orders chunk indices for a max-heap with the best match on top
+struct HeapOrder {
+  const vector<Chunk>& chunks;
+  bool operator() (size_t a, size_t b) const {
+    return compare_chunk_by_head_element(chunks[b], chunks[a]);
+  }
+};
+
 size_t match_extra_code(const table::Code* extra_code, size_t depth,
-                        const SyllableGraph& syll_graph, size_t current_pos) {
+                        const SyllableGraph& syll_graph, size_t current_pos,
+                        size_t* reach) {
   if (!extra_code || depth >= extra_code->size)
     return current_pos;  // success
+  if (current_pos > *reach)
+    *reach = current_pos;
   if (current_pos >= syll_graph.interpreted_length)
     return 0;  // failure (possibly success for completion in the future)
-  auto index = syll_graph.indices.find(current_pos);
-  if (index == syll_graph.indices.end())
-    return 0;
+  const auto& graph(syll_graph.flat());
   SyllableId current_syll_id = extra_code->at[depth];
-  auto spellings = index->second.find(current_syll_id);
-  if (spellings == index->second.end())
-    return 0;
+  // edges in the index are grouped by syllable id
+  auto last = graph.index_end(current_pos);
+  auto it = std::lower_bound(
+      graph.index_begin(current_pos), last, current_syll_id,
+      [&graph](size_t edge, SyllableId syll_id) {
+        return graph.edges[edge].syllable_id < syll_id;
+      });
   size_t best_match = 0;
-  for (const SpellingProperties* props : spellings->second) {
+  for (; it != last && graph.edges[*it].syllable_id == current_syll_id; ++it) {
+    size_t end_pos = graph.edges[*it].properties.end_pos;
     size_t match_end_pos = match_extra_code(extra_code, depth + 1,
-                                            syll_graph, props->end_pos);
+                                            syll_graph, end_pos, reach);
     if (!match_end_pos) continue;
     if (match_end_pos > best_match)
       best_match = match_end_pos;
@@ -54,18 +70,34 @@ size_t match_extra_code(const table::Code* extra_code, size_t depth,
 }  // namespace dictionary
 
 void DictEntryIterator::AddChunk(dictionary::Chunk&& chunk, Table* table) {
-  chunks_.push_back(std::move(chunk));
   entry_count_ += chunk.size;
   table_ = table;
+  bool has_entries = chunk.entries && chunk.cursor < chunk.size;
+  chunks_.push_back(std::move(chunk));
+  if (has_entries) {
+    heap_.push_back(chunks_.size() - 1);
+    if (sorted_) {
+      std::push_heap(heap_.begin(), heap_.end(),
+                     dictionary::HeapOrder{chunks_});
+    }
+  }
+}
+
+void DictEntryIterator::CollectChunks() {
+  // list all non-exhausted chunks in the order they were added
+  heap_.clear();
+  for (size_t i = 0; i < chunks_.size(); ++i) {
+    const auto& chunk(chunks_[i]);
+    if (chunk.entries && chunk.cursor < chunk.size)
+      heap_.push_back(i);
+  }
 }
 
 void DictEntryIterator::Sort() {
-  // partial-sort remaining chunks, move best match to chunk_index_
-  std::partial_sort(
-      chunks_.begin() + chunk_index_,
-      chunks_.begin() + chunk_index_ + 1,
-      chunks_.end(),
-      dictionary::compare_chunk_by_head_element);
+  CollectChunks();
+  std::make_heap(heap_.begin(), heap_.end(),
+                 dictionary::HeapOrder{chunks_});
+  sorted_ = true;
 }
 
 void DictEntryIterator::AddFilter(DictEntryFilter filter) {
@@ -77,43 +109,87 @@ void DictEntryIterator::AddFilter(DictEntryFilter filter) {
   }
 }
 
+// DictEntryView members
+
+double DictEntryView::weight() const {
+  const double kS = 18.420680743952367; // log(1e8)
+  return entry().weight - kS + chunk_->credibility;
+}
+
+string DictEntryView::text() const {
+  return table_->GetEntryText(entry());
+}
+
+void DictEntryView::MaterializeTo(DictEntry* e) const {
+  // decode in place so that a recycled entry keeps its buffer
+  table_->GetEntryText(entry(), &e->text);
+  e->comment.clear();
+  e->preedit.clear();
+  e->weight = weight();
+  e->commit_count = 0;
+  e->code = chunk_->code;
+  e->custom_code.clear();
+  e->remaining_code_length = 0;
+  if (!chunk_->remaining_code.empty()) {
+    e->comment.assign(1, '~').append(chunk_->remaining_code);
+    e->remaining_code_length = chunk_->remaining_code.length();
+  }
+}
+
+DictEntryView DictEntryIterator::PeekView() const {
+  if (exhausted() || !table_)
+    return DictEntryView();
+  return DictEntryView(&chunks_[heap_.front()], table_);
+}
+
 an<DictEntry> DictEntryIterator::Peek() {
   if (!entry_ && !exhausted() && table_) {
-    // get next entry from current chunk
-    const auto& chunk(chunks_[chunk_index_]);
-    const auto& e(chunk.entries[chunk.cursor]);
-    DLOG(INFO) << "creating temporary dict entry '"
-               << table_->GetEntryText(e) << "'.";
-    entry_ = New<DictEntry>();
-    entry_->code = chunk.code;
-    entry_->text = table_->GetEntryText(e);
-    const double kS = 18.420680743952367; // log(1e8)
-    entry_->weight = e.weight - kS + chunk.credibility;
-    if (!chunk.remaining_code.empty()) {
-      entry_->comment = "~" + chunk.remaining_code;
-      entry_->remaining_code_length = chunk.remaining_code.length();
-    }
+    // materialize the leading entry, recycling the storage of a previous
+    // entry that has been discarded
+    if (spare_entry_.use_count() == 1)
+      entry_ = std::move(spare_entry_);
+    else
+      entry_ = ArenaNew<DictEntry>();
+    PeekView().MaterializeTo(entry_.get());
+    DLOG(INFO) << "creating temporary dict entry '" << entry_->text << "'.";
   }
   return entry_;
 }
 
+void DictEntryIterator::ReleaseEntry() {
+  if (entry_.use_count() == 1) {
+    spare_entry_ = std::move(entry_);
+  }
+  entry_.reset();
+}
+
 bool DictEntryIterator::FindNextEntry() {
   if (exhausted()) {
     return false;
   }
-  auto& chunk(chunks_[chunk_index_]);
+  ReleaseEntry();
+  if (!sorted_) {
+    // advance the chunk that leads in the order chunks were added, then
+    // order all chunks left by their head elements
+    ++chunks_[heap_.front()].cursor;
+    Sort();
+    return !exhausted();
+  }
+  dictionary::HeapOrder compare{chunks_};
+  // take the leading chunk out of the heap, and put it back if it still
+  // has entries, as it has got a new head element
+  std::pop_heap(heap_.begin(), heap_.end(), compare);
+  auto& chunk(chunks_[heap_.back()]);
   if (++chunk.cursor >= chunk.size) {
-    ++chunk_index_;
+    heap_.pop_back();
   }
   else {
-    // reorder chunks since the current chunk has got a new head element
-    Sort();
+    std::push_heap(heap_.begin(), heap_.end(), compare);
   }
   return !exhausted();
 }
 
 bool DictEntryIterator::Next() {
-  entry_.reset();
   if (!FindNextEntry()) {
     return false;
   }
@@ -125,19 +201,24 @@ bool DictEntryIterator::Next() {
   return true;
 }
 
-// Note: does not apply filters
+// walks the chunks in the order they were added; the entries left are
+// sorted again on the next advance
 bool DictEntryIterator::Skip(size_t num_entries) {
-  while (num_entries > 0) {
-    if (exhausted()) return false;
-    auto& chunk(chunks_[chunk_index_]);
+  ReleaseEntry();
+  for (auto& chunk : chunks_) {
+    if (num_entries == 0) break;
+    if (chunk.cursor >= chunk.size) continue;
     if (chunk.cursor + num_entries < chunk.size) {
       chunk.cursor += num_entries;
-      return true;
+      num_entries = 0;
+      break;
     }
     num_entries -= (chunk.size - chunk.cursor);
-    ++chunk_index_;
+    chunk.cursor = chunk.size;
   }
-  return true;
+  CollectChunks();
+  sorted_ = false;
+  return num_entries == 0;
 }
 
 // Dictionary members
@@ -158,20 +239,22 @@ Dictionary::Lookup(const SyllableGraph& syllable_graph,
                    double initial_credibility) {
   if (!loaded())
     return nullptr;
-  TableQueryResult result;
+  TableQueryResult& result(query_result_);
   if (!table_->Query(syllable_graph, start_pos, &result)) {
     return nullptr;
   }
   auto collector = New<DictEntryCollector>();
+  collector->reach = result.reach();
   // copy result
-  for (auto& v : result) {
-    size_t end_pos = v.first;
-    for (TableAccessor& a : v.second) {
+  for (size_t end_pos = start_pos; end_pos < result.length(); ++end_pos) {
+    if (!result.Has(end_pos))
+      continue;
+    for (TableAccessor& a : result[end_pos]) {
       double cr = initial_credibility + a.credibility();
       if (a.extra_code()) {
         do {
           size_t actual_end_pos = dictionary::match_extra_code(
-              a.extra_code(), 0, syllable_graph, end_pos);
+              a.extra_code(), 0, syllable_graph, end_pos, &collector->reach);
           if (actual_end_pos == 0) continue;
           (*collector)[actual_end_pos].AddChunk(
               {a.code(), a.entry(), cr}, table_.get());
@@ -183,10 +266,6 @@ Dictionary::Lookup(const SyllableGraph& syllable_graph,
       }
     }
   }
-  // sort each group of equal code length
-  for (auto& v : *collector) {
-    v.second.Sort();
-  }
   return collector;
 }
 
@@ -284,8 +363,14 @@ static const ResourceType kTableResourceType = {
   "table", "build/", ".table.bin"
 };
 
+static size_t mapped_file_size(const MappedFile& file) {
+  return file.file_size();
+}
+
 DictionaryComponent::DictionaryComponent()
-    : prism_resource_resolver_(
+    : prism_pool_(kPrismResourceType.name, mapped_file_size),
+      table_pool_(kTableResourceType.name, mapped_file_size),
+      prism_resource_resolver_(
           Service::instance().CreateResourceResolver(kPrismResourceType)),
       table_resource_resolver_(
           Service::instance().CreateResourceResolver(kTableResourceType)) {}
@@ -316,16 +401,21 @@ Dictionary*
 DictionaryComponent::CreateDictionaryWithName(const string& dict_name,
                                               const string& prism_name) {
   // obtain prism and table objects
-  auto table = table_map_[dict_name].lock();
-  if (!table) {
+  const Deployer& deployer(Service::instance().deployer());
+  auto policy = MappedFileLoadPolicy::Parse(deployer.mapped_file_policy);
+  size_t budget = deployer.resource_cache_size;
+  auto table = table_pool_.Get(dict_name, [&] {
     auto file_path = table_resource_resolver_->ResolvePath(dict_name).string();
-    table_map_[dict_name] = table = New<Table>(file_path);
-  }
-  auto prism = prism_map_[prism_name].lock();
-  if (!prism) {
+    auto table = New<Table>(file_path);
+    table->set_load_policy(policy);
+    return table;
+  }, budget);
+  auto prism = prism_pool_.Get(prism_name, [&] {
     auto file_path = prism_resource_resolver_->ResolvePath(prism_name).string();
-    prism_map_[prism_name] = prism = New<Prism>(file_path);
-  }
+    auto prism = New<Prism>(file_path);
+    prism->set_load_policy(policy);
+    return prism;
+  }, budget);
   return new Dictionary(dict_name, table, prism);
 }
 
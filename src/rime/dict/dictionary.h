@@ -10,6 +10,7 @@
 #include <rime_api.h>
 #include <rime/common.h>
 #include <rime/component.h>
+#include <rime/resource_pool.h>
 #include <rime/dict/prism.h>
 #include <rime/dict/table.h>
 #include <rime/dict/vocabulary.h>
@@ -36,10 +37,39 @@ struct Chunk {
         size(a.remaining()), cursor(0), remaining_code(r), credibility(cr) {}
 };
 
-bool compare_chunk_by_leading_element(const Chunk& a, const Chunk& b);
+bool compare_chunk_by_head_element(const Chunk& a, const Chunk& b);
 
 }  // namespace dictionary
 
+// a light-weight view of an entry in the mapped table and the chunk it
+// belongs to; text is decoded only when a DictEntry is materialized.
+class DictEntryView {
+ public:
+  DictEntryView() = default;
+  DictEntryView(const dictionary::Chunk* chunk, Table* table)
+      : chunk_(chunk), table_(table) {}
+
+  explicit operator bool() const { return chunk_ && table_; }
+
+  const Code& code() const { return chunk_->code; }
+  RIME_API double weight() const;
+  size_t remaining_code_length() const {
+    return chunk_->remaining_code.length();
+  }
+  RIME_API string text() const;
+
+  // fills in all fields of an existing entry, reusing its storage
+  RIME_API void MaterializeTo(DictEntry* entry) const;
+
+ private:
+  const table::Entry& entry() const {
+    return chunk_->entries[chunk_->cursor];
+  }
+
+  const dictionary::Chunk* chunk_ = nullptr;
+  Table* table_ = nullptr;
+};
+
 class DictEntryIterator : public DictEntryFilterBinder {
  public:
   DictEntryIterator() = default;
@@ -52,23 +82,41 @@ class DictEntryIterator : public DictEntryFilterBinder {
   void Sort();
   RIME_API void AddFilter(DictEntryFilter filter) override;
   RIME_API an<DictEntry> Peek();
+  // access the leading entry without creating a DictEntry
+  RIME_API DictEntryView PeekView() const;
   RIME_API bool Next();
-  bool Skip(size_t num_entries);
-  bool exhausted() const { return chunk_index_ >= chunks_.size(); }
+  // skips the first num_entries entries in the order chunks were added,
+  // not in the order Next() yields them, and without applying filters.
+  // LazyTableTranslation calls this on a wider lookup to drop the chunks
+  // its previous lookup has returned, which come first in the same order.
+  RIME_API bool Skip(size_t num_entries);
+  bool exhausted() const { return heap_.empty(); }
   size_t entry_count() const { return entry_count_; }
 
  protected:
   bool FindNextEntry();
+  void ReleaseEntry();
+  void CollectChunks();
 
  private:
+  // chunks in the order they were added
   vector<dictionary::Chunk> chunks_;
-  size_t chunk_index_ = 0;
+  // indices of non-exhausted chunks, organized as a max-heap on the
+  // head element of each chunk once sorted; the best match is at the front
+  vector<size_t> heap_;
+  // until sorted, by Sort() or the first advance, the first chunk added
+  // leads with its head entry
+  bool sorted_ = false;
   Table* table_ = nullptr;
   an<DictEntry> entry_ = nullptr;
+  // a released entry not referenced elsewhere, kept for reuse
+  an<DictEntry> spare_entry_ = nullptr;
   size_t entry_count_ = 0;
 };
 
 struct DictEntryCollector : map<size_t, DictEntryIterator> {
+  // the farthest vertex of the syllable graph examined by the lookup
+  size_t reach = 0;
 };
 
 class Config;
@@ -110,6 +158,8 @@ class Dictionary : public Class<Dictionary, const Ticket&> {
   string name_;
   an<Table> table_;
   an<Prism> prism_;
+  // scratch buffer reused by lookups
+  TableQueryResult query_result_;
 };
 
 class ResourceResolver;
@@ -123,8 +173,8 @@ class DictionaryComponent : public Dictionary::Component {
                                        const string& prism_name);
 
  private:
-  map<string, weak<Prism>> prism_map_;
-  map<string, weak<Table>> table_map_;
+  ResourcePool<Prism> prism_pool_;
+  ResourcePool<Table> table_pool_;
   the<ResourceResolver> prism_resource_resolver_;
   the<ResourceResolver> table_resource_resolver_;
 };
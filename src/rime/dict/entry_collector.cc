@@ -4,16 +4,19 @@
 //
 // 2011-11-27 GONG Chen <chen.sst@gmail.com>
 //
+#include <algorithm>
 #include <fstream>
 #include <boost/algorithm/string.hpp>
 #include <boost/lexical_cast.hpp>
 #include <rime/dict/dict_settings.h>
 #include <rime/dict/entry_collector.h>
+#include <rime/thread_pool.h>
 #include <rime/dict/preset_vocabulary.h>
 
 namespace rime {
 
-EntryCollector::EntryCollector() {
+EntryCollector::EntryCollector(ThreadPool* thread_pool)
+    : thread_pool(thread_pool) {
 }
 
 EntryCollector::~EntryCollector() {
@@ -34,8 +37,29 @@ void EntryCollector::Configure(DictSettings* settings) {
 }
 
 void EntryCollector::Collect(const vector<string>& dict_files) {
-  for (const string& dict_file : dict_files) {
-    Collect(dict_file);
+  // parse files on the thread pool, then collect their entries in order
+  vector<char> parsed(dict_files.size());
+  vector<vector<RawDictRow>> rows(dict_files.size());
+  if (thread_pool && dict_files.size() > 1) {
+    TaskGroup parsing(thread_pool);
+    for (size_t i = 0; i < dict_files.size(); ++i) {
+      parsing.Run([&, i] {
+        parsed[i] = ParseDictFile(dict_files[i], &rows[i]);
+      });
+    }
+    parsing.Wait();
+  }
+  else {
+    for (size_t i = 0; i < dict_files.size(); ++i) {
+      parsed[i] = ParseDictFile(dict_files[i], &rows[i]);
+    }
+  }
+  for (size_t i = 0; i < dict_files.size(); ++i) {
+    if (parsed[i]) {
+      Collect(rows[i]);
+    }
+    rows[i].clear();
+    rows[i].shrink_to_fit();
   }
   Finish();
 }
@@ -52,14 +76,15 @@ void EntryCollector::LoadPresetVocabulary(DictSettings* settings) {
   }
 }
 
-void EntryCollector::Collect(const string& dict_file) {
+bool EntryCollector::ParseDictFile(const string& dict_file,
+                                   vector<RawDictRow>* rows) {
   LOG(INFO) << "collecting entries from " << dict_file;
   // read table
   std::ifstream fin(dict_file.c_str());
   DictSettings settings;
   if (!settings.LoadDictHeader(fin)) {
     LOG(ERROR) << "missing dict settings.";
-    return;
+    return false;
   }
   // column definitions
   int text_column = settings.GetColumnIndex("text");
@@ -68,10 +93,11 @@ void EntryCollector::Collect(const string& dict_file) {
   int stem_column = settings.GetColumnIndex("stem");
   if (text_column == -1) {
     LOG(ERROR) << "missing text column definition.";
-    return;
+    return false;
   }
   bool enable_comment = true;
   string line;
+  vector<string> row;
   while (getline(fin, line)) {
     boost::algorithm::trim_right(line);
     // skip empty lines and comments
@@ -84,27 +110,39 @@ void EntryCollector::Collect(const string& dict_file) {
       continue;
     }
     // read a dict entry
-    vector<string> row;
     boost::algorithm::split(row, line,
                             boost::algorithm::is_any_of("\t"));
     int num_columns = static_cast<int>(row.size());
+    rows->emplace_back();
+    RawDictRow& r(rows->back());
     if (num_columns <= text_column || row[text_column].empty()) {
-      LOG(WARNING) << "Missing entry text at #" << num_entries << ".";
-      continue;
+      continue;  // reported when collected
     }
-    const auto& word(row[text_column]);
-    string code_str;
-    string weight_str;
-    string stem_str;
+    r.text = std::move(row[text_column]);
     if (code_column != -1 &&
         num_columns > code_column && !row[code_column].empty())
-      code_str = row[code_column];
+      r.code = std::move(row[code_column]);
     if (weight_column != -1 &&
         num_columns > weight_column && !row[weight_column].empty())
-      weight_str = row[weight_column];
+      r.weight = std::move(row[weight_column]);
     if (stem_column != -1 &&
         num_columns > stem_column && !row[stem_column].empty())
-      stem_str = row[stem_column];
+      r.stem = std::move(row[stem_column]);
+  }
+  fin.close();
+  return true;
+}
+
+void EntryCollector::Collect(const vector<RawDictRow>& rows) {
+  for (const RawDictRow& r : rows) {
+    if (r.text.empty()) {
+      LOG(WARNING) << "Missing entry text at #" << num_entries << ".";
+      continue;
+    }
+    const auto& word(r.text);
+    const auto& code_str(r.code);
+    const auto& weight_str(r.weight);
+    const auto& stem_str(r.stem);
     // collect entry
     collection.insert(word);
     if (!code_str.empty()) {
@@ -119,36 +157,158 @@ void EntryCollector::Collect(const string& dict_file) {
       stems[word].insert(stem_str);
     }
   }
-  fin.close();
   LOG(INFO) << "Pass 1: total " << num_entries << " entries collected.";
   LOG(INFO) << "num unique syllables: " << syllabary.size();
   LOG(INFO) << "num of entries to encode: " << encode_queue.size();
 }
 
 void EntryCollector::Finish() {
-  while (!encode_queue.empty()) {
-    const auto& phrase(encode_queue.front().first);
-    const auto& weight_str(encode_queue.front().second);
-    if (!encoder->EncodePhrase(phrase, weight_str)) {
-      LOG(ERROR) << "Encode failure: '" << phrase << "'.";
-    }
-    encode_queue.pop();
+  vector<pair<string, string>> phrases;
+  phrases.reserve(encode_queue.size());
+  for (; !encode_queue.empty(); encode_queue.pop()) {
+    phrases.push_back(std::move(encode_queue.front()));
   }
+  EncodePhrases(phrases, [](const string& phrase) {
+    LOG(ERROR) << "Encode failure: '" << phrase << "'.";
+  });
   LOG(INFO) << "Pass 2: total " << num_entries << " entries collected.";
   if (preset_vocabulary) {
     preset_vocabulary->Reset();
+    phrases.clear();
     string phrase, weight_str;
     while (preset_vocabulary->GetNextEntry(&phrase, &weight_str)) {
       if (collection.find(phrase) != collection.end())
         continue;
-      if (!encoder->EncodePhrase(phrase, weight_str)) {
-        LOG(WARNING) << "Encode failure: '" << phrase << "'.";
-      }
+      phrases.push_back({phrase, weight_str});
     }
+    EncodePhrases(phrases, [](const string& phrase) {
+      LOG(WARNING) << "Encode failure: '" << phrase << "'.";
+    });
   }
   LOG(INFO) << "Pass 3: total " << num_entries << " entries collected.";
 }
 
+namespace {
+
+// encoding result of a phrase on a worker thread
+struct DeferredEncoding {
+  bool ok = false;
+  vector<string> codes;
+  // words looked up in the collector while encoding
+  vector<string> words;
+};
+
+// runs on a worker thread; looks up words in the collector, which is left
+// unchanged while workers are running, and defers creating entries.
+class DeferredCollector : public PhraseCollector {
+ public:
+  explicit DeferredCollector(PhraseCollector* collector)
+      : collector_(collector) {}
+
+  void CreateEntry(const string& phrase,
+                   const string& code_str,
+                   const string& value) override {
+    result_->codes.push_back(code_str);
+  }
+  bool TranslateWord(const string& word, vector<string>* code) override {
+    result_->words.push_back(word);
+    return collector_->TranslateWord(word, code);
+  }
+
+  void set_result(DeferredEncoding* result) { result_ = result; }
+
+ private:
+  PhraseCollector* collector_;
+  DeferredEncoding* result_ = nullptr;
+};
+
+}  // namespace
+
+void EntryCollector::EncodePhrases(
+    const vector<pair<string, string>>& phrases,
+    function<void (const string& phrase)> on_failure) {
+  const size_t kMinPhrasesPerWorker = 1024;
+  const size_t kBatchSize = 65536;
+  // the waiting thread works on the tasks too
+  size_t num_workers = thread_pool ? thread_pool->num_workers() + 1 : 1;
+  auto* table_encoder = dynamic_cast<TableEncoder*>(encoder.get());
+  auto encode_range = [&](DeferredEncoding* results,
+                          size_t begin, size_t end) {
+    DeferredCollector deferred(this);
+    the<Encoder> worker_encoder;
+    if (table_encoder)
+      worker_encoder.reset(new TableEncoder(*table_encoder));
+    else
+      worker_encoder.reset(new ScriptEncoder(nullptr));
+    worker_encoder->set_collector(&deferred);
+    for (size_t i = begin; i < end; ++i) {
+      deferred.set_result(&results[i - begin]);
+      results[i - begin].ok = worker_encoder->EncodePhrase(
+          phrases[i].first, phrases[i].second);
+    }
+  };
+  vector<DeferredEncoding> results;
+  for (size_t start = 0; start < phrases.size(); ) {
+    size_t end = (std::min)(start + kBatchSize, phrases.size());
+    size_t count = end - start;
+    size_t workers = (std::min)(num_workers,
+                                (count + kMinPhrasesPerWorker - 1) /
+                                kMinPhrasesPerWorker);
+    if (workers <= 1) {
+      for (; start < end; ++start) {
+        if (!encoder->EncodePhrase(phrases[start].first,
+                                   phrases[start].second)) {
+          on_failure(phrases[start].first);
+        }
+      }
+      continue;
+    }
+    results.assign(count, DeferredEncoding());
+    {
+      TaskGroup encoding(thread_pool);
+      size_t chunk = (count + workers - 1) / workers;
+      for (size_t begin = start; begin < end; begin += chunk) {
+        size_t range_end = (std::min)(begin + chunk, end);
+        encoding.Run([&, begin, range_end] {
+          encode_range(&results[begin - start], begin, range_end);
+        });
+      }
+      encoding.Wait();
+    }
+    // create entries in order. a phrase that looked up a word updated
+    // earlier in this batch is encoded again to see the update.
+    set<string> updated_words;
+    for (size_t i = start; i < end; ++i) {
+      const auto& phrase(phrases[i].first);
+      const auto& weight_str(phrases[i].second);
+      const auto& result(results[i - start]);
+      size_t word_updates = num_word_updates;
+      bool stale = !updated_words.empty() &&
+          std::any_of(result.words.begin(), result.words.end(),
+                      [&](const string& word) {
+                        return updated_words.count(word) != 0;
+                      });
+      bool ok;
+      if (stale) {
+        ok = encoder->EncodePhrase(phrase, weight_str);
+      }
+      else {
+        for (const auto& code_str : result.codes) {
+          CreateEntry(phrase, code_str, weight_str);
+        }
+        ok = result.ok;
+      }
+      if (!ok) {
+        on_failure(phrase);
+      }
+      if (num_word_updates != word_updates) {
+        updated_words.insert(phrase);
+      }
+    }
+    start = end;
+  }
+}
+
 void EntryCollector::CreateEntry(const string &word,
                                  const string &code_str,
                                  const string &weight_str) {
@@ -196,6 +356,7 @@ void EntryCollector::CreateEntry(const string &word,
     }
     words[e.text][code_str] += e.weight;
     total_weight[e.text] += e.weight;
+    ++num_word_updates;
   }
   entries.push_back(e);
   ++num_entries;
@@ -212,9 +373,12 @@ bool EntryCollector::TranslateWord(const string& word,
   }
   WordMap::const_iterator w = words.find(word);
   if (w != words.end()) {
+    // may run on worker threads, so do not insert into total_weight
+    auto total = total_weight.find(word);
+    double word_weight = total != total_weight.end() ? total->second : 0.0;
     for (const auto& v : w->second) {
       const double kMinimalWeight = 0.05;  // 5%
-      double min_weight = total_weight[word] * kMinimalWeight;
+      double min_weight = word_weight * kMinimalWeight;
       if (v.second < min_weight)
         continue;
       result->push_back(v.first);
@@ -28,8 +28,17 @@ using WordMap = map<string, WeightMap>;
 // [ (word, weight), ... ]
 using EncodeQueue = std::queue<pair<string, string>>;
 
+// columns of a line in the dict source; text is empty for an invalid line
+struct RawDictRow {
+  string text;
+  string code;
+  string weight;
+  string stem;
+};
+
 class PresetVocabulary;
 class DictSettings;
+class ThreadPool;
 
 class EntryCollector : public PhraseCollector {
  public:
@@ -39,7 +48,9 @@ class EntryCollector : public PhraseCollector {
   ReverseLookupTable stems;
 
  public:
-  EntryCollector();
+  // parses and encodes on the thread pool if given; otherwise everything
+  // runs on the calling thread
+  explicit EntryCollector(ThreadPool* thread_pool = nullptr);
   ~EntryCollector();
 
   void Configure(DictSettings* settings);
@@ -55,10 +66,17 @@ class EntryCollector : public PhraseCollector {
                      vector<string>* code);
  protected:
   void LoadPresetVocabulary(DictSettings* settings);
-  // call Collect() multiple times for all required tables
-  void Collect(const string &dict_file);
+  // parses a dict file; files may be parsed concurrently
+  static bool ParseDictFile(const string& dict_file,
+                            vector<RawDictRow>* rows);
+  // call Collect() multiple times for all required tables, in order
+  void Collect(const vector<RawDictRow>& rows);
   // encode all collected entries
   void Finish();
+  // encodes phrases on the thread pool; entries are still created in the
+  // order of the phrases, so the result is the same as encoding serially
+  void EncodePhrases(const vector<pair<string, string>>& phrases,
+                     function<void (const string& phrase)> on_failure);
 
  protected:
   the<PresetVocabulary> preset_vocabulary;
@@ -67,6 +85,9 @@ class EntryCollector : public PhraseCollector {
   set<string/* word */> collection;
   WordMap words;
   WeightMap total_weight;
+  // counts changes to words, which may affect encoding of later phrases
+  size_t num_word_updates = 0;
+  ThreadPool* thread_pool;
 };
 
 }  // namespace rime
@@ -194,6 +194,7 @@ bool LevelDb::Update(const string& key, const string& value) {
   if (!loaded() || readonly())
     return false;
   DLOG(INFO) << "update db entry: " << key << " => " << value;
+  set_modified();
   return db_->Update(key, value, in_transaction());
 }
 
@@ -201,6 +202,7 @@ bool LevelDb::Erase(const string& key) {
   if (!loaded() || readonly())
     return false;
   DLOG(INFO) << "erase db entry: " << key;
+  set_modified();
   return db_->Erase(key, in_transaction());
 }
 
@@ -260,6 +262,7 @@ bool LevelDb::Open() {
   readonly_ = false;
   auto status = db_->Open(file_name(), readonly_);
   loaded_ = status.ok();
+  set_modified();
 
   if (loaded_) {
     string db_name;
@@ -283,6 +286,7 @@ bool LevelDb::OpenReadOnly() {
   readonly_ = true;
   auto status = db_->Open(file_name(), readonly_);
   loaded_ = status.ok();
+  set_modified();
 
   if (!loaded_) {
     LOG(ERROR) << "Error opening db '" << name_ << "' read-only.";
@@ -295,6 +299,7 @@ bool LevelDb::Close() {
     return false;
 
   db_->Release();
+  set_modified();
 
   LOG(INFO) << "closed db '" << name_ << "'.";
   loaded_ = false;
@@ -337,6 +342,7 @@ bool LevelDb::CommitTransaction() {
     return false;
   bool ok = db_->CommitBatch();
   db_->ClearBatch();
+  set_modified();
   in_transaction_ = false;
   return ok;
 }
@@ -7,6 +7,7 @@
 // 2011-06-30 GONG Chen <chen.sst@gmail.com>
 //
 #include <fstream>
+#include <boost/algorithm/string.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/interprocess/file_mapping.hpp>
 #include <boost/interprocess/mapped_region.hpp>
@@ -38,8 +39,66 @@ static BOOL resize_file_api(const char* p, boost::uintmax_t size) {
 
 #endif  // BOOST_RESIZE_FILE
 
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif  // _WIN32
+
 namespace rime {
 
+MappedFileLoadPolicy MappedFileLoadPolicy::Parse(const string& policies) {
+  MappedFileLoadPolicy policy;
+  vector<string> names;
+  boost::split(names, policies, boost::is_any_of(" ,"),
+               boost::token_compress_on);
+  for (const string& name : names) {
+    if (name == "prefetch")
+      policy.prefetch = true;
+    else if (name == "random_access")
+      policy.random_access = true;
+    else if (name == "lock_memory")
+      policy.lock_memory = true;
+    else if (!name.empty())
+      LOG(WARNING) << "unknown mapped file load policy: " << name;
+  }
+  return policy;
+}
+
+struct PageFaults {
+  long minor = 0;
+  long major = 0;
+
+  // counts faults of the calling thread where the system can tell them
+  // apart, as other threads may be loading files at the same time.
+  static PageFaults Now() {
+    PageFaults faults;
+#ifndef _WIN32
+#ifdef RUSAGE_THREAD
+    const int who = RUSAGE_THREAD;
+#else
+    const int who = RUSAGE_SELF;
+#endif  // RUSAGE_THREAD
+    struct rusage usage;
+    if (getrusage(who, &usage) == 0) {
+      faults.minor = usage.ru_minflt;
+      faults.major = usage.ru_majflt;
+    }
+#endif  // _WIN32
+    return faults;
+  }
+};
+
+#ifndef _WIN32
+// applies advice to the pages overlapping the range
+static bool advise(const void* ptr, size_t size, int advice) {
+  static const uintptr_t page_size = sysconf(_SC_PAGESIZE);
+  uintptr_t begin = reinterpret_cast<uintptr_t>(ptr) & ~(page_size - 1);
+  uintptr_t end = reinterpret_cast<uintptr_t>(ptr) + size;
+  return madvise(reinterpret_cast<void*>(begin), end - begin, advice) == 0;
+}
+#endif  // _WIN32
+
 class MappedFileImpl {
  public:
   enum OpenMode {
@@ -112,11 +171,48 @@ bool MappedFile::OpenReadOnly() {
     LOG(ERROR) << "attempt to open non-existent file '" << file_name_ << "'.";
     return false;
   }
+  PageFaults faults = PageFaults::Now();
+  open_minor_faults_ = faults.minor;
+  open_major_faults_ = faults.major;
   file_.reset(new MappedFileImpl(file_name_, MappedFileImpl::kOpenReadOnly));
   size_ = file_->get_size();
+#ifndef _WIN32
+  void* address = file_->get_address();
+  if (load_policy_.random_access && !advise(address, size_, MADV_RANDOM)) {
+    LOG(WARNING) << "madvise(MADV_RANDOM) failed for " << file_name_;
+  }
+  if (load_policy_.lock_memory && mlock(address, size_) != 0) {
+    LOG(WARNING) << "mlock failed for " << file_name_
+                 << "; check the limit of locked memory.";
+  }
+#endif  // _WIN32
   return bool(file_);
 }
 
+void MappedFile::LogPageFaults() const {
+  PageFaults now = PageFaults::Now();
+  VLOG(1) << file_name_ << ": " << size_ << " bytes mapped; page faults: "
+          << (now.minor - open_minor_faults_) << " minor, "
+          << (now.major - open_major_faults_) << " major.";
+}
+
+void MappedFile::Prefetch(const void* ptr, size_t size) {
+  if (!load_policy_.prefetch || !file_ || !ptr)
+    return;
+  const char* begin = address();
+  const char* end = begin + size_;
+  const char* first = static_cast<const char*>(ptr);
+  if (first < begin || first >= end)
+    return;
+  size = (std::min)(size, static_cast<size_t>(end - first));
+#ifndef _WIN32
+  // the kernel reads the pages ahead asynchronously
+  if (!advise(first, size, MADV_WILLNEED)) {
+    LOG(WARNING) << "madvise(MADV_WILLNEED) failed for " << file_name_;
+  }
+#endif  // _WIN32
+}
+
 bool MappedFile::OpenReadWrite() {
   if (!Exists()) {
     LOG(ERROR) << "attempt to open non-existent file '" << file_name_ << "'.";
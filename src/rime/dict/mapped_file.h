@@ -83,6 +83,19 @@ struct List {
   const T* end() const { return &at[0] + size; }
 };
 
+// hints on how pages of a read-only mapped file are accessed
+struct MappedFileLoadPolicy {
+  // read ahead regions needed first, such as indices, in the background
+  bool prefetch = false;
+  // do not read ahead when faulting in other pages
+  bool random_access = false;
+  // keep all pages resident in memory
+  bool lock_memory = false;
+
+  // parses a list of policies, eg. "prefetch random_access"
+  RIME_API static MappedFileLoadPolicy Parse(const string& policies);
+};
+
 // MappedFile class definition
 
 class MappedFileImpl;
@@ -123,9 +136,24 @@ class MappedFile : boost::noncopyable {
   const string& file_name() const { return file_name_; }
   size_t file_size() const { return size_; }
 
+  const MappedFileLoadPolicy& load_policy() const { return load_policy_; }
+  void set_load_policy(const MappedFileLoadPolicy& policy) {
+    load_policy_ = policy;
+  }
+
+ protected:
+  // reads ahead the region if the load policy asks for prefetching
+  void Prefetch(const void* ptr, size_t size);
+  // logs the page faults taken on this thread since the file was opened
+  // read-only, ie. by loading it and any lookups done since.
+  void LogPageFaults() const;
+
  private:
   string file_name_;
   size_t size_ = 0;
+  long open_minor_faults_ = 0;
+  long open_major_faults_ = 0;
+  MappedFileLoadPolicy load_policy_;
   the<MappedFileImpl> file_;
 };
 
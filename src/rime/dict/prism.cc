@@ -106,11 +106,17 @@ bool Prism::Load() {
   size_t array_size = metadata_->double_array_size;
   LOG(INFO) << "found double array image of size " << array_size << ".";
   trie_->set_array(array, array_size);
+  Prefetch(array, trie_->total_size());
 
   spelling_map_ = NULL;
   if (format_ > 1.0 - DBL_EPSILON) {
     spelling_map_ = metadata_->spelling_map.get();
   }
+  if (VLOG_IS_ON(1)) {
+    // a warm-up lookup, to count the faults the first keystroke takes
+    HasKey("a");
+    LogPageFaults();
+  }
   return true;
 }
 
@@ -54,11 +54,18 @@ bool ReverseDb::Load() {
   }
   //double format = atof(&metadata_->format[kReverseFormatPrefixLen]);
 
+  Prefetch(metadata_->key_trie.get(), metadata_->key_trie_size);
   key_trie_.reset(new StringTable(metadata_->key_trie.get(),
                                   metadata_->key_trie_size));
   value_trie_.reset(new StringTable(metadata_->value_trie.get(),
                                     metadata_->value_trie_size));
 
+  if (VLOG_IS_ON(1)) {
+    // a warm-up lookup, to count the faults the first query takes
+    string result;
+    Lookup("a", &result);
+    LogPageFaults();
+  }
   return true;
 }
 
@@ -71,8 +78,7 @@ bool ReverseDb::Lookup(const string& text, string* result) {
     return false;
   }
   StringId value_id = metadata_->index.at[key_id];
-  *result = value_trie_->GetString(value_id);
-  return !result->empty();
+  return value_trie_->GetString(value_id, result) && !result->empty();
 }
 
 bool ReverseDb::Build(DictSettings* settings,
@@ -230,7 +236,9 @@ static const ResourceType kReverseDbResourceType = {
 };
 
 ReverseLookupDictionaryComponent::ReverseLookupDictionaryComponent()
-    : resource_resolver_(
+    : db_pool_(kReverseDbResourceType.name,
+               [](const ReverseDb& db) { return db.file_size(); }),
+      resource_resolver_(
           Service::instance().CreateResourceResolver(kReverseDbResourceType)) {
 }
 
@@ -244,12 +252,14 @@ ReverseLookupDictionaryComponent::Create(const Ticket& ticket) {
     // missing!
     return NULL;
   }
-  auto db = db_pool_[dict_name].lock();
-  if (!db) {
+  const Deployer& deployer(Service::instance().deployer());
+  auto db = db_pool_.Get(dict_name, [&] {
     auto file_path = resource_resolver_->ResolvePath(dict_name).string();
-    db = New<ReverseDb>(file_path);
-    db_pool_[dict_name] = db;
-  }
+    auto db = New<ReverseDb>(file_path);
+    db->set_load_policy(
+        MappedFileLoadPolicy::Parse(deployer.mapped_file_policy));
+    return db;
+  }, deployer.resource_cache_size);
   return new ReverseLookupDictionary(db);
 }
 
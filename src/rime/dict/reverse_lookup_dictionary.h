@@ -11,6 +11,7 @@
 #include <stdint.h>
 #include <rime/common.h>
 #include <rime/component.h>
+#include <rime/resource_pool.h>
 #include <rime/dict/mapped_file.h>
 #include <rime/dict/string_table.h>
 #include <rime/dict/vocabulary.h>
@@ -79,7 +80,7 @@ class ReverseLookupDictionaryComponent
   ReverseLookupDictionaryComponent();
   ReverseLookupDictionary* Create(const Ticket& ticket);
  private:
-  map<string, weak<ReverseDb>> db_pool_;
+  ResourcePool<ReverseDb> db_pool_;
   the<ResourceResolver> resource_resolver_;
 };
 
@@ -31,6 +31,8 @@ class StringTable {
   void Predict(const string& query,
                vector<StringId>* result);
   string GetString(StringId string_id);
+  // decodes into an existing string, reusing its storage
+  bool GetString(StringId string_id, string* result);
 
   size_t NumKeys() const;
   size_t BinarySize() const;
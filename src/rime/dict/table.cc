@@ -7,7 +7,6 @@
 #include <cfloat>
 #include <cstring>
 #include <algorithm>
-#include <queue>
 #include <utility>
 #include <rime/common.h>
 #include <rime/algo/syllabifier.h>
@@ -16,48 +15,12 @@
 namespace rime
 {
 
-  const char kTableFormatLatest[] = "Rime::Table/4.0";
+  const char kTableFormatLatest[] = "Rime::Table/5.0";
   int kTableFormatLowestCompatible = 4.0;
 
   const char kTableFormatPrefix[] = "Rime::Table/";
   const size_t kTableFormatPrefixLen = sizeof(kTableFormatPrefix) - 1;
 
-  class TableQuery
-  {
-  public:
-    TableQuery(table::Index *index) : lv1_index_(index)
-    {
-      Reset();
-    }
-
-    TableAccessor Access(SyllableId syllable_id,
-                         double credibility = 0.0) const;
-
-    // down to next level
-    bool Advance(SyllableId syllable_id, double credibility = 0.0);
-
-    // up one level
-    bool Backdate();
-
-    // back to root
-    void Reset();
-
-    size_t level() const { return level_; }
-
-  protected:
-    size_t level_ = 0;
-    Code index_code_;
-    vector<double> credibility_;
-
-  private:
-    bool Walk(SyllableId syllable_id);
-
-    table::HeadIndex *lv1_index_ = nullptr;
-    table::TrunkIndex *lv2_index_ = nullptr;
-    table::TrunkIndex *lv3_index_ = nullptr;
-    table::TailIndex *lv4_index_ = nullptr;
-  };
-
   TableAccessor::TableAccessor(const Code &index_code,
                                const List<table::Entry> *list,
                                double credibility)
@@ -286,14 +249,61 @@ namespace rime
   //   return CopyString(src, &dest->str());
   // }
 
+  // since v5, a negative value refers to a short string at offset -value - 1
+  // in the short string area; otherwise it is a string id.
+
+  static const size_t kMaxShortStringLength = 4;  // in characters
+
+  static bool is_short_string(const string &str)
+  {
+    size_t num_chars = 0;
+    for (unsigned char c : str)
+    {
+      // count all but continuation bytes of UTF-8 sequences
+      if ((c & 0xc0) != 0x80 && ++num_chars > kMaxShortStringLength)
+        return false;
+    }
+    return num_chars > 0;
+  }
+
   string Table::GetString(const table::StringType &x)
   {
-    return string_table_->GetString(x.str_id());
+    string result;
+    GetString(x, &result);
+    return result;
+  }
+
+  bool Table::GetString(const table::StringType &x, string *result)
+  {
+    if (x.value < 0)
+    {
+      size_t offset = static_cast<size_t>(-(x.value + 1));
+      if (!short_strings_ || offset >= short_strings_size_)
+      {
+        result->clear();
+        return false;
+      }
+      result->assign(short_strings_ + offset);
+      return true;
+    }
+    return string_table_->GetString(x.str_id(), result);
   }
 
   bool Table::AddString(const string &src, table::StringType *dest,
                         double weight)
   {
+    if (is_short_string(src))
+    {
+      auto found = short_string_offsets_.find(src);
+      if (found == short_string_offsets_.end())
+      {
+        int32_t offset = static_cast<int32_t>(short_strings_builder_.size());
+        short_strings_builder_.append(src.c_str(), src.length() + 1);
+        found = short_string_offsets_.emplace(src, offset).first;
+      }
+      dest->value = -found->second - 1;
+      return true;
+    }
     string_table_builder_->Add(src, weight, &dest->str_id());
     return true;
   }
@@ -301,11 +311,28 @@ namespace rime
   bool Table::OnBuildStart()
   {
     string_table_builder_.reset(new StringTableBuilder);
+    short_strings_builder_.clear();
+    short_string_offsets_.clear();
     return true;
   }
 
   bool Table::OnBuildFinish()
   {
+    // saving short strings
+    if (!short_strings_builder_.empty())
+    {
+      char *area = Allocate<char>(short_strings_builder_.size());
+      if (!area)
+      {
+        LOG(ERROR) << "Error creating short string area.";
+        return false;
+      }
+      std::memcpy(area, short_strings_builder_.data(),
+                  short_strings_builder_.size());
+      metadata_->short_strings = area;
+      metadata_->short_strings_size = short_strings_builder_.size();
+    }
+    LOG(INFO) << short_string_offsets_.size() << " short strings stored inline.";
     string_table_builder_->Build();
     // saving string table image
     size_t image_size = string_table_builder_->BinarySize();
@@ -323,6 +350,9 @@ namespace rime
 
   bool Table::OnLoad()
   {
+    // absent from tables before v5
+    short_strings_ = metadata_->short_strings.get();
+    short_strings_size_ = short_strings_ ? metadata_->short_strings_size : 0;
     string_table_.reset(new StringTable(metadata_->string_table.get(),
                                         metadata_->string_table_size));
     return true;
@@ -385,8 +415,27 @@ namespace rime
       Close();
       return false;
     }
+    // looked up on every keystroke
+    Prefetch(syllabary_, sizeof(table::Syllabary) +
+             syllabary_->size * sizeof(table::StringType));
+    Prefetch(index_, sizeof(table::Index) +
+             index_->size * sizeof(table::HeadIndexNode));
+    Prefetch(metadata_->short_strings.get(), metadata_->short_strings_size);
+    Prefetch(metadata_->string_table.get(), metadata_->string_table_size);
 
-    return OnLoad();
+    if (!OnLoad())
+      return false;
+    if (VLOG_IS_ON(1))
+    {
+      // a warm-up lookup, to count the faults the first keystroke takes
+      if (syllabary_->size > 0)
+      {
+        GetSyllableById(0);
+        QueryWords(0);
+      }
+      LogPageFaults();
+    }
+    return true;
   }
 
   bool Table::Save()
@@ -691,6 +740,29 @@ namespace rime
     return query.Access(-1);
   }
 
+  void TableQueryResult::Reset(size_t input_length)
+  {
+    for (size_t i = 0; i < length_; ++i)
+    {
+      slots_[i].clear();
+    }
+    if (slots_.size() < input_length + 1)
+      slots_.resize(input_length + 1);
+    length_ = input_length + 1;
+    reach_ = 0;
+  }
+
+  size_t TableQueryResult::size() const
+  {
+    size_t count = 0;
+    for (size_t i = 0; i < length_; ++i)
+    {
+      if (!slots_[i].empty())
+        ++count;
+    }
+    return count;
+  }
+
   bool Table::Query(const SyllableGraph &syll_graph, size_t start_pos,
                     TableQueryResult *result)
   {
@@ -698,50 +770,58 @@ namespace rime
         !index_ ||
         start_pos >= syll_graph.interpreted_length)
       return false;
-    result->clear();
-    std::queue<pair<size_t, TableQuery>> q;
-    TableQuery initial_state(index_);
-    q.push({start_pos, initial_state});
-    while (!q.empty())
-    {
-      size_t current_pos = q.front().first;
-      TableQuery query(q.front().second);
-      q.pop();
-      auto index = syll_graph.indices.find(current_pos);
-      if (index == syll_graph.indices.end())
+    result->Reset(syll_graph.interpreted_length);
+    // depth-first walk sharing one query state, instead of copying it into
+    // a queue at each step
+    TableQuery query(index_);
+    QueryFrom(syll_graph, start_pos, &query, result);
+    return !result->empty();
+  }
+
+  void Table::QueryFrom(const SyllableGraph &syll_graph,
+                        size_t current_pos,
+                        TableQuery *query,
+                        TableQueryResult *result)
+  {
+    const auto &graph(syll_graph.flat());
+    result->Visit(current_pos);
+    auto first = graph.index_begin(current_pos);
+    auto last = graph.index_end(current_pos);
+    if (first == last)
+    {
+      return;
+    }
+    if (query->level() == Code::kIndexCodeMaxLength)
+    {
+      TableAccessor accessor(query->Access(-1));
+      if (!accessor.exhausted())
       {
-        continue;
+        (*result)[current_pos].push_back(std::move(accessor));
       }
-      if (query.level() == Code::kIndexCodeMaxLength)
+      return;
+    }
+    // edges in the index are grouped by syllable id
+    for (auto it = first; it != last;)
+    {
+      SyllableId syll_id = graph.edges[*it].syllable_id;
+      TableAccessor accessor(query->Access(syll_id));
+      for (; it != last && graph.edges[*it].syllable_id == syll_id; ++it)
       {
-        TableAccessor accessor(query.Access(-1));
+        const auto &props(graph.edges[*it].properties);
+        size_t end_pos = props.end_pos;
+        result->Visit(end_pos);
         if (!accessor.exhausted())
         {
-          (*result)[current_pos].push_back(accessor);
+          (*result)[end_pos].push_back(accessor);
         }
-        continue;
-      }
-      for (const auto &spellings : index->second)
-      {
-        SyllableId syll_id = spellings.first;
-        TableAccessor accessor(query.Access(syll_id));
-        for (auto props : spellings.second)
+        if (end_pos < syll_graph.interpreted_length &&
+            query->Advance(syll_id, props.credibility))
         {
-          size_t end_pos = props->end_pos;
-          if (!accessor.exhausted())
-          {
-            (*result)[end_pos].push_back(accessor);
-          }
-          if (end_pos < syll_graph.interpreted_length &&
-              query.Advance(syll_id, props->credibility))
-          {
-            q.push({end_pos, query});
-            query.Backdate();
-          }
+          QueryFrom(syll_graph, end_pos, query, result);
+          query->Backdate();
         }
       }
     }
-    return !result->empty();
   }
 
   string Table::GetEntryText(const table::Entry &entry)
@@ -749,4 +829,9 @@ namespace rime
     return GetString(entry.text);
   }
 
+  bool Table::GetEntryText(const table::Entry &entry, string *text)
+  {
+    return GetString(entry.text, text);
+  }
+
 } // namespace rime
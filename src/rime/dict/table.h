@@ -90,8 +90,9 @@ struct Metadata {
   OffsetPtr<Syllabary> syllabary;
   OffsetPtr<Index> index;
   // v2
-  int32_t reserved_1;
-  int32_t reserved_2;
+  // v5: short strings stored inline, in place of reserved fields
+  OffsetPtr<char> short_strings;
+  uint32_t short_strings_size;
   OffsetPtr<char> string_table;
   uint32_t string_table_size;
 };
@@ -127,10 +128,83 @@ class TableAccessor {
   double credibility_ = 0.0;
 };
 
-using TableQueryResult = map<int, vector<TableAccessor>>;
+// table accessors grouped by the end position of matching codes, indexed
+// by position in the input. the buffers are reused across queries.
+class TableQueryResult {
+ public:
+  // clears results, retaining allocated storage, and makes room for
+  // end positions up to input_length
+  RIME_API void Reset(size_t input_length);
+
+  vector<TableAccessor>& operator[] (size_t end_pos) {
+    if (end_pos >= slots_.size())
+      slots_.resize(end_pos + 1);
+    if (end_pos >= length_)
+      length_ = end_pos + 1;
+    return slots_[end_pos];
+  }
+  const vector<TableAccessor>& at(size_t end_pos) const {
+    return slots_[end_pos];
+  }
+  bool Has(size_t end_pos) const {
+    return end_pos < length_ && !slots_[end_pos].empty();
+  }
+  // one past the last end position that could hold results
+  size_t length() const { return length_; }
+  // number of end positions with matching entries
+  RIME_API size_t size() const;
+  bool empty() const { return size() == 0; }
+
+  // records a vertex of the syllable graph examined by the query
+  void Visit(size_t pos) {
+    if (pos > reach_)
+      reach_ = pos;
+  }
+  // the farthest vertex examined; results stay valid for any graph that
+  // shares the same edges up to and including this vertex
+  size_t reach() const { return reach_; }
+
+ private:
+  vector<vector<TableAccessor>> slots_;
+  size_t length_ = 0;
+  size_t reach_ = 0;
+};
+
+class TableQuery {
+ public:
+  TableQuery(table::Index* index) : lv1_index_(index) {
+    Reset();
+  }
+
+  TableAccessor Access(SyllableId syllable_id,
+                       double credibility = 0.0) const;
+
+  // down to next level
+  bool Advance(SyllableId syllable_id, double credibility = 0.0);
+
+  // up one level
+  bool Backdate();
+
+  // back to root
+  void Reset();
+
+  size_t level() const { return level_; }
+
+ protected:
+  size_t level_ = 0;
+  Code index_code_;
+  vector<double> credibility_;
+
+ private:
+  bool Walk(SyllableId syllable_id);
+
+  table::HeadIndex* lv1_index_ = nullptr;
+  table::TrunkIndex* lv2_index_ = nullptr;
+  table::TrunkIndex* lv3_index_ = nullptr;
+  table::TailIndex* lv4_index_ = nullptr;
+};
 
 struct SyllableGraph;
-class TableQuery;
 
 class Table : public MappedFile {
  public:
@@ -152,6 +226,8 @@ class Table : public MappedFile {
                       size_t start_pos,
                       TableQueryResult* result);
   RIME_API string GetEntryText(const table::Entry& entry);
+  // decodes entry text into an existing string, reusing its storage
+  RIME_API bool GetEntryText(const table::Entry& entry, string* text);
 
   uint32_t dict_file_checksum() const;
 
@@ -169,8 +245,13 @@ class Table : public MappedFile {
   Array<table::Entry>* BuildEntryArray(const DictEntryList& entries);
   bool BuildEntryList(const DictEntryList& src, List<table::Entry>* dest);
   bool BuildEntry(const DictEntry& dict_entry, table::Entry* entry);
+  void QueryFrom(const SyllableGraph& syll_graph,
+                 size_t current_pos,
+                 TableQuery* query,
+                 TableQueryResult* result);
 
   string GetString(const table::StringType& x);
+  bool GetString(const table::StringType& x, string* result);
   bool AddString(const string& src, table::StringType* dest,
                     double weight);
   bool OnBuildStart();
@@ -184,6 +265,12 @@ class Table : public MappedFile {
 
   the<StringTable> string_table_;
   the<StringTableBuilder> string_table_builder_;
+  // texts of up to kMaxShortStringLength characters are not stored in
+  // the string table but in this area, null terminated
+  const char* short_strings_ = nullptr;
+  size_t short_strings_size_ = 0;
+  string short_strings_builder_;
+  hash_map<string, int32_t> short_string_offsets_;
 };
 
 }  // namespace rime
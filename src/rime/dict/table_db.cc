@@ -50,7 +50,11 @@ static bool rime_table_entry_formatter(const string& key,
   if (row.size() != 2 ||
       row[0].empty() || row[1].empty())
     return false;
-  UserDbValue v(value);
+  UserDbValue v;
+  if (!v.Unpack(value)) {
+    LOG(WARNING) << "skipped corrupt record '" << key << "' in export.";
+    return false;
+  }
   if (v.commits < 0)  // deleted entry
     return false;
   boost::algorithm::trim(row[0]);  // remove trailing space
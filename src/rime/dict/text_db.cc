@@ -4,6 +4,7 @@
 //
 // 2013-04-14 GONG Chen <chen.sst@gmail.com>
 //
+#include <boost/algorithm/string.hpp>
 #include <rime/dict/db_utils.h>
 #include <rime/dict/text_db.h>
 
@@ -17,6 +18,12 @@ TextDbAccessor::TextDbAccessor(const TextDbData& data,
   Reset();
 }
 
+TextDbAccessor::TextDbAccessor(TextDbData&& snapshot,
+                               const string& prefix)
+    : DbAccessor(prefix), snapshot_(std::move(snapshot)), data_(snapshot_) {
+  Reset();
+}
+
 TextDbAccessor::~TextDbAccessor() {
 }
 
@@ -57,9 +64,12 @@ TextDb::~TextDb() {
 }
 
 an<DbAccessor> TextDb::QueryMetadata() {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
   if (!loaded())
     return nullptr;
-  return New<TextDbAccessor>(metadata_, "");
+  if (readonly())
+    return New<TextDbAccessor>(metadata_, "");
+  return New<TextDbAccessor>(TextDbData(metadata_), "");
 }
 
 an<DbAccessor> TextDb::QueryAll() {
@@ -67,12 +77,21 @@ an<DbAccessor> TextDb::QueryAll() {
 }
 
 an<DbAccessor> TextDb::Query(const string& key) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
   if (!loaded())
     return nullptr;
-  return New<TextDbAccessor>(data_, key);
+  if (readonly())
+    return New<TextDbAccessor>(data_, key);
+  TextDbData snapshot;
+  for (auto it = data_.lower_bound(key);
+       it != data_.end() && boost::starts_with(it->first, key); ++it) {
+    snapshot.emplace_hint(snapshot.end(), *it);
+  }
+  return New<TextDbAccessor>(std::move(snapshot), key);
 }
 
 bool TextDb::Fetch(const string& key, string* value) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
   if (!value || !loaded())
     return false;
   TextDbData::const_iterator it = data_.find(key);
@@ -83,25 +102,30 @@ bool TextDb::Fetch(const string& key, string* value) {
 }
 
 bool TextDb::Update(const string& key, const string& value) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
   if (!loaded() || readonly())
     return false;
   DLOG(INFO) << "update db entry: " << key << " => " << value;
   data_[key] = value;
   modified_ = true;
+  set_modified();
   return true;
 }
 
 bool TextDb::Erase(const string& key) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
   if (!loaded() || readonly())
     return false;
   DLOG(INFO) << "erase db entry: " << key;
   if (data_.erase(key) == 0)
     return false;
   modified_ = true;
+  set_modified();
   return true;
 }
 
 bool TextDb::Open() {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
   if (loaded())
     return false;
   loaded_ = true;
@@ -120,10 +144,12 @@ bool TextDb::Open() {
     LOG(ERROR) << "Error opening db '" << name_ << "'.";
   }
   modified_ = false;
+  set_modified();
   return loaded_;
 }
 
 bool TextDb::OpenReadOnly() {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
   if (loaded())
     return false;
   loaded_ = true;
@@ -136,10 +162,12 @@ bool TextDb::OpenReadOnly() {
     LOG(ERROR) << "Error opening db '" << name_ << "' read-only.";
   }
   modified_ = false;
+  set_modified();
   return loaded_;
 }
 
 bool TextDb::Close() {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
   if (!loaded()) return false;
   if (modified_ && !SaveToFile(file_name())) {
     return false;
@@ -148,10 +176,12 @@ bool TextDb::Close() {
   readonly_ = false;
   Clear();
   modified_ = false;
+  set_modified();
   return true;
 }
 
 void TextDb::Clear() {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
   metadata_.clear();
   data_.clear();
 }
@@ -169,6 +199,7 @@ bool TextDb::Backup(const string& snapshot_file) {
 }
 
 bool TextDb::Restore(const string& snapshot_file) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
   if (!loaded() || readonly())
     return false;
   if (!LoadFromFile(snapshot_file)) {
@@ -177,6 +208,7 @@ bool TextDb::Restore(const string& snapshot_file) {
     return false;
   }
   modified_ = false;
+  set_modified();
   return true;
 }
 
@@ -186,6 +218,7 @@ bool TextDb::CreateMetadata() {
 }
 
 bool TextDb::MetaFetch(const string& key, string* value) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
   if (!value || !loaded())
     return false;
   TextDbData::const_iterator it = metadata_.find(key);
@@ -196,11 +229,13 @@ bool TextDb::MetaFetch(const string& key, string* value) {
 }
 
 bool TextDb::MetaUpdate(const string& key, const string& value) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
   if (!loaded() || readonly())
     return false;
   DLOG(INFO) << "update db metadata: " << key << " => " << value;
   metadata_[key] = value;
   modified_ = true;
+  set_modified();
   return true;
 }
 
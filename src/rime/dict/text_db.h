@@ -7,6 +7,7 @@
 #ifndef RIME_TEXT_DB_H_
 #define RIME_TEXT_DB_H_
 
+#include <mutex>
 #include <rime/dict/db.h>
 #include <rime/dict/tsv.h>
 
@@ -19,6 +20,8 @@ using TextDbData = map<string, string>;
 class TextDbAccessor : public DbAccessor {
  public:
   TextDbAccessor(const TextDbData& data, const string& prefix);
+  // iterates a private copy of the records
+  TextDbAccessor(TextDbData&& snapshot, const string& prefix);
   virtual ~TextDbAccessor();
 
   virtual bool Reset();
@@ -27,6 +30,7 @@ class TextDbAccessor : public DbAccessor {
   virtual bool exhausted();
 
  private:
+  TextDbData snapshot_;
   const TextDbData& data_;
   TextDbData::const_iterator iter_;
 };
@@ -37,6 +41,9 @@ struct TextFormat {
   string file_description;
 };
 
+// Sessions sharing a user dictionary may use its db from several threads.
+// Records are guarded by a mutex; queries on a writable db iterate a copy
+// of the matching records, so updates never move records under an accessor.
 class TextDb : public Db {
  public:
   TextDb(const string& name,
@@ -72,6 +79,8 @@ class TextDb : public Db {
   TextDbData metadata_;
   TextDbData data_;
   bool modified_ = false;
+  // recursive as loading from a file goes through Update()
+  std::recursive_mutex mutex_;
 };
 
 }  // namespace rime
@@ -4,7 +4,9 @@
 //
 // 2011-11-02 GONG Chen <chen.sst@gmail.com>
 //
+#include <algorithm>
 #include <cstdlib>
+#include <cstring>
 #include <boost/algorithm/string.hpp>
 #include <boost/format.hpp>
 #include <boost/lexical_cast.hpp>
@@ -15,6 +17,32 @@
 
 namespace rime {
 
+// binary value ::= version commits dee tick
+//   commits: zigzag encoded varint
+//   dee: 64-bit IEEE 754 double, little-endian
+//   tick: varint
+static const char kBinaryValueVersion = '\x01';
+static const size_t kMaxBinaryValueSize = 1 + 5 + 8 + 10;
+
+static void append_varint(uint64_t x, string* output) {
+  while (x >= 0x80) {
+    output->push_back(static_cast<char>((x & 0x7f) | 0x80));
+    x >>= 7;
+  }
+  output->push_back(static_cast<char>(x));
+}
+
+static bool read_varint(const char*& p, const char* end, uint64_t* x) {
+  *x = 0;
+  for (int shift = 0; p != end && shift < 64; shift += 7) {
+    uint64_t byte = static_cast<unsigned char>(*p++);
+    *x |= (byte & 0x7f) << shift;
+    if (!(byte & 0x80))
+      return true;
+  }
+  return false;
+}
+
 UserDbValue::UserDbValue(const string& value) {
   Unpack(value);
 }
@@ -24,32 +52,86 @@ string UserDbValue::Pack() const {
                     commits % dee % tick);
 }
 
+string UserDbValue::PackBinary() const {
+  string packed;
+  packed.reserve(kMaxBinaryValueSize);
+  packed.push_back(kBinaryValueVersion);
+  uint32_t c = static_cast<uint32_t>(commits);
+  append_varint((c << 1) ^ (commits < 0 ? 0xffffffffu : 0u), &packed);
+  uint64_t d;
+  std::memcpy(&d, &dee, sizeof(d));
+  for (int i = 0; i < 8; ++i) {
+    packed.push_back(static_cast<char>(d >> (i * 8)));
+  }
+  append_varint(tick, &packed);
+  return packed;
+}
+
+bool UserDbValue::IsBinary(const string& value) {
+  return !value.empty() && value[0] == kBinaryValueVersion;
+}
+
 bool UserDbValue::Unpack(const string& value) {
-  vector<string> kv;
-  boost::split(kv, value, boost::is_any_of(" "));
-  for (const string& k_eq_v : kv) {
-    size_t eq = k_eq_v.find('=');
-    if (eq == string::npos)
+  // fields are left untouched unless the whole value parses
+  if (IsBinary(value)) {
+    const char* p = value.data() + 1;
+    const char* end = value.data() + value.length();
+    uint64_t c, d = 0, t;
+    bool ok = read_varint(p, end, &c) && end - p >= 8;
+    if (ok) {
+      for (int i = 0; i < 8; ++i) {
+        d |= uint64_t(static_cast<unsigned char>(*p++)) << (i * 8);
+      }
+      ok = read_varint(p, end, &t) && p == end;
+    }
+    if (!ok) {
+      LOG(ERROR) << "failed in parsing binary userdb entry value.";
+      return false;
+    }
+    uint32_t zigzag = static_cast<uint32_t>(c);
+    commits = static_cast<int>((zigzag >> 1) ^ (~(zigzag & 1) + 1));
+    std::memcpy(&dee, &d, sizeof(dee));
+    dee = (std::min)(10000.0, dee);
+    tick = t;
+    return true;
+  }
+  // legacy text format
+  UserDbValue parsed;
+  const char* p = value.c_str();
+  const char* end = p + value.length();
+  while (p != end) {
+    const char* k = p;
+    const char* sep = std::find(k, end, ' ');
+    p = sep != end ? sep + 1 : end;
+    if (sep == k)
       continue;
-    string k(k_eq_v.substr(0, eq));
-    string v(k_eq_v.substr(eq + 1));
+    const char* eq = std::find(k, sep, '=');
+    if (eq == sep || eq - k != 1) {
+      LOG(ERROR) << "malformed key-value in userdb entry '"
+                 << string(k, sep) << "'.";
+      return false;
+    }
+    const char* v = eq + 1;
+    size_t len = sep - v;
     try {
-      if (k == "c") {
-        commits = boost::lexical_cast<int>(v);
+      if (*k == 'c') {
+        parsed.commits = boost::lexical_cast<int>(v, len);
       }
-      else if (k == "d") {
-        dee = (std::min)(10000.0, boost::lexical_cast<double>(v));
+      else if (*k == 'd') {
+        parsed.dee = (std::min)(10000.0,
+                                boost::lexical_cast<double>(v, len));
       }
-      else if (k == "t") {
-        tick = boost::lexical_cast<TickCount>(v);
+      else if (*k == 't') {
+        parsed.tick = boost::lexical_cast<TickCount>(v, len);
       }
     }
     catch (...) {
       LOG(ERROR) << "failed in parsing key-value from userdb entry '"
-                 << k_eq_v << "'.";
+                 << string(k, sep) << "'.";
       return false;
     }
   }
+  *this = parsed;
   return true;
 }
 
@@ -95,7 +177,13 @@ static bool userdb_entry_formatter(const string& key,
   if (row.size() != 2 ||
       row[0].empty() || row[1].empty())
     return false;
-  row.push_back(value);
+  // snapshots are always in text format
+  UserDbValue v;
+  if (!v.Unpack(value)) {
+    LOG(WARNING) << "skipped corrupt record '" << key << "' in export.";
+    return false;
+  }
+  row.push_back(UserDbValue::IsBinary(value) ? v.Pack() : value);
   return true;
 }
 
@@ -115,6 +203,11 @@ bool UserDbHelper::UpdateUserInfo() {
   return db_->MetaUpdate("/user_id", deployer.user_id);
 }
 
+string UserDbHelper::PackValue(const UserDbValue& value) {
+  // plain text user dbs are meant to be human readable
+  return dynamic_cast<TextDb*>(db_) ? value.Pack() : value.PackBinary();
+}
+
 bool UserDbHelper::IsUniformFormat(const string& file_name) {
   return boost::ends_with(file_name, plain_userdb_extension);
 }
@@ -215,14 +308,19 @@ bool UserDbMerger::MetaPut(const string& key, const string& value) {
 
 bool UserDbMerger::Put(const string& key, const string& value) {
   if (!db_) return false;
-  UserDbValue v(value);
+  UserDbValue v;
+  if (!v.Unpack(value)) {
+    LOG(WARNING) << "skipped corrupt record '" << key << "' in merge.";
+    return false;
+  }
   if (v.tick < their_tick_) {
     v.dee = algo::formula_d(0, (double)their_tick_, v.dee, (double)v.tick);
   }
   UserDbValue o;
   string our_value;
-  if (db_->Fetch(key, &our_value)) {
-    o.Unpack(our_value);
+  if (db_->Fetch(key, &our_value) && !o.Unpack(our_value)) {
+    LOG(WARNING) << "replacing corrupt record '" << key << "' in merge.";
+    o = UserDbValue();
   }
   if (o.tick < our_tick_) {
     o.dee = algo::formula_d(0, (double)our_tick_, o.dee, (double)o.tick);
@@ -231,7 +329,8 @@ bool UserDbMerger::Put(const string& key, const string& value) {
       o.commits = v.commits;
   o.dee = (std::max)(o.dee, v.dee);
   o.tick = max_tick_;
-  return db_->Update(key, o.Pack()) && ++merged_entries_;
+  return db_->Update(key, UserDbHelper(db_).PackValue(o)) &&
+      ++merged_entries_;
 }
 
 void UserDbMerger::CloseMerge() {
@@ -261,11 +360,16 @@ bool UserDbImporter::MetaPut(const string& key, const string& value) {
 
 bool UserDbImporter::Put(const string& key, const string& value) {
   if (!db_) return false;
-  UserDbValue v(value);
+  UserDbValue v;
+  if (!v.Unpack(value)) {
+    LOG(WARNING) << "skipped corrupt record '" << key << "' in import.";
+    return false;
+  }
   UserDbValue o;
   string old_value;
-  if (db_->Fetch(key, &old_value)) {
-    o.Unpack(old_value);
+  if (db_->Fetch(key, &old_value) && !o.Unpack(old_value)) {
+    LOG(WARNING) << "replacing corrupt record '" << key << "' in import.";
+    o = UserDbValue();
   }
   if (v.commits > 0) {
     o.commits = (std::max)(o.commits, v.commits);
@@ -274,7 +378,7 @@ bool UserDbImporter::Put(const string& key, const string& value) {
   else if (v.commits < 0) {  // mark as deleted
     o.commits = (std::min)(v.commits, -std::abs(o.commits));
   }
-  return db_->Update(key, o.Pack());
+  return db_->Update(key, UserDbHelper(db_).PackValue(o));
 }
 
 }  // namespace rime
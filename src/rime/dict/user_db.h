@@ -25,8 +25,14 @@ struct UserDbValue {
   UserDbValue() = default;
   UserDbValue(const string& value);
 
+  /// Packs in the text format, e.g. "c=3 d=1.234 t=5678".
   string Pack() const;
+  /// Packs in the compact binary format.
+  string PackBinary() const;
+  /// Accepts values in either format.
   bool Unpack(const string& value);
+
+  static bool IsBinary(const string& value);
 };
 
 /**
@@ -64,6 +70,8 @@ class UserDbHelper {
   }
 
   bool UpdateUserInfo();
+  /// Packs the value in the format preferred by the underlying db.
+  string PackValue(const UserDbValue& value);
   static bool IsUniformFormat(const string& name);
   bool UniformBackup(const string& snapshot_file);
   bool UniformRestore(const string& snapshot_file);
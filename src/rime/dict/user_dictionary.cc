@@ -10,6 +10,7 @@
 #include <boost/algorithm/string.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/scope_exit.hpp>
+#include <rime/arena.h>
 #include <rime/common.h>
 #include <rime/language.h>
 #include <rime/schema.h>
@@ -203,34 +204,45 @@ void UserDictionary::DfsLookup(const SyllableGraph& syll_graph,
                                size_t current_pos,
                                const string& current_prefix,
                                DfsState* state) {
-  auto index = syll_graph.indices.find(current_pos);
-  if (index == syll_graph.indices.end()) {
+  const auto& graph(syll_graph.flat());
+  if (current_pos > state->collector->reach)
+    state->collector->reach = current_pos;
+  auto first = graph.index_begin(current_pos);
+  auto last = graph.index_end(current_pos);
+  if (first == last) {
     return;
   }
   DLOG(INFO) << "dfs lookup starts from " << current_pos;
   string prefix;
-  for (const auto& spelling : index->second) {
+  // edges in the index are grouped by syllable id
+  for (auto group = first; group != last; ) {
+    SyllableId syll_id = graph.edges[*group].syllable_id;
+    auto group_end = group;
+    while (group_end != last && graph.edges[*group_end].syllable_id == syll_id)
+      ++group_end;
     DLOG(INFO) << "prefix: '" << current_prefix << "'"
-               << ", syll_id: " << spelling.first
-               << ", num_spellings: " << spelling.second.size();
-    state->code.push_back(spelling.first);
+               << ", syll_id: " << syll_id
+               << ", num_spellings: " << (group_end - group);
+    auto spellings = group;
+    group = group_end;
+    state->code.push_back(syll_id);
     BOOST_SCOPE_EXIT( (&state) ) {
       state->code.pop_back();
     }
     BOOST_SCOPE_EXIT_END
     if (!TranslateCodeToString(state->code, &prefix))
       continue;
-    for (size_t i = 0; i < spelling.second.size(); ++i) {
-      auto props = spelling.second[i];
-      if (i > 0 && props->type >= kAbbreviation)
+    for (auto it = spellings; it != group_end; ++it) {
+      const auto& props(graph.edges[*it].properties);
+      if (it != spellings && props.type >= kAbbreviation)
         continue;
       state->credibility.push_back(
-          state->credibility.back() + props->credibility);
+          state->credibility.back() + props.credibility);
       BOOST_SCOPE_EXIT( (&state) ) {
         state->credibility.pop_back();
       }
       BOOST_SCOPE_EXIT_END
-      size_t end_pos = props->end_pos;
+      size_t end_pos = props.end_pos;
       DLOG(INFO) << "edge: [" << current_pos << ", " << end_pos << ")";
       if (prefix != state->key) {  // 'a b c |d ' > 'a b c \tabracadabra'
         DLOG(INFO) << "forward scanning for '" << prefix << "'.";
@@ -382,7 +394,7 @@ bool UserDictionary::UpdateEntry(const DictEntry& entry, int commits,
     v.dee = algo::formula_d(0.0, (double)tick_, v.dee, (double)v.tick);
   }
   v.tick = tick_;
-  return db_->Update(key, v.Pack());
+  return db_->Update(key, UserDbHelper(db_).PackValue(v));
 }
 
 bool UserDictionary::UpdateTickCount(TickCount increment) {
@@ -475,7 +487,7 @@ an<DictEntry> UserDictionary::CreateDictEntry(const string& key,
   if (v.tick < present_tick)
     v.dee = algo::formula_d(0, (double)present_tick, v.dee, (double)v.tick);
   // create!
-  e = New<DictEntry>();
+  e = ArenaNew<DictEntry>();
   e->text = key.substr(separator_pos + 1);
   e->commit_count = v.commits;
   // TODO: argument s not defined...
@@ -497,7 +509,7 @@ an<DictEntry> UserDictionary::CreateDictEntry(const string& key,
 
 // UserDictionaryComponent members
 
-UserDictionaryComponent::UserDictionaryComponent() {
+UserDictionaryComponent::UserDictionaryComponent() : db_pool_("user_db") {
 }
 
 UserDictionary* UserDictionaryComponent::Create(const Ticket& ticket) {
@@ -526,16 +538,18 @@ UserDictionary* UserDictionaryComponent::Create(const Ticket& ticket) {
     // user specified db class
   }
   // obtain userdb object
-  auto db = db_pool_[dict_name].lock();
-  if (!db) {
-    auto component = Db::Require(db_class);
-    if (!component) {
+  auto db = db_pool_.Get(dict_name, [&] {
+    an<Db> db;
+    if (auto component = Db::Require(db_class)) {
+      db.reset(component->Create(dict_name));
+    }
+    else {
       LOG(ERROR) << "undefined db class '" << db_class << "'.";
-      return NULL;
     }
-    db.reset(component->Create(dict_name));
-    db_pool_[dict_name] = db;
-  }
+    return db;
+  }, 0);
+  if (!db)
+    return NULL;
   return new UserDictionary(dict_name, db);
 }
 
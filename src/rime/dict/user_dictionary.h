@@ -10,12 +10,15 @@
 #include <time.h>
 #include <rime/common.h>
 #include <rime/component.h>
+#include <rime/resource_pool.h>
 #include <rime/dict/user_db.h>
 #include <rime/dict/vocabulary.h>
 
 namespace rime {
 
 struct UserDictEntryCollector : map<size_t, DictEntryList> {
+  // the farthest vertex of the syllable graph examined by the lookup
+  size_t reach = 0;
 };
 
 class UserDictEntryIterator : public DictEntryFilterBinder {
@@ -81,6 +84,8 @@ class UserDictionary : public Class<UserDictionary, const Ticket&> {
 
   const string& name() const { return name_; }
   TickCount tick() const { return tick_; }
+  // changes to the db, including those made by other sessions sharing it
+  uint64_t revision() const { return db_ ? db_->revision() : 0; }
 
   static an<DictEntry> CreateDictEntry(const string& key,
                                        const string& value,
@@ -110,7 +115,9 @@ class UserDictionaryComponent : public UserDictionary::Component {
   UserDictionaryComponent();
   UserDictionary* Create(const Ticket& ticket);
  private:
-  map<string, weak<Db>> db_pool_;
+  // user dbs are shared while in use, and closed after that so that they
+  // can be synced or backed up
+  ResourcePool<Db> db_pool_;
 };
 
 }  // namespace rime
@@ -5,6 +5,7 @@
 // 2011-04-24 GONG Chen <chen.sst@gmail.com>
 //
 #include <cctype>
+#include <rime/arena.h>
 #include <rime/common.h>
 #include <rime/composition.h>
 #include <rime/context.h>
@@ -18,6 +19,7 @@
 #include <rime/segmentation.h>
 #include <rime/segmentor.h>
 #include <rime/switcher.h>
+#include <rime/thread_pool.h>
 #include <rime/ticket.h>
 #include <rime/translation.h>
 #include <rime/translator.h>
@@ -38,6 +40,10 @@ class ConcreteEngine : public Engine {
   void InitializeOptions();
   void CalculateSegmentation(Segmentation* segments);
   void TranslateSegments(Segmentation* segments);
+  void StashTranslatedSegments(Context* ctx);
+  void ReuseTranslatedSegments(Context* ctx);
+  vector<an<Translation>> QueryTranslators(const string& input,
+                                           const Segment& segment);
   void FormatText(string* text);
   void OnCommit(Context* ctx);
   void OnSelect(Context* ctx);
@@ -51,6 +57,18 @@ class ConcreteEngine : public Engine {
   vector<of<Filter>> filters_;
   vector<of<Formatter>> formatters_;
   vector<of<Processor>> post_processors_;
+  // query parallel safe translators concurrently
+  bool parallel_translators_ = false;
+  // reuse menus of earlier compositions for unchanged segments
+  bool incremental_compose_ = false;
+  struct TranslatedSegment {
+    Segment segment;
+    string input;
+    string text_before;
+  };
+  // most recent first
+  list<TranslatedSegment> translated_segments_;
+  int refresh_count_ = 0;
 };
 
 // implementations
@@ -59,12 +77,32 @@ Engine* Engine::Create() {
   return new ConcreteEngine;
 }
 
-Engine::Engine() : schema_(new Schema), context_(new Context) {
+Engine::Engine()
+    : schema_(new Schema), context_(new Context),
+      arena_(new CompositionArena) {
 }
 
 Engine::~Engine() {
+  CancelTasks();
   context_.reset();
   schema_.reset();
+  arena_.reset();
+}
+
+bool Engine::PostTask(Task task) {
+  if (!task_runner_)
+    return false;
+  if (!task_token_)
+    task_token_ = New<bool>(true);
+  weak<bool> token(task_token_);
+  task_runner_([this, token, task] {
+    // the engine, or components the task refers to, are gone
+    if (token.expired())
+      return;
+    ArenaScope arena_scope(arena_.get());
+    task();
+  });
+  return true;
 }
 
 ConcreteEngine::ConcreteEngine() {
@@ -97,6 +135,7 @@ ConcreteEngine::~ConcreteEngine() {
 
 bool ConcreteEngine::ProcessKey(const KeyEvent& key_event) {
   DLOG(INFO) << "process key: " << key_event;
+  ArenaScope arena_scope(arena_.get());
   ProcessResult ret = kNoop;
   for (auto& processor : processors_) {
     ret = processor->ProcessKeyEvent(key_event);
@@ -148,6 +187,12 @@ void ConcreteEngine::Compose(Context* ctx) {
   Composition& comp = ctx->composition();
   const string active_input = ctx->input().substr(0, ctx->caret_pos());
   DLOG(INFO) << "active input: " << active_input;
+  if (incremental_compose_)
+    StashTranslatedSegments(ctx);
+  // candidates of the previous composition are no longer allocated from
+  // the current block, which is freed once they are all gone
+  arena_->Reset();
+  ArenaScope arena_scope(arena_.get());
   comp.Reset(active_input);
   if (ctx->caret_pos() < ctx->input().length() &&
       ctx->caret_pos() == comp.GetConfirmedPosition()) {
@@ -155,6 +200,8 @@ void ConcreteEngine::Compose(Context* ctx) {
     comp.Reset(ctx->input());
   }
   CalculateSegmentation(&comp);
+  if (incremental_compose_)
+    ReuseTranslatedSegments(ctx);
   TranslateSegments(&comp);
   DLOG(INFO) << "composition: " << comp.GetDebugText();
 }
@@ -198,8 +245,7 @@ void ConcreteEngine::TranslateSegments(Segmentation* segments) {
     string input = segments->input().substr(segment.start, len);
     DLOG(INFO) << "translating segment: " << input;
     auto menu = New<Menu>();
-    for (auto& translator : translators_) {
-      auto translation = translator->Query(input, segment);
+    for (auto& translation : QueryTranslators(input, segment)) {
       if (!translation)
         continue;
       if (translation->exhausted()) {
@@ -219,6 +265,95 @@ void ConcreteEngine::TranslateSegments(Segmentation* segments) {
   }
 }
 
+// also bounds the arena blocks kept by stashed menus
+static const size_t kMaxTranslatedSegments = 32;
+
+// remembers translated segments of the composition about to be reset, which
+// may be dropped from it but come back unchanged, eg. as the caret moves
+void ConcreteEngine::StashTranslatedSegments(Context* ctx) {
+  if (ctx->input().empty() || ctx->refresh_count() != refresh_count_) {
+    translated_segments_.clear();
+    refresh_count_ = ctx->refresh_count();
+  }
+  const Composition& comp = ctx->composition();
+  for (const Segment& segment : comp) {
+    if (segment.status != Segment::kGuess || !segment.menu)
+      continue;
+    translated_segments_.remove_if([&](const TranslatedSegment& x) {
+        return x.segment.start == segment.start &&
+            x.segment.end == segment.end;
+      });
+    translated_segments_.push_front(TranslatedSegment{
+        segment,
+        comp.input().substr(segment.start, segment.end - segment.start),
+        comp.GetTextBefore(segment.start)});
+  }
+  while (translated_segments_.size() > kMaxTranslatedSegments)
+    translated_segments_.pop_back();
+}
+
+// gives new segments the menus of stashed segments with the same range,
+// tags, input and preceding text, so that only changed ones are translated
+void ConcreteEngine::ReuseTranslatedSegments(Context* ctx) {
+  Composition& comp = ctx->composition();
+  for (Segment& segment : comp) {
+    if (segment.status != Segment::kVoid || segment.start == segment.end)
+      continue;
+    for (const auto& x : translated_segments_) {
+      if (x.segment.start != segment.start ||
+          x.segment.end != segment.end)
+        continue;
+      if (x.segment.tags == segment.tags &&
+          comp.input().compare(segment.start, segment.end - segment.start,
+                               x.input) == 0 &&
+          comp.GetTextBefore(segment.start) == x.text_before) {
+        DLOG(INFO) << "reusing segment: " << x.input;
+        segment.status = Segment::kGuess;
+        segment.menu = x.segment.menu;
+        segment.selected_index = x.segment.selected_index;
+      }
+      break;
+    }
+  }
+}
+
+vector<an<Translation>>
+ConcreteEngine::QueryTranslators(const string& input, const Segment& segment) {
+  size_t n = translators_.size();
+  vector<an<Translation>> translations(n);
+  size_t num_parallel = 0;
+  if (parallel_translators_) {
+    for (auto& translator : translators_) {
+      if (translator->parallel_safe())
+        ++num_parallel;
+    }
+  }
+  if (num_parallel < 2) {
+    for (size_t i = 0; i < n; ++i) {
+      translations[i] = translators_[i]->Query(input, segment);
+    }
+    return translations;
+  }
+  TaskGroup group(&ThreadPool::instance());
+  for (size_t i = 0; i < n; ++i) {
+    if (!translators_[i]->parallel_safe())
+      continue;
+    group.Run([this, i, &input, &segment, &translations] {
+      // the arena is not to be shared between threads
+      ArenaScope no_arena(nullptr);
+      translations[i] = translators_[i]->Query(input, segment);
+    });
+  }
+  // the others run here, meanwhile
+  for (size_t i = 0; i < n; ++i) {
+    if (!translators_[i]->parallel_safe())
+      translations[i] = translators_[i]->Query(input, segment);
+  }
+  group.Wait();
+  // in the order of translators, however they finished
+  return translations;
+}
+
 void ConcreteEngine::FormatText(string* text) {
   if (formatters_.empty())
     return;
@@ -236,6 +371,8 @@ void ConcreteEngine::CommitText(string text) {
 }
 
 void ConcreteEngine::OnCommit(Context* ctx) {
+  // the user dictionary may have learned from the committed text
+  translated_segments_.clear();
   context_->commit_history().Push(ctx->composition(), ctx->input());
   string text = ctx->GetCommitText();
   FormatText(&text);
@@ -273,6 +410,7 @@ void ConcreteEngine::OnSelect(Context* ctx) {
 void ConcreteEngine::ApplySchema(Schema* schema) {
   if (!schema)
     return;
+  CancelTasks();
   schema_.reset(schema);
   context_->Clear();
   context_->ClearTransientOptions();
@@ -282,6 +420,7 @@ void ConcreteEngine::ApplySchema(Schema* schema) {
 }
 
 void ConcreteEngine::InitializeComponents() {
+  translated_segments_.clear();
   processors_.clear();
   segmentors_.clear();
   translators_.clear();
@@ -299,6 +438,10 @@ void ConcreteEngine::InitializeComponents() {
   Config* config = schema_->config();
   if (!config)
     return;
+  parallel_translators_ = false;
+  config->GetBool("engine/parallel_translators", &parallel_translators_);
+  incremental_compose_ = false;
+  config->GetBool("engine/incremental_compose", &incremental_compose_);
   // create processors
   if (auto processor_list = config->GetList("engine/processors")) {
     size_t n = processor_list->size();
@@ -16,10 +16,13 @@ namespace rime {
 class KeyEvent;
 class Schema;
 class Context;
+class CompositionArena;
 
 class Engine : public Messenger {
  public:
   using CommitSink = signal<void (const string& commit_text)>;
+  using Task = function<void ()>;
+  using TaskRunner = function<void (Task task)>;
 
   virtual ~Engine();
   virtual bool ProcessKey(const KeyEvent& key_event) { return false; }
@@ -30,6 +33,23 @@ class Engine : public Messenger {
   Schema* schema() const { return schema_.get(); }
   Context* context() const { return context_.get(); }
   CommitSink& sink() { return sink_; }
+  // candidates of the current composition are allocated here
+  CompositionArena* arena() const { return arena_.get(); }
+
+  // runs a task later in the background, with exclusive access to the
+  // engine. the task is cancelled if the schema is changed or the engine
+  // is destroyed by then.
+  // returns false if the engine cannot run background tasks.
+  RIME_API bool PostTask(Task task);
+  void set_task_runner(TaskRunner runner) { task_runner_ = runner; }
+  // true if a running task should stop early and yield to api calls
+  // waiting for the engine
+  bool task_interrupted() const {
+    return interrupt_check_ && interrupt_check_();
+  }
+  void set_interrupt_check(function<bool ()> check) {
+    interrupt_check_ = check;
+  }
 
   Engine* active_engine() {
     return active_engine_ ? active_engine_ : this;
@@ -46,6 +66,13 @@ class Engine : public Messenger {
   the<Schema> schema_;
   the<Context> context_;
   CommitSink sink_;
+  the<CompositionArena> arena_;
+  void CancelTasks() { task_token_.reset(); }
+
+  TaskRunner task_runner_;
+  function<bool ()> interrupt_check_;
+  // posted tasks run only while the token they were posted with is alive
+  an<bool> task_token_;
   Engine* active_engine_ = nullptr;
 };
 
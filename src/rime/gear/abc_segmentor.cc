@@ -14,6 +14,8 @@ static const char kRimeAlphabet[] = "zyxwvutsrqponmlkjihgfedcba";
 
 namespace rime {
 
+static const TagId kAbcTag = TagRegistry::Intern("abc");
+
 AbcSegmentor::AbcSegmentor(const Ticket& ticket)
     : Segmentor(ticket), alphabet_(kRimeAlphabet) {
   if (!ticket.schema)
@@ -59,10 +61,8 @@ bool AbcSegmentor::Proceed(Segmentation* segmentation) {
   DLOG(INFO) << "[" << j << ", " << k << ")";
   if (j < k) {
     Segment segment(j, k);
-    segment.tags.insert("abc");
-    for (const string& tag : extra_tags_) {
-      segment.tags.insert(tag);
-    }
+    segment.tags.insert(kAbcTag);
+    segment.tags.insert(extra_tags_);
     segmentation->AddSegment(segment);
   }
   // continue this round
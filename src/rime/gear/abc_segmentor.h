@@ -7,6 +7,7 @@
 #ifndef RIME_ABC_SEGMENTOR_H_
 #define RIME_ABC_SEGMENTOR_H_
 
+#include <rime/segment_tags.h>
 #include <rime/segmentor.h>
 
 namespace rime {
@@ -22,7 +23,7 @@ class AbcSegmentor : public Segmentor {
   string delimiter_;
   string initials_;
   string finals_;
-  set<string> extra_tags_;
+  SegmentTags extra_tags_;
 };
 
 }  // namespace rime
@@ -12,11 +12,14 @@
 
 namespace rime {
 
+static const TagId kAbcTag = TagRegistry::Intern("abc");
+static const TagId kPartialTag = TagRegistry::Intern("partial");
+static const TagId kPhonyTag = TagRegistry::Intern("phony");
+
 AffixSegmentor::AffixSegmentor(const Ticket& ticket)
     : Segmentor(ticket), tag_("abc") {
-  if (!ticket.schema)
-    return;
-  if (Config* config = ticket.schema->config()) {
+  Config* config = ticket.schema ? ticket.schema->config() : nullptr;
+  if (config) {
     config->GetString(name_space_ + "/tag", &tag_);
     config->GetString(name_space_ + "/prefix", &prefix_);
     config->GetString(name_space_ + "/suffix", &suffix_);
@@ -30,21 +33,24 @@ AffixSegmentor::AffixSegmentor(const Ticket& ticket)
       }
     }
   }
+  tag_id_ = TagRegistry::Intern(tag_);
+  prefix_tag_id_ = TagRegistry::Intern(tag_ + "_prefix");
+  suffix_tag_id_ = TagRegistry::Intern(tag_ + "_suffix");
 }
 
 bool AffixSegmentor::Proceed(Segmentation* segmentation) {
   if (segmentation->empty())
     return true;
-  if (!segmentation->back().HasTag(tag_)) {
+  if (!segmentation->back().HasTag(tag_id_)) {
     if (segmentation->size() >= 2) {
       Segment& previous_segment(*(segmentation->rbegin() + 1));
-      if (previous_segment.HasTag("partial") &&
-          previous_segment.HasTag(tag_)) {
+      if (previous_segment.HasTag(kPartialTag) &&
+          previous_segment.HasTag(tag_id_)) {
         // the remaining part of a partial selection should inherit the tag
-        segmentation->back().tags.insert(tag_);
+        segmentation->back().tags.insert(tag_id_);
         // without adding new tag "abc"
-        if (!previous_segment.HasTag("abc")) {
-          segmentation->back().tags.erase("abc");
+        if (!previous_segment.HasTag(kAbcTag)) {
+          segmentation->back().tags.erase(kAbcTag);
         }
       }
     }
@@ -61,9 +67,9 @@ bool AffixSegmentor::Proceed(Segmentation* segmentation) {
   // just prefix
   if (active_input.length() == prefix_.length()) {
     Segment& prefix_segment(segmentation->back());
-    prefix_segment.tags.erase(tag_);
+    prefix_segment.tags.erase(tag_id_);
     prefix_segment.prompt = tips_;
-    prefix_segment.tags.insert(tag_ + "_prefix");
+    prefix_segment.tags.insert(prefix_tag_id_);
     DLOG(INFO) << "prefix: " << *segmentation;
     // continue this round
     return true;
@@ -73,17 +79,15 @@ bool AffixSegmentor::Proceed(Segmentation* segmentation) {
   Segment prefix_segment(j, j + prefix_.length());
   prefix_segment.status = Segment::kGuess;
   prefix_segment.prompt = tips_;
-  prefix_segment.tags.insert(tag_ + "_prefix");
-  prefix_segment.tags.insert("phony");  // do not commit raw input
+  prefix_segment.tags.insert(prefix_tag_id_);
+  prefix_segment.tags.insert(kPhonyTag);  // do not commit raw input
   segmentation->pop_back();
   segmentation->Forward();
   segmentation->AddSegment(prefix_segment);
   j += prefix_.length();
   Segment code_segment(j, k);
-  code_segment.tags.insert(tag_);
-  for (const string& tag : extra_tags_) {
-    code_segment.tags.insert(tag);
-  }
+  code_segment.tags.insert(tag_id_);
+  code_segment.tags.insert(extra_tags_);
   segmentation->Forward();
   segmentation->AddSegment(code_segment);
   DLOG(INFO) << "prefix+code: " << *segmentation;
@@ -99,8 +103,8 @@ bool AffixSegmentor::Proceed(Segmentation* segmentation) {
     Segment suffix_segment(k, k + suffix_.length());
     suffix_segment.status = Segment::kGuess;
     suffix_segment.prompt = closing_tips_.empty() ? tips_ : closing_tips_;
-    suffix_segment.tags.insert(tag_ + "_suffix");
-    suffix_segment.tags.insert("phony");  // do not commit raw input
+    suffix_segment.tags.insert(suffix_tag_id_);
+    suffix_segment.tags.insert(kPhonyTag);  // do not commit raw input
     segmentation->Forward();
     segmentation->AddSegment(suffix_segment);
     DLOG(INFO) << "prefix+suffix: " << *segmentation;
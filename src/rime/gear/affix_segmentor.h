@@ -7,6 +7,7 @@
 #ifndef RIME_AFFIX_SEGMENTOR_H_
 #define RIME_AFFIX_SEGMENTOR_H_
 
+#include <rime/segment_tags.h>
 #include <rime/segmentor.h>
 
 namespace rime {
@@ -23,7 +24,10 @@ class AffixSegmentor : public Segmentor {
   string suffix_;
   string tips_;
   string closing_tips_;
-  set<string> extra_tags_;
+  SegmentTags extra_tags_;
+  TagId tag_id_;
+  TagId prefix_tag_id_;
+  TagId suffix_tag_id_;
 };
 
 }  // namespace rime
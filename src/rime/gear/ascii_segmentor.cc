@@ -14,6 +14,8 @@
 
 namespace rime {
 
+static const TagId kRawTag = TagRegistry::Intern("raw");
+
 AsciiSegmentor::AsciiSegmentor(const Ticket& ticket) : Segmentor(ticket) {
 }
 
@@ -24,7 +26,7 @@ bool AsciiSegmentor::Proceed(Segmentation* segmentation) {
   size_t j = segmentation->GetCurrentStartPosition();
   if (j < input.length()) {
     Segment segment(j, input.length());
-    segment.tags.insert("raw");
+    segment.tags.insert(kRawTag);
     segmentation->AddSegment(segment);
   }
   return false;  // end of segmentation
@@ -18,6 +18,9 @@ static const char* kZeroWidthSpace = "\xef\xbb\xbf";  //"\xe2\x80\x8b";
 
 namespace rime {
 
+static const TagId kPhonyTag = TagRegistry::Intern("phony");
+static const TagId kChordPromptTag = TagRegistry::Intern("chord_prompt");
+
 ChordComposer::ChordComposer(const Ticket& ticket) : Processor(ticket) {
   if (!engine_)
     return;
@@ -141,9 +144,9 @@ void ChordComposer::UpdateChord() {
       LOG(ERROR) << "failed to update chord.";
       return;
     }
-    comp.back().tags.insert("phony");
+    comp.back().tags.insert(kPhonyTag);
   }
-  comp.back().tags.insert("chord_prompt");
+  comp.back().tags.insert(kChordPromptTag);
   comp.back().prompt = code;
 }
 
@@ -182,9 +185,9 @@ void ChordComposer::ClearChord() {
   if (comp.input().substr(comp.back().start) == kZeroWidthSpace) {
     ctx->PopInput(ctx->caret_pos() - comp.back().start);
   }
-  else if (comp.back().HasTag("chord_prompt")) {
+  else if (comp.back().HasTag(kChordPromptTag)) {
     comp.back().prompt.clear();
-    comp.back().tags.erase("chord_prompt");
+    comp.back().tags.erase(kChordPromptTag);
   }
 }
 
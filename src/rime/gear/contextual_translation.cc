@@ -1,6 +1,7 @@
 #include <algorithm>
 #include <iterator>
 #include <rime/gear/contextual_translation.h>
+#include <rime/gear/grammar.h>
 #include <rime/gear/translator_commons.h>
 
 namespace rime {
@@ -23,7 +24,7 @@ bool ContextualTranslation::Replenish() {
 	last_type = cand->type();
         AppendToCache(queue);
       }
-      queue.push_back(Evaluate(As<Phrase>(cand)));
+      queue.push_back(As<Phrase>(cand));
     } else {
       AppendToCache(queue);
       cache_.push_back(cand);
@@ -36,16 +37,22 @@ bool ContextualTranslation::Replenish() {
   return !cache_.empty();
 }
 
-an<Phrase> ContextualTranslation::Evaluate(an<Phrase> phrase) {
-  auto sentence = New<Sentence>(phrase->language());
-  sentence->Offset(phrase->start());
-  bool is_rear = phrase->end() == input_.length();
-  sentence->Extend(phrase->entry(), phrase->end(), is_rear, preceding_text_,
-                   grammar_);
-  phrase->set_weight(sentence->weight());
-  DLOG(INFO) << "contextual suggestion: " << phrase->text()
-             << " weight: " << phrase->weight();
-  return phrase;
+// evaluates phrases of the same range in one batch
+void ContextualTranslation::Evaluate(vector<of<Phrase>>& queue) {
+  vector<const DictEntry*> entries;
+  entries.reserve(queue.size());
+  for (const auto& phrase : queue) {
+    entries.push_back(&phrase->entry());
+  }
+  bool is_rear = queue.front()->end() == input_.length();
+  vector<double> weights;
+  grammar_cache_->Evaluate(
+      preceding_text_, entries, is_rear, grammar_, &weights);
+  for (size_t i = 0; i < queue.size(); ++i) {
+    queue[i]->set_weight(weights[i]);
+    DLOG(INFO) << "contextual suggestion: " << queue[i]->text()
+               << " weight: " << queue[i]->weight();
+  }
 }
 
 static bool compare_by_weight_desc(const an<Phrase>& a, const an<Phrase>& b) {
@@ -54,6 +61,7 @@ static bool compare_by_weight_desc(const an<Phrase>& a, const an<Phrase>& b) {
 
 void ContextualTranslation::AppendToCache(vector<of<Phrase>>& queue) {
   if (queue.empty()) return;
+  Evaluate(queue);
   DLOG(INFO) << "appending to cache " << queue.size() << " candidates.";
   std::sort(queue.begin(), queue.end(), compare_by_weight_desc);
   std::copy(queue.begin(), queue.end(), std::back_inserter(cache_));
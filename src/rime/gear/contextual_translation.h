@@ -10,6 +10,7 @@ namespace rime {
 
 class Candidate;
 class Grammar;
+class GrammarCache;
 class Phrase;
 
 class ContextualTranslation : public PrefetchTranslation {
@@ -17,22 +18,25 @@ class ContextualTranslation : public PrefetchTranslation {
   ContextualTranslation(an<Translation> translation,
                         string input,
                         string preceding_text,
-                        Grammar* grammar)
+                        Grammar* grammar,
+                        GrammarCache* grammar_cache)
       : PrefetchTranslation(translation),
         input_(input),
         preceding_text_(preceding_text),
-        grammar_(grammar) {}
+        grammar_(grammar),
+        grammar_cache_(grammar_cache) {}
 
  protected:
   bool Replenish() override;
 
  private:
-  an<Phrase> Evaluate(an<Phrase> phrase);
+  void Evaluate(vector<of<Phrase>>& queue);
   void AppendToCache(vector<of<Phrase>>& queue);
 
   string input_;
   string preceding_text_;
   Grammar* grammar_;
+  GrammarCache* grammar_cache_;
 };
 
 }  // namespace rime
@@ -35,10 +35,10 @@ an<Translation> EchoTranslator::Query(const string& input,
                                       const Segment& segment) {
   DLOG(INFO) << "input = '" << input
              << "', [" << segment.start << ", " << segment.end << ")";
-  auto candidate = New<SimpleCandidate>("raw",
-                                        segment.start,
-                                        segment.end,
-                                        input);
+  auto candidate = ArenaNew<SimpleCandidate>("raw",
+                                             segment.start,
+                                             segment.end,
+                                             input);
   if (candidate) {
     candidate->set_quality(-100);  // lowest priority
   }
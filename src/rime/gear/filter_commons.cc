@@ -19,6 +19,7 @@ TagMatching::TagMatching(const Ticket& ticket) {
     for (auto it = tags->begin(); it != tags->end(); ++it) {
       if (Is<ConfigValue>(*it)) {
         tags_.push_back(As<ConfigValue>(*it)->str());
+        tag_ids_.push_back(TagRegistry::Intern(tags_.back()));
       }
     }
   }
@@ -27,9 +28,9 @@ TagMatching::TagMatching(const Ticket& ticket) {
 bool TagMatching::TagsMatch(Segment* segment) {
   if (!segment)
     return false;
-  if (tags_.empty())  // match any
+  if (tag_ids_.empty())  // match any
     return true;
-  for (const string& tag : tags_) {
+  for (TagId tag : tag_ids_) {
     if (segment->HasTag(tag))
       return true;
   }
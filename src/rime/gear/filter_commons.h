@@ -7,6 +7,7 @@
 #ifndef RIME_FILTER_COMMONS_H_
 #define RIME_FILTER_COMMONS_H_
 
+#include <rime/segment_tags.h>
 
 namespace rime {
 
@@ -20,6 +21,7 @@ class TagMatching {
 
  protected:
   vector<string> tags_;
+  vector<TagId> tag_ids_;
 };
 
 }  // namespace rime
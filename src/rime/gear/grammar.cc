@@ -0,0 +1,66 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+#include <rime/gear/grammar.h>
+
+namespace rime {
+
+// bounds the memory used over a long session
+static const size_t kMaxCachedScores = 65536;
+
+uint32_t GrammarCache::Intern(hash_map<string, uint32_t>* ids,
+                              const string& text) {
+  return ids->emplace(text, static_cast<uint32_t>(ids->size()))
+      .first->second;
+}
+
+void GrammarCache::Evaluate(const string& context,
+                            const vector<const DictEntry*>& entries,
+                            bool is_rear,
+                            Grammar* grammar,
+                            vector<double>* weights) {
+  weights->resize(entries.size());
+  if (!grammar) {
+    for (size_t i = 0; i < entries.size(); ++i) {
+      (*weights)[i] = Grammar::Evaluate(context, *entries[i], is_rear, nullptr);
+    }
+    return;
+  }
+  pending_.clear();
+  words_.clear();
+  auto context_found = context_ids_.find(context);
+  for (size_t i = 0; i < entries.size(); ++i) {
+    const DictEntry& entry(*entries[i]);
+    if (context_found != context_ids_.end()) {
+      auto word_found = word_ids_.find(entry.text);
+      if (word_found != word_ids_.end()) {
+        auto found = scores_.find(
+            Key{context_found->second, word_found->second, is_rear});
+        if (found != scores_.end()) {
+          (*weights)[i] = entry.weight + found->second;
+          continue;
+        }
+      }
+    }
+    pending_.push_back(i);
+    words_.push_back(&entry.text);
+  }
+  if (pending_.empty())
+    return;
+  scores_buffer_.resize(pending_.size());
+  grammar->BatchQuery(context, words_, is_rear, scores_buffer_.data());
+  // contexts and words are only interned along with their scores
+  if (scores_.size() + pending_.size() > kMaxCachedScores)
+    Clear();
+  uint32_t context_id = Intern(&context_ids_, context);
+  for (size_t j = 0; j < pending_.size(); ++j) {
+    size_t i = pending_[j];
+    double score = scores_buffer_[j];
+    uint32_t word_id = Intern(&word_ids_, entries[i]->text);
+    scores_[Key{context_id, word_id, is_rear}] = score;
+    (*weights)[i] = entries[i]->weight + score;
+  }
+}
+
+}  // namespace rime
@@ -15,6 +15,17 @@ class Grammar : public Class<Grammar, Config*> {
   virtual double Query(const string& context,
                        const string& word,
                        bool is_rear) = 0;
+  // scores words following the same context in one call.
+  // the default implementation queries them one by one; grammar plugins can
+  // override it to share the context lookup among words.
+  virtual void BatchQuery(const string& context,
+                          const vector<const string*>& words,
+                          bool is_rear,
+                          double* scores) {
+    for (size_t i = 0; i < words.size(); ++i) {
+      scores[i] = Query(context, *words[i], is_rear);
+    }
+  }
 
   inline static double Evaluate(const string& context,
                                 const DictEntry& entry,
@@ -26,6 +37,55 @@ class Grammar : public Class<Grammar, Config*> {
   }
 };
 
+// memoizes grammar scores by context and word, so that contexts recurring
+// as the input grows are not queried again.  contexts and words are given
+// ids by their text, so a score is only shared by the same pair of strings.
+class GrammarCache {
+ public:
+  // evaluates entries following the same context, like Grammar::Evaluate();
+  // scores missing from the cache are queried from the grammar in a batch.
+  RIME_API void Evaluate(const string& context,
+                         const vector<const DictEntry*>& entries,
+                         bool is_rear,
+                         Grammar* grammar,
+                         vector<double>* weights);
+  void Clear() {
+    scores_.clear();
+    context_ids_.clear();
+    word_ids_.clear();
+  }
+  size_t size() const { return scores_.size(); }
+
+ private:
+  struct Key {
+    uint32_t context_id;
+    uint32_t word_id;
+    bool is_rear;
+    bool operator== (const Key& other) const {
+      return context_id == other.context_id &&
+          word_id == other.word_id &&
+          is_rear == other.is_rear;
+    }
+  };
+  struct KeyHash {
+    size_t operator() (const Key& key) const {
+      return std::hash<uint64_t>()(
+          (uint64_t(key.context_id) << 32 | key.word_id) * 2 + key.is_rear);
+    }
+  };
+  static uint32_t Intern(hash_map<string, uint32_t>* ids,
+                         const string& text);
+
+  std::unordered_map<Key, double, KeyHash> scores_;
+  hash_map<string, uint32_t> context_ids_;
+  hash_map<string, uint32_t> word_ids_;
+  // scratch space for batch queries
+  // indices of the entries whose words are to query
+  vector<size_t> pending_;
+  vector<const string*> words_;
+  vector<double> scores_buffer_;
+};
+
 }  // namespace rime
 
 #endif  // RIME_GRAMMAR_H_
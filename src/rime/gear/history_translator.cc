@@ -18,6 +18,7 @@ namespace rime {
 HistoryTranslator::HistoryTranslator(const Ticket& ticket)
     : Translator(ticket),
       tag_("abc"),
+      tag_id_(TagRegistry::Intern(tag_)),
       size_(1),
       initial_quality_(1000) {
   if (ticket.name_space == "translator") {
@@ -27,6 +28,7 @@ HistoryTranslator::HistoryTranslator(const Ticket& ticket)
     return;
   Config* config = ticket.schema->config();
   config->GetString(name_space_ + "/tag", &tag_);
+  tag_id_ = TagRegistry::Intern(tag_);
   config->GetString(name_space_ + "/input", &input_);
   config->GetInt(name_space_ + "/size", &size_);
   config->GetDouble(name_space_ + "/initial_quality",
@@ -35,7 +37,7 @@ HistoryTranslator::HistoryTranslator(const Ticket& ticket)
 
 an<Translation> HistoryTranslator::Query(const string& input,
                                          const Segment& segment) {
-  if (!segment.HasTag(tag_))
+  if (!segment.HasTag(tag_id_))
     return nullptr;
   if (input_.empty() || input_ != input)
     return nullptr;
@@ -48,10 +50,10 @@ an<Translation> HistoryTranslator::Query(const string& input,
   int count = 0;
   for (; it != history.rend(); ++it) {
     if (it->type == "thru") continue;
-    auto candidate = New<SimpleCandidate>(it->type,
-                                          segment.start,
-                                          segment.end,
-                                          it->text);
+    auto candidate = ArenaNew<SimpleCandidate>(it->type,
+                                               segment.start,
+                                               segment.end,
+                                               it->text);
     candidate->set_quality(initial_quality_);
     translation->Append(candidate);
     count++;
@@ -7,6 +7,7 @@
 #ifndef RIME_HISTORY_TRANSLATOR_H_
 #define RIME_HISTORY_TRANSLATOR_H_
 
+#include <rime/segment_tags.h>
 #include <rime/translator.h>
 
 namespace rime {
@@ -20,6 +21,7 @@ class HistoryTranslator : public Translator {
 
  protected:
   string tag_;
+  TagId tag_id_;
   string input_;
   int size_;
   double initial_quality_;
@@ -19,6 +19,8 @@ using namespace std::placeholders;
 
 namespace rime {
 
+static const TagId kPagingTag = TagRegistry::Intern("paging");
+
 enum KeyBindingCondition {
   kNever,
   kWhenPaging,     // user has changed page
@@ -183,7 +185,7 @@ KeyBindingConditions::KeyBindingConditions(Context* ctx) {
   }
 
   Composition& comp = ctx->composition();
-  if (!comp.empty() && comp.back().HasTag("paging")) {
+  if (!comp.empty() && comp.back().HasTag(kPagingTag)) {
     insert(kWhenPaging);
   }
 }
@@ -4,6 +4,7 @@
 //
 // 2013-01-02 GONG Chen <chen.sst@gmail.com>
 //
+#include <rime/arena.h>
 #include <rime/candidate.h>
 #include <rime/context.h>
 #include <rime/composition.h>
@@ -104,6 +105,9 @@ void Memory::OnCommit(Context* ctx) {
   if (!user_dict_|| user_dict_->readonly())
     return;
   StartSession();
+  // entries created while updating the user dictionary may be kept long
+  // after the composition is gone
+  ArenaScope no_arena(nullptr);
   CommitEntry commit_entry(this);
   for (auto& seg : ctx->composition()) {
     auto phrase = As<Phrase>(Candidate::GetGenuineCandidate(
@@ -26,6 +26,7 @@ inline static Grammar* create_grammar(Config* config) {
 Poet::Poet(const Language* language, Config* config, Compare compare)
     : language_(language),
       grammar_(create_grammar(config)),
+      grammar_cache_(new GrammarCache),
       compare_(compare) {}
 
 Poet::~Poet() {}
@@ -41,9 +42,6 @@ bool Poet::LeftAssociateCompare(const Sentence& one, const Sentence& other) {
                                            other.syllable_lengths().end()))));
 }
 
-// keep the best sentence candidate per last phrase
-using SentenceCandidates = hash_map<string, of<Sentence>>;
-
 template <int N>
 static vector<of<Sentence>> find_top_candidates(
     const SentenceCandidates& candidates, Poet::Compare compare) {
@@ -81,7 +79,7 @@ struct BeamSearch {
   static constexpr int kMaxSentenceCandidates = 7;
 
   static void Initiate(State& initial_state, const Language* language) {
-    initial_state.emplace("", New<Sentence>(language));
+    initial_state.emplace("", ArenaNew<Sentence>(language));
   }
 
   static void ForEachCandidate(const State& state,
@@ -110,7 +108,7 @@ struct DynamicProgramming {
   using State = an<Sentence>;
 
   static void Initiate(State& initial_state, const Language* language) {
-    initial_state = New<Sentence>(language);
+    initial_state = ArenaNew<Sentence>(language);
   }
 
   static void ForEachCandidate(const State& state,
@@ -131,13 +129,41 @@ struct DynamicProgramming {
 };
 
 template <class Strategy>
-an<Sentence> Poet::MakeSentenceWithStrategy(const WordGraph& graph,
-                                            size_t total_length,
-                                            const string& preceding_text) {
-  map<int, typename Strategy::State> sentences;
-  Strategy::Initiate(sentences[0], language_);
+an<Sentence> Poet::MakeSentenceWithStrategy(
+    const WordGraph& graph,
+    size_t total_length,
+    const string& preceding_text,
+    size_t stable_length,
+    const function<bool ()>& interrupted,
+    map<int, typename Strategy::State>* cached_sentences) {
+  auto& sentences(*cached_sentences);
+  // the states are kept for the next call, so they are allocated off the
+  // composition arena; only the result is allocated from it.
+  CompositionArena* arena = CompositionArena::current();
+  ArenaScope no_arena(nullptr);
+  // sentences up to a position depend only on edges ending there or before.
+  // those reaching the end of input are made differently.
+  stable_length = (std::min)(stable_length,
+                             (std::min)(total_length, last_total_length_));
+  if (preceding_text != last_preceding_text_) {
+    stable_length = 0;
+    grammar_cache_->Clear();  // a new composition after commit
+  }
+  sentences.erase(sentences.lower_bound(static_cast<int>(stable_length)),
+                  sentences.end());
+  if (sentences.empty())
+    Strategy::Initiate(sentences[0], language_);
+  last_total_length_ = total_length;
+  last_preceding_text_ = preceding_text;
+  vector<const DictEntry*> entries;
+  vector<double> weights;
   for (const auto& w : graph) {
     size_t start_pos = w.first;
+    if (interrupted && interrupted()) {
+      // sentences ending before start_pos are complete; keep them
+      last_total_length_ = start_pos;
+      return nullptr;
+    }
     if (sentences.find(start_pos) == sentences.end())
       continue;
     DLOG(INFO) << "start pos: " << start_pos;
@@ -147,17 +173,25 @@ an<Sentence> Poet::MakeSentenceWithStrategy(const WordGraph& graph,
         [&](const an<Sentence>& candidate) {
           for (const auto& x : w.second) {
             size_t end_pos = x.first;
+            if (end_pos < stable_length)
+              continue;  // kept from the previous call
             if (start_pos == 0 && end_pos == total_length)
               continue;  // exclude single words from the result
             DLOG(INFO) << "end pos: " << end_pos;
             bool is_rear = end_pos == total_length;
             auto& target(sentences[end_pos]);
             // extend candidates with dict entries on a valid edge.
-            const DictEntryList& entries(x.second);
-            for (const auto& entry : entries) {
-              auto new_sentence = New<Sentence>(*candidate);
-              new_sentence->Extend(
-                  *entry, end_pos, is_rear, preceding_text, grammar_.get());
+            entries.clear();
+            for (const auto& entry : x.second) {
+              entries.push_back(entry.get());
+            }
+            const string& context =
+                candidate->empty() ? preceding_text : candidate->text();
+            grammar_cache_->Evaluate(
+                context, entries, is_rear, grammar_.get(), &weights);
+            for (size_t i = 0; i < entries.size(); ++i) {
+              auto new_sentence = ArenaNew<Sentence>(*candidate);
+              new_sentence->Extend(*entries[i], end_pos, weights[i]);
               auto& best_sentence =
                   Strategy::BestSentenceToUpdate(target, new_sentence);
               if (!best_sentence || compare_(*best_sentence, *new_sentence)) {
@@ -173,18 +207,26 @@ an<Sentence> Poet::MakeSentenceWithStrategy(const WordGraph& graph,
   auto found = sentences.find(total_length);
   if (found == sentences.end())
     return nullptr;
-  else
-    return Strategy::BestSentence(found->second, compare_);
+  auto best = Strategy::BestSentence(found->second, compare_);
+  if (!best)
+    return nullptr;
+  // a copy, as the kept state may be extended by the next call
+  ArenaScope result_scope(arena);
+  return ArenaNew<Sentence>(*best);
 }
 
 an<Sentence> Poet::MakeSentence(const WordGraph& graph,
                                 size_t total_length,
-                                const string& preceding_text) {
+                                const string& preceding_text,
+                                size_t stable_length,
+                                const function<bool ()>& interrupted) {
   return grammar_ ?
       MakeSentenceWithStrategy<BeamSearch>(
-          graph, total_length, preceding_text) :
+          graph, total_length, preceding_text, stable_length, interrupted,
+          &beam_states_) :
       MakeSentenceWithStrategy<DynamicProgramming>(
-          graph, total_length, preceding_text);
+          graph, total_length, preceding_text, stable_length, interrupted,
+          &dp_states_);
 }
 
 }  // namespace rime
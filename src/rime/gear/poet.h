@@ -20,7 +20,11 @@ namespace rime {
 
 using WordGraph = map<int, UserDictEntryCollector>;
 
+// keep the best sentence candidate per last phrase
+using SentenceCandidates = hash_map<string, of<Sentence>>;
+
 class Grammar;
+class GrammarCache;
 class Language;
 
 class Poet {
@@ -37,9 +41,16 @@ class Poet {
        Compare compare = CompareWeight);
   ~Poet();
 
+  // edges ending before stable_length are known by the caller to be the
+  // same as in the graph of the previous call; sentences made there are
+  // extended instead of being made again.
+  // returns null once interrupted() is true; the next call on the same
+  // graph picks up where this one has stopped.
   an<Sentence> MakeSentence(const WordGraph& graph,
                             size_t total_length,
-                            const string& preceding_text);
+                            const string& preceding_text,
+                            size_t stable_length = 0,
+                            const function<bool ()>& interrupted = nullptr);
 
   template <class TranslatorT>
   an<Translation> ContextualWeighted(an<Translation> translation,
@@ -54,18 +65,31 @@ class Poet {
       return translation;
     }
     return New<ContextualTranslation>(
-        translation, input, preceding_text, grammar_.get());
+        translation, input, preceding_text, grammar_.get(),
+        grammar_cache_.get());
   }
 
  private:
   template <class Strategy>
-  an<Sentence> MakeSentenceWithStrategy(const WordGraph& graph,
-                                        size_t total_length,
-                                        const string& preceding_text);
+  an<Sentence> MakeSentenceWithStrategy(
+      const WordGraph& graph,
+      size_t total_length,
+      const string& preceding_text,
+      size_t stable_length,
+      const function<bool ()>& interrupted,
+      map<int, typename Strategy::State>* sentences);
 
   const Language* language_;
   the<Grammar> grammar_;
+  the<GrammarCache> grammar_cache_;
   Compare compare_;
+
+  // states of the previous call, extended by the next one when the input
+  // only changes at the end
+  size_t last_total_length_ = 0;
+  string last_preceding_text_;
+  map<int, SentenceCandidates> beam_states_;
+  map<int, an<Sentence>> dp_states_;
 };
 
 }  // namespace rime
@@ -20,6 +20,8 @@
 
 namespace rime {
 
+static const TagId kPunctTag = TagRegistry::Intern("punct");
+
 void PunctConfig::LoadConfig(Engine* engine, bool load_symbols) {
   bool full_shape = engine->context()->get_option("full_shape");
   string shape(full_shape ? "full_shape" : "half_shape");
@@ -51,7 +53,7 @@ Punctuator::Punctuator(const Ticket& ticket) : Processor(ticket) {
 
 static bool punctuation_is_translated(Context* ctx) {
   Composition& comp = ctx->composition();
-  if (comp.empty() || !comp.back().HasTag("punct")) {
+  if (comp.empty() || !comp.back().HasTag(kPunctTag)) {
     return false;
   }
   auto cand = comp.back().GetSelectedCandidate();
@@ -107,7 +109,7 @@ bool Punctuator::AlternatePunct(const string& key,
     return false;
   Segment& segment(comp.back());
   if (segment.status > Segment::kVoid &&
-      segment.HasTag("punct") &&
+      segment.HasTag(kPunctTag) &&
       key == ctx->input().substr(segment.start, segment.end - segment.start)) {
     if (!segment.menu ||
         segment.menu->Prepare(segment.selected_index + 2) == 0) {
@@ -146,7 +148,7 @@ bool Punctuator::PairPunct(const an<ConfigItem>& definition) {
   if (comp.empty())
     return false;
   Segment& segment(comp.back());
-  if (segment.status > Segment::kVoid && segment.HasTag("punct")) {
+  if (segment.status > Segment::kVoid && segment.HasTag(kPunctTag)) {
     if (!segment.menu || segment.menu->Prepare(2) < 2) {
       LOG(ERROR) << "missing candidate for paired punctuation.";
       return false;
@@ -182,7 +184,7 @@ bool PunctSegmentor::Proceed(Segmentation* segmentation) {
     Segment segment(k, k + 1);
     DLOG(INFO) << "add a punctuation segment ["
                << segment.start << ", " << segment.end << ")";
-    segment.tags.insert("punct");
+    segment.tags.insert(kPunctTag);
     segmentation->AddSegment(segment);
   }
   return false;  // exclusive
@@ -213,18 +215,18 @@ CreatePunctCandidate(const string& punct, const Segment& segment) {
     is_full_shape = is_ideographic_space || is_full_shape_ascii;
   }
   bool one_key = (segment.end - segment.start == 1);
-  return New<SimpleCandidate>("punct",
-                              segment.start,
-                              segment.end,
-                              punct,
-                              (is_half_shape ? half_shape :
-                               is_full_shape ? full_shape : ""),
-                              one_key ? punct : "");
+  return ArenaNew<SimpleCandidate>("punct",
+                                   segment.start,
+                                   segment.end,
+                                   punct,
+                                   (is_half_shape ? half_shape :
+                                    is_full_shape ? full_shape : ""),
+                                   one_key ? punct : "");
 }
 
 an<Translation> PunctTranslator::Query(const string& input,
                                                const Segment& segment) {
-  if (!segment.HasTag("punct"))
+  if (!segment.HasTag(kPunctTag))
     return nullptr;
   config_.LoadConfig(engine_);
   auto definition = config_.GetPunctDefinition(input);
@@ -34,6 +34,14 @@ static void load_patterns(RecognizerPatterns* patterns, an<ConfigMap> map) {
 
 void RecognizerPatterns::LoadConfig(Config* config) {
   load_patterns(this, config->GetMap("recognizer/patterns"));
+  compiled_ = PatternSet();
+  compiled_ids_.clear();
+  for (const auto& v : *this) {
+    compiled_ids_.push_back(compiled_.Add(v.second.str()));
+  }
+  if (!compiled_.empty() && !compiled_.Compile()) {
+    compiled_ids_.assign(size(), -1);
+  }
 }
 
 RecognizerMatch
@@ -41,29 +49,46 @@ RecognizerPatterns::GetMatch(const string& input,
                              const Segmentation& segmentation) const {
   size_t j = segmentation.GetCurrentEndPosition();
   size_t k = segmentation.GetConfirmedPosition();
-  string active_input = input.substr(k);
-  DLOG(INFO) << "matching active input '" << active_input << "' at pos " << k;
-  for (const auto& v : *this) {
-    boost::smatch m;
-    if (boost::regex_search(active_input, m, v.second)) {
-      size_t start = k + m.position();
-      size_t end = start + m.length();
-      if (end != input.length())
-        continue;
-      if (start == j) {
+  DLOG(INFO) << "matching active input '" << input.substr(k)
+             << "' at pos " << k;
+  bool use_compiled = compiled_ids_.size() == size() && compiled_.compiled();
+  vector<size_t> starts;
+  if (use_compiled)
+    compiled_.Match(input, k, &starts);
+  string active_input;
+  size_t i = 0;
+  for (auto it = begin(); it != end(); ++it, ++i) {
+    const auto& v = *it;
+    size_t start = string::npos;
+    if (use_compiled && compiled_ids_[i] >= 0) {
+      start = starts[compiled_ids_[i]];
+    }
+    else {
+      if (active_input.empty() && k < input.length())
+        active_input = input.substr(k);
+      boost::smatch m;
+      if (boost::regex_search(active_input, m, v.second) &&
+          k + m.position() + m.length() == input.length()) {
+        start = k + m.position();
+      }
+    }
+    if (start == string::npos)
+      continue;
+    size_t end = input.length();
+    if (start == j) {
+      DLOG(INFO) << "input [" << start << ", " << end << ") '"
+                 << input.substr(start) << "' matches pattern: " << v.first;
+      return {v.first, start, end};
+    }
+    for (const Segment& seg : segmentation) {
+      if (start < seg.start)
+        break;
+      if (start == seg.start) {
         DLOG(INFO) << "input [" << start << ", " << end << ") '"
-                   << m.str() << "' matches pattern: " << v.first;
+                   << input.substr(start) << "' matches pattern: "
+                   << v.first;
         return {v.first, start, end};
       }
-      for (const Segment& seg : segmentation) {
-        if (start < seg.start)
-          break;
-        if (start == seg.start) {
-          DLOG(INFO) << "input [" << start << ", " << end << ") '"
-                     << m.str() << "' matches pattern: " << v.first;
-          return {v.first, start, end};
-        }
-      }
     }
   }
   return RecognizerMatch();
@@ -10,6 +10,7 @@
 #include <boost/regex.hpp>
 #include <rime/common.h>
 #include <rime/processor.h>
+#include <rime/algo/pattern_set.h>
 
 namespace rime {
 
@@ -32,6 +33,12 @@ class RecognizerPatterns : public map<string, boost::regex> {
   void LoadConfig(Config* config);
   RecognizerMatch GetMatch(const string& input,
                            const Segmentation& segmentation) const;
+
+ private:
+  // patterns that a DFA can match are searched for all at once
+  PatternSet compiled_;
+  // index into compiled_ of each pattern in map order, or -1
+  vector<int> compiled_ids_;
 };
 
 class Recognizer : public Processor {
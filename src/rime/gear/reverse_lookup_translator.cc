@@ -61,7 +61,7 @@ an<Candidate> ReverseLookupTranslation::Peek() {
     //  boost::algorithm::replace_all(tips, " ", separator);
     //}
   }
-  an<Candidate> cand = New<SimpleCandidate>(
+  an<Candidate> cand = ArenaNew<SimpleCandidate>(
       "reverse_lookup",
       start_,
       end_,
@@ -88,7 +88,8 @@ int ReverseLookupTranslation::Compare(an<Translation> other,
 }
 
 ReverseLookupTranslator::ReverseLookupTranslator(const Ticket& ticket)
-    : Translator(ticket), tag_("reverse_lookup") {
+    : Translator(ticket), tag_("reverse_lookup"),
+      tag_id_(TagRegistry::Intern(tag_)) {
   if (ticket.name_space == "translator") {
     name_space_ = "reverse_lookup";
   }
@@ -96,6 +97,7 @@ ReverseLookupTranslator::ReverseLookupTranslator(const Ticket& ticket)
     return;
   Config* config = ticket.schema->config();
   config->GetString(name_space_ + "/tag", &tag_);
+  tag_id_ = TagRegistry::Intern(tag_);
 }
 
 void ReverseLookupTranslator::Initialize() {
@@ -141,7 +143,7 @@ void ReverseLookupTranslator::Initialize() {
 
 an<Translation> ReverseLookupTranslator::Query(const string& input,
                                                        const Segment& segment) {
-  if (!segment.HasTag(tag_))
+  if (!segment.HasTag(tag_id_))
     return nullptr;
   if (!initialized_)
     Initialize();  // load reverse dict at first use
@@ -173,7 +175,7 @@ an<Translation> ReverseLookupTranslator::Query(const string& input,
     if (options_ && options_->enable_completion()) {
       dict_->LookupWords(&iter, code, true, 100);
       quality = !iter.exhausted() &&
-                (iter.Peek()->remaining_code_length == 0);
+                (iter.PeekView().remaining_code_length() == 0);
     }
     else {
       // 2012-04-08 gongchen: fetch multi-syllable words from rev-lookup table
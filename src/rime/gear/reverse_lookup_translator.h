@@ -8,6 +8,7 @@
 #define RIME_REVERSE_LOOKUP_TRANSLATOR_H_
 
 #include <rime/common.h>
+#include <rime/segment_tags.h>
 #include <rime/translator.h>
 #include <rime/algo/algebra.h>
 
@@ -28,6 +29,7 @@ class ReverseLookupTranslator : public Translator {
   void Initialize();
 
   string tag_;
+  TagId tag_id_;
   bool initialized_ = false;
   the<Dictionary> dict_;
   the<ReverseLookupDictionary> rev_dict_;
@@ -9,7 +9,6 @@
 #include <algorithm>
 #include <stack>
 #include <boost/algorithm/string/join.hpp>
-#include <boost/range/adaptor/reversed.hpp>
 #include <rime/composition.h>
 #include <rime/candidate.h>
 #include <rime/config.h>
@@ -47,21 +46,19 @@ static bool syllabify_dfs(SyllabifyTask* task,
     return current_pos == task->target_pos;
   }
   SyllableId syllable_id = task->code.at(depth);
-  auto z = task->graph.edges.find(current_pos);
-  if (z == task->graph.edges.end())
-    return false;
+  const auto& graph(task->graph.flat());
+  auto first = graph.edges_begin(current_pos);
   // favor longer spellings
-  for (const auto& y : boost::adaptors::reverse(z->second)) {
-    size_t end_vertex_pos = y.first;
-    if (end_vertex_pos > task->target_pos)
+  for (auto edge = graph.edges_end(current_pos); edge != first; ) {
+    --edge;
+    size_t end_vertex_pos = edge->properties.end_pos;
+    if (end_vertex_pos > task->target_pos ||
+        edge->syllable_id != syllable_id)
       continue;
-    auto x = y.second.find(syllable_id);
-    if (x != y.second.end()) {
-      task->push(task, depth, current_pos, end_vertex_pos);
-      if (syllabify_dfs(task, depth + 1, end_vertex_pos))
-        return true;
-      task->pop(task, depth);
-    }
+    task->push(task, depth, current_pos, end_vertex_pos);
+    if (syllabify_dfs(task, depth + 1, end_vertex_pos))
+      return true;
+    task->pop(task, depth);
   }
   return false;
 }
@@ -84,7 +81,11 @@ class ScriptSyllabifier : public PhraseSyllabifier {
   }
 
   virtual Spans Syllabify(const Phrase* phrase);
-  size_t BuildSyllableGraph(Prism& prism);
+  // spellings matched by the previous syllabifier, if given, are reused
+  size_t BuildSyllableGraph(Prism& prism,
+                            ScriptSyllabifier* previous = nullptr);
+  const string& input() const { return input_; }
+  size_t start() const { return start_; }
   string GetPreeditString(const Phrase& cand) const;
   string GetOriginalSpelling(const Phrase& cand) const;
   bool IsCandidateCorrection(const Phrase& cand) const;
@@ -99,51 +100,119 @@ class ScriptSyllabifier : public PhraseSyllabifier {
   SyllableGraph syllable_graph_;
 };
 
+// Keeps the syllable graph and lookup results of the previous query. Each
+// keystroke usually changes the graph only near the end of the input, so the
+// new graph is built with the spellings matched in the unchanged part of the
+// input, and a lookup result is reused as long as the new graph has the same
+// edges up to the farthest vertex examined by that lookup.
+class ScriptLookupCache {
+ public:
+  // returns a syllabifier with the syllable graph built for the input, and
+  // drops cached results that no longer apply to it
+  an<ScriptSyllabifier> Syllabify(ScriptTranslator* translator,
+                                  Corrector* corrector,
+                                  Prism& prism,
+                                  const string& input,
+                                  size_t start);
+  // results are shared with later calls; copy the entry iterators to
+  // consume them
+  an<const DictEntryCollector> Lookup(Dictionary* dict,
+                                      const SyllableGraph& syllable_graph,
+                                      size_t start_pos);
+  an<const UserDictEntryCollector> Lookup(UserDictionary* user_dict,
+                                          const SyllableGraph& syllable_graph,
+                                          size_t start_pos,
+                                          size_t depth_limit);
+  // user phrases are outdated once the user dictionary is updated
+  void ResetUserPhrases() {
+    user_phrases_.clear();
+    sentence_.reset();
+  }
+  // a sentence made in the background for the current syllabifier
+  an<Sentence> GetSentence(const an<ScriptSyllabifier>& syllabifier) const {
+    return syllabifier == syllabifier_ ? sentence_ : nullptr;
+  }
+  void SetSentence(const an<ScriptSyllabifier>& syllabifier,
+                   an<Sentence> sentence) {
+    if (syllabifier == syllabifier_)
+      sentence_ = sentence;
+  }
+  bool IsCurrent(const an<ScriptSyllabifier>& syllabifier) const {
+    return syllabifier && syllabifier == syllabifier_;
+  }
+  // the part of the word graph for the syllabifier that is the same as in
+  // the last sentence made by the poet, which is then made for this one
+  size_t SentenceStableLength(const an<ScriptSyllabifier>& syllabifier,
+                              UserDictionary* user_dict);
+
+ private:
+  an<ScriptSyllabifier> syllabifier_;
+  an<Sentence> sentence_;
+  map<size_t, an<const DictEntryCollector>> phrases_;
+  map<pair<size_t, size_t>, an<const UserDictEntryCollector>> user_phrases_;
+  uint64_t user_dict_revision_ = 0;
+  // with which the poet has made the last sentence
+  an<ScriptSyllabifier> poet_syllabifier_;
+  UserDictionary* poet_user_dict_ = nullptr;
+  uint64_t poet_user_dict_revision_ = 0;
+};
+
 class ScriptTranslation : public Translation {
  public:
   ScriptTranslation(ScriptTranslator* translator,
-                    Corrector* corrector,
                     Poet* poet,
-                    const string& input,
-                    size_t start)
+                    an<ScriptSyllabifier> syllabifier,
+                    bool enable_correction)
       : translator_(translator),
         poet_(poet),
-        start_(start),
-        syllabifier_(New<ScriptSyllabifier>(
-            translator, corrector, input, start)),
-        enable_correction_(corrector) {
+        start_(syllabifier->start()),
+        syllabifier_(syllabifier),
+        enable_correction_(enable_correction) {
     set_exhausted(true);
   }
-  bool Evaluate(Dictionary* dict, UserDictionary* user_dict);
+  // with defer_sentence, a sentence is taken only if one has been made
+  // in the background; otherwise the sentence is marked pending.
+  bool Evaluate(Dictionary* dict,
+                UserDictionary* user_dict,
+                ScriptLookupCache* cache,
+                bool defer_sentence = false);
   virtual bool Next();
   virtual an<Candidate> Peek();
 
+  an<Sentence> MakeSentence(Dictionary* dict,
+                            UserDictionary* user_dict,
+                            ScriptLookupCache* cache,
+                            const function<bool ()>& interrupted = nullptr);
+  bool sentence_pending() const { return sentence_pending_; }
+
  protected:
   bool CheckEmpty();
   bool IsNormalSpelling() const;
-  an<Sentence> MakeSentence(Dictionary* dict,
-                                    UserDictionary* user_dict);
   void PrepareCandidate();
+  void CopyPhraseEntries();
 
   ScriptTranslator* translator_;
   Poet* poet_;
   size_t start_;
   an<ScriptSyllabifier> syllabifier_;
 
-  an<DictEntryCollector> phrase_;
-  an<UserDictEntryCollector> user_phrase_;
+  an<const DictEntryCollector> phrase_;
+  an<const UserDictEntryCollector> user_phrase_;
   an<Sentence> sentence_;
 
   an<Phrase> candidate_ = nullptr;
 
-  DictEntryCollector::reverse_iterator phrase_iter_;
-  UserDictEntryCollector::reverse_iterator user_phrase_iter_;
+  DictEntryCollector::const_reverse_iterator phrase_iter_;
+  UserDictEntryCollector::const_reverse_iterator user_phrase_iter_;
+  // a copy of the entries at phrase_iter_, consumed by this translation
+  DictEntryIterator phrase_entries_;
   size_t user_phrase_index_ = 0;
 
   size_t max_corrections_ = 4;
   size_t correction_count_ = 0;
 
   bool enable_correction_;
+  bool sentence_pending_ = false;
 };
 
 // ScriptTranslator implementation
@@ -151,7 +220,8 @@ class ScriptTranslation : public Translation {
 ScriptTranslator::ScriptTranslator(const Ticket& ticket)
     : Translator(ticket),
       Memory(ticket),
-      TranslatorOptions(ticket) {
+      TranslatorOptions(ticket),
+      lookup_cache_(new ScriptLookupCache) {
   if (!engine_)
     return;
   if (Config* config = engine_->schema()->config()) {
@@ -160,6 +230,7 @@ ScriptTranslator::ScriptTranslator(const Ticket& ticket)
                     &always_show_comments_);
     config->GetBool(name_space_ + "/enable_correction", &enable_correction_);
     config->GetInt(name_space_ + "/max_homophones", &max_homophones_);
+    config->GetBool(name_space_ + "/async_sentence", &async_sentence_);
     poet_.reset(new Poet(language(), config));
   }
   if (enable_correction_) {
@@ -169,11 +240,14 @@ ScriptTranslator::ScriptTranslator(const Ticket& ticket)
   }
 }
 
+ScriptTranslator::~ScriptTranslator() {
+}
+
 an<Translation> ScriptTranslator::Query(const string& input,
                                         const Segment& segment) {
   if (!dict_ || !dict_->loaded())
     return nullptr;
-  if (!segment.HasTag(tag_))
+  if (!segment.HasTag(tag_id_))
     return nullptr;
   DLOG(INFO) << "input = '" << input
              << "', [" << segment.start << ", " << segment.end << ")";
@@ -183,17 +257,35 @@ an<Translation> ScriptTranslator::Query(const string& input,
   bool enable_user_dict = user_dict_ && user_dict_->loaded() &&
       !IsUserDictDisabledFor(input);
 
+  auto syllabifier = lookup_cache_->Syllabify(this,
+                                              corrector_.get(),
+                                              *dict_->prism(),
+                                              input,
+                                              segment.start);
   // the translator should survive translations it creates
   auto result = New<ScriptTranslation>(this,
-                                       corrector_.get(),
                                        poet_.get(),
-                                       input,
-                                       segment.start);
-  if (!result ||
-      !result->Evaluate(dict_.get(),
-                        enable_user_dict ? user_dict_.get() : NULL)) {
+                                       syllabifier,
+                                       bool(corrector_));
+  if (!result)
     return nullptr;
+  bool evaluated = result->Evaluate(dict_.get(),
+                                    enable_user_dict ? user_dict_.get() : NULL,
+                                    lookup_cache_.get(),
+                                    async_sentence_);
+  if (result->sentence_pending() &&
+      !MakeSentenceLater(syllabifier, enable_user_dict)) {
+    // no background worker; make it now
+    result = New<ScriptTranslation>(this,
+                                    poet_.get(),
+                                    syllabifier,
+                                    bool(corrector_));
+    evaluated = result->Evaluate(dict_.get(),
+                                 enable_user_dict ? user_dict_.get() : NULL,
+                                 lookup_cache_.get());
   }
+  if (!evaluated)
+    return nullptr;
   auto deduped = New<DistinctTranslation>(result);
   if (contextual_suggestions_) {
     return poet_->ContextualWeighted(deduped, input, segment.start, this);
@@ -201,6 +293,43 @@ an<Translation> ScriptTranslator::Query(const string& input,
   return deduped;
 }
 
+bool ScriptTranslator::MakeSentenceLater(an<ScriptSyllabifier> syllabifier,
+                                         bool enable_user_dict) {
+  weak<ScriptSyllabifier> target(syllabifier);
+  return engine_->PostTask([this, target, enable_user_dict] {
+    auto syllabifier = target.lock();
+    // the input has changed since
+    if (!lookup_cache_->IsCurrent(syllabifier))
+      return;
+    ScriptTranslation translation(this,
+                                  poet_.get(),
+                                  syllabifier,
+                                  bool(corrector_));
+    bool interrupted = false;
+    auto sentence = translation.MakeSentence(
+        dict_.get(),
+        enable_user_dict ? user_dict_.get() : NULL,
+        lookup_cache_.get(),
+        [this, &interrupted] {
+          interrupted = engine_->task_interrupted();
+          return interrupted;
+        });
+    if (interrupted) {
+      // let the waiting api calls through, then carry on if the input
+      // is still the same
+      MakeSentenceLater(syllabifier, enable_user_dict);
+      return;
+    }
+    if (!sentence)
+      return;
+    lookup_cache_->SetSentence(syllabifier, sentence);
+    // translate again, taking the sentence
+    if (engine_->context()->RefreshNonConfirmedComposition()) {
+      engine_->message_sink()("candidates", "sentence");
+    }
+  });
+}
+
 string ScriptTranslator::FormatPreedit(const string& preedit) {
   string result = preedit;
   preedit_formatter_.Apply(&result);
@@ -242,9 +371,103 @@ bool ScriptTranslator::Memorize(const CommitEntry& commit_entry) {
     }
   }
   user_dict_->UpdateEntry(commit_entry, 1);
+  lookup_cache_->ResetUserPhrases();
   return true;
 }
 
+// ScriptLookupCache implementation
+
+an<ScriptSyllabifier> ScriptLookupCache::Syllabify(ScriptTranslator* translator,
+                                                   Corrector* corrector,
+                                                   Prism& prism,
+                                                   const string& input,
+                                                   size_t start) {
+  if (syllabifier_ &&
+      syllabifier_->input() == input && syllabifier_->start() == start) {
+    return syllabifier_;
+  }
+  auto syllabifier = New<ScriptSyllabifier>(
+      translator, corrector, input, start);
+  syllabifier->BuildSyllableGraph(prism, syllabifier_.get());
+  size_t stable_length = !syllabifier_ ? 0 :
+      syllabifier->syllable_graph().CommonPrefixLength(
+          syllabifier_->syllable_graph());
+  for (auto it = phrases_.begin(); it != phrases_.end(); ) {
+    if (it->second->reach >= stable_length)
+      it = phrases_.erase(it);
+    else
+      ++it;
+  }
+  for (auto it = user_phrases_.begin(); it != user_phrases_.end(); ) {
+    if (it->second->reach >= stable_length)
+      it = user_phrases_.erase(it);
+    else
+      ++it;
+  }
+  syllabifier_ = syllabifier;
+  sentence_.reset();
+  return syllabifier_;
+}
+
+an<const DictEntryCollector>
+ScriptLookupCache::Lookup(Dictionary* dict,
+                          const SyllableGraph& syllable_graph,
+                          size_t start_pos) {
+  auto found = phrases_.find(start_pos);
+  if (found != phrases_.end())
+    return found->second;
+  // kept across keystrokes, so not to pin blocks of the composition arena
+  ArenaScope no_arena(nullptr);
+  auto result = dict->Lookup(syllable_graph, start_pos);
+  if (!result)
+    return nullptr;
+  phrases_[start_pos] = result;
+  return result;
+}
+
+an<const UserDictEntryCollector>
+ScriptLookupCache::Lookup(UserDictionary* user_dict,
+                          const SyllableGraph& syllable_graph,
+                          size_t start_pos,
+                          size_t depth_limit) {
+  // the db may have been updated by any session sharing it
+  uint64_t revision = user_dict->revision();
+  if (revision != user_dict_revision_) {
+    user_phrases_.clear();
+    user_dict_revision_ = revision;
+  }
+  auto key = std::make_pair(start_pos, depth_limit);
+  auto found = user_phrases_.find(key);
+  if (found != user_phrases_.end())
+    return found->second;
+  ArenaScope no_arena(nullptr);
+  auto result = user_dict->Lookup(syllable_graph, start_pos, depth_limit);
+  if (!result)
+    return nullptr;
+  if (user_dict->revision() == revision) {
+    user_phrases_[key] = result;
+  }
+  return result;
+}
+
+size_t ScriptLookupCache::SentenceStableLength(
+    const an<ScriptSyllabifier>& syllabifier,
+    UserDictionary* user_dict) {
+  uint64_t revision = user_dict ? user_dict->revision() : 0;
+  size_t stable_length = 0;
+  if (poet_syllabifier_ &&
+      user_dict == poet_user_dict_ &&
+      revision == poet_user_dict_revision_) {
+    // edges of the word graph only depend on syllables in between
+    stable_length = syllabifier->syllable_graph().CommonPrefixLength(
+        poet_syllabifier_->syllable_graph());
+  }
+  poet_syllabifier_ = syllabifier;
+  poet_user_dict_ = user_dict;
+  poet_user_dict_revision_ = revision;
+  return stable_length;
+}
+
 // ScriptSyllabifier implementation
 
 Spans ScriptSyllabifier::Syllabify(const Phrase* phrase) {
@@ -269,7 +492,11 @@ Spans ScriptSyllabifier::Syllabify(const Phrase* phrase) {
   return result;
 }
 
-size_t ScriptSyllabifier::BuildSyllableGraph(Prism& prism) {
+size_t ScriptSyllabifier::BuildSyllableGraph(Prism& prism,
+                                             ScriptSyllabifier* previous) {
+  if (previous) {
+    syllabifier_.TakeMatches(&previous->syllabifier_);
+  }
   return (size_t)syllabifier_.BuildSyllableGraph(input_,
                                                  prism,
                                                  &syllable_graph_);
@@ -285,20 +512,8 @@ bool ScriptSyllabifier::IsCandidateCorrection(const rime::Phrase &cand) const {
     [&](SyllabifyTask* task, size_t depth,
         size_t current_pos, size_t next_pos) {
       auto id = cand.code()[depth];
-      auto it_s = syllable_graph_.edges.find(current_pos);
-      // C++ prohibit operator [] of const map
-      // if (syllable_graph_.edges[current_pos][next_pos][id].type == kCorrection)
-      if (it_s != syllable_graph_.edges.end()) {
-        auto it_e = it_s->second.find(next_pos);
-        if (it_e != it_s->second.end()) {
-          auto it_type = it_e->second.find(id);
-          if (it_type != it_e->second.end()) {
-            results.push(it_type->second.is_correction);
-            return;
-          }
-        }
-      }
-      results.push(false);
+      auto edge = syllable_graph_.flat().FindEdge(current_pos, next_pos, id);
+      results.push(edge && edge->properties.is_correction);
     },
     [&](SyllabifyTask* task, size_t depth) {
       results.pop();
@@ -354,13 +569,16 @@ string ScriptSyllabifier::GetOriginalSpelling(const Phrase& cand) const {
 
 // ScriptTranslation implementation
 
-bool ScriptTranslation::Evaluate(Dictionary* dict, UserDictionary* user_dict) {
-  size_t consumed = syllabifier_->BuildSyllableGraph(*dict->prism());
+bool ScriptTranslation::Evaluate(Dictionary* dict,
+                                 UserDictionary* user_dict,
+                                 ScriptLookupCache* cache,
+                                 bool defer_sentence) {
   const auto& syllable_graph = syllabifier_->syllable_graph();
+  size_t consumed = syllable_graph.interpreted_length;
 
-  phrase_ = dict->Lookup(syllable_graph, 0);
+  phrase_ = cache->Lookup(dict, syllable_graph, 0);
   if (user_dict) {
-    user_phrase_ = user_dict->Lookup(syllable_graph, 0);
+    user_phrase_ = cache->Lookup(user_dict, syllable_graph, 0, 0);
   }
   if (!phrase_ && !user_phrase_)
     return false;
@@ -372,11 +590,22 @@ bool ScriptTranslation::Evaluate(Dictionary* dict, UserDictionary* user_dict) {
     translated_len = (std::max)(translated_len, user_phrase_->rbegin()->first);
   if (translated_len < consumed &&
       syllable_graph.edges.size() > 1) {  // at least 2 syllables required
-    sentence_ = MakeSentence(dict, user_dict);
+    if (!defer_sentence) {
+      sentence_ = MakeSentence(dict, user_dict, cache);
+    }
+    else if (auto sentence = cache->GetSentence(syllabifier_)) {
+      // a copy, free to be modified by this translation
+      sentence_ = ArenaNew<Sentence>(*sentence);
+    }
+    else {
+      sentence_pending_ = true;
+    }
   }
 
-  if (phrase_)
+  if (phrase_) {
     phrase_iter_ = phrase_->rbegin();
+    CopyPhraseEntries();
+  }
   if (user_phrase_)
     user_phrase_iter_ = user_phrase_->rbegin();
   return !CheckEmpty();
@@ -402,16 +631,16 @@ bool ScriptTranslation::Next() {
     }
     if (user_phrase_code_length > 0 &&
         user_phrase_code_length >= phrase_code_length) {
-      DictEntryList& entries(user_phrase_iter_->second);
+      const DictEntryList& entries(user_phrase_iter_->second);
       if (++user_phrase_index_ >= entries.size()) {
         ++user_phrase_iter_;
         user_phrase_index_ = 0;
       }
     }
     else if (phrase_code_length > 0) {
-      DictEntryIterator& iter(phrase_iter_->second);
-      if (!iter.Next()) {
+      if (!phrase_entries_.Next()) {
         ++phrase_iter_;
+        CopyPhraseEntries();
       }
     }
     if (enable_correction_) {
@@ -486,29 +715,28 @@ void ScriptTranslation::PrepareCandidate() {
   an<Phrase> cand;
   if (user_phrase_code_length > 0 &&
       user_phrase_code_length >= phrase_code_length) {
-    DictEntryList& entries(user_phrase_iter_->second);
+    const DictEntryList& entries(user_phrase_iter_->second);
     const auto& entry(entries[user_phrase_index_]);
     DLOG(INFO) << "user phrase '" << entry->text
                << "', code length: " << user_phrase_code_length;
-    cand = New<Phrase>(translator_->language(),
-                       "user_phrase",
-                       start_,
-                       start_ + user_phrase_code_length,
-                       entry);
+    cand = ArenaNew<Phrase>(translator_->language(),
+                            "user_phrase",
+                            start_,
+                            start_ + user_phrase_code_length,
+                            entry);
     cand->set_quality(exp(entry->weight) +
                       translator_->initial_quality() +
                       (IsNormalSpelling() ? 0.5 : -0.5));
   }
   else if (phrase_code_length > 0) {
-    DictEntryIterator& iter(phrase_iter_->second);
-    const auto& entry(iter.Peek());
+    const auto& entry(phrase_entries_.Peek());
     DLOG(INFO) << "phrase '" << entry->text
                << "', code length: " << phrase_code_length;
-    cand = New<Phrase>(translator_->language(),
-                       "phrase",
-                       start_,
-                       start_ + phrase_code_length,
-                       entry);
+    cand = ArenaNew<Phrase>(translator_->language(),
+                            "phrase",
+                            start_,
+                            start_ + phrase_code_length,
+                            entry);
     cand->set_quality(exp(entry->weight) +
                       translator_->initial_quality() +
                       (IsNormalSpelling() ? 0 : -1));
@@ -516,33 +744,44 @@ void ScriptTranslation::PrepareCandidate() {
   candidate_ = cand;
 }
 
+void ScriptTranslation::CopyPhraseEntries() {
+  if (phrase_iter_ != phrase_->rend()) {
+    phrase_entries_ = phrase_iter_->second;
+  }
+}
+
 bool ScriptTranslation::CheckEmpty() {
   set_exhausted((!phrase_ || phrase_iter_ == phrase_->rend()) &&
                 (!user_phrase_ || user_phrase_iter_ == user_phrase_->rend()));
   return exhausted();
 }
 
-an<Sentence> ScriptTranslation::MakeSentence(Dictionary* dict,
-                                             UserDictionary* user_dict) {
+an<Sentence> ScriptTranslation::MakeSentence(
+    Dictionary* dict,
+    UserDictionary* user_dict,
+    ScriptLookupCache* cache,
+    const function<bool ()>& interrupted) {
   const int kMaxSyllablesForUserPhraseQuery = 5;
   const auto& syllable_graph = syllabifier_->syllable_graph();
+  size_t stable_length = cache->SentenceStableLength(syllabifier_, user_dict);
   WordGraph graph;
   for (const auto& x : syllable_graph.edges) {
     UserDictEntryCollector& dest(graph[x.first]);
     if (user_dict) {
-      auto user_phrase = user_dict->Lookup(syllable_graph, x.first,
-                                           kMaxSyllablesForUserPhraseQuery);
+      auto user_phrase = cache->Lookup(user_dict, syllable_graph, x.first,
+                                       kMaxSyllablesForUserPhraseQuery);
       if (user_phrase)
-        dest.swap(*user_phrase);
+        dest = *user_phrase;
     }
-    if (auto phrase = dict->Lookup(syllable_graph, x.first)) {
+    if (auto phrase = cache->Lookup(dict, syllable_graph, x.first)) {
       // merge lookup results
-      for (auto& y : *phrase) {
+      for (const auto& y : *phrase) {
         DictEntryList& entries(dest[y.first]);
+        DictEntryIterator iter(y.second);
         while (entries.size() < translator_->max_homophones() &&
-               !y.second.exhausted()) {
-          entries.push_back(y.second.Peek());
-          if (!y.second.Next())
+               !iter.exhausted()) {
+          entries.push_back(iter.Peek());
+          if (!iter.Next())
             break;
         }
       }
@@ -551,7 +790,9 @@ an<Sentence> ScriptTranslation::MakeSentence(Dictionary* dict,
   if (auto sentence =
       poet_->MakeSentence(graph,
                           syllable_graph.interpreted_length,
-                          translator_->GetPrecedingText(start_))) {
+                          translator_->GetPrecedingText(start_),
+                          stable_length,
+                          interrupted)) {
     sentence->Offset(start_);
     sentence->set_syllabifier(syllabifier_);
     return sentence;
@@ -22,6 +22,8 @@ struct DictEntry;
 struct DictEntryCollector;
 class Dictionary;
 class Poet;
+class ScriptLookupCache;
+class ScriptSyllabifier;
 class UserDictionary;
 struct SyllableGraph;
 
@@ -30,9 +32,12 @@ class ScriptTranslator : public Translator,
                          public TranslatorOptions {
  public:
   ScriptTranslator(const Ticket& ticket);
+  virtual ~ScriptTranslator();
 
   virtual an<Translation> Query(const string& input,
                                 const Segment& segment);
+  // the user dictionary may be shared with other translators
+  virtual bool parallel_safe() const { return !user_dict(); }
   virtual bool Memorize(const CommitEntry& commit_entry);
 
   string FormatPreedit(const string& preedit);
@@ -45,12 +50,18 @@ class ScriptTranslator : public Translator,
   bool always_show_comments() const { return always_show_comments_; }
 
  protected:
+  // makes a sentence in the background, then updates the composition
+  bool MakeSentenceLater(an<ScriptSyllabifier> syllabifier,
+                         bool enable_user_dict);
+
   int max_homophones_ = 1;
   int spelling_hints_ = 0;
   bool always_show_comments_ = false;
   bool enable_correction_ = false;
+  bool async_sentence_ = false;
   the<Corrector> corrector_;
   the<Poet> poet_;
+  the<ScriptLookupCache> lookup_cache_;
 };
 
 }  // namespace rime
@@ -16,6 +16,9 @@
 
 namespace rime {
 
+static const TagId kRawTag = TagRegistry::Intern("raw");
+static const TagId kPagingTag = TagRegistry::Intern("paging");
+
 Selector::Selector(const Ticket& ticket) : Processor(ticket) {
 }
 
@@ -26,7 +29,7 @@ ProcessResult Selector::ProcessKeyEvent(const KeyEvent& key_event) {
   if (ctx->composition().empty())
     return kNoop;
   Segment& current_segment(ctx->composition().back());
-  if (!current_segment.menu || current_segment.HasTag("raw"))
+  if (!current_segment.menu || current_segment.HasTag(kRawTag))
     return kNoop;
   int ch = key_event.keycode();
   if (ch == XK_Prior || ch == XK_KP_Prior) {
@@ -109,7 +112,7 @@ bool Selector::PageUp(Context* ctx) {
   int selected_index = comp.back().selected_index;
   int index = selected_index < page_size ? 0 : selected_index - page_size;
   comp.back().selected_index = index;
-  comp.back().tags.insert("paging");
+  comp.back().tags.insert(kPagingTag);
   return true;
 }
 
@@ -126,7 +129,7 @@ bool Selector::PageDown(Context* ctx) {
   if (index >= candidate_count)
     index = candidate_count - 1;
   comp.back().selected_index = index;
-  comp.back().tags.insert("paging");
+  comp.back().tags.insert(kPagingTag);
   return true;
 
 }
@@ -139,7 +142,7 @@ bool Selector::CursorUp(Context* ctx) {
   if (index <= 0)
     return false;
   comp.back().selected_index = index - 1;
-  comp.back().tags.insert("paging");
+  comp.back().tags.insert(kPagingTag);
   return true;
 }
 
@@ -152,7 +155,7 @@ bool Selector::CursorDown(Context* ctx) {
   if (candidate_count <= index)
     return false;
   comp.back().selected_index = index;
-  comp.back().tags.insert("paging");
+  comp.back().tags.insert(kPagingTag);
   return true;
 }
 
@@ -207,7 +207,7 @@ void Simplifier::PushBack(const an<Candidate>& original,
                                             + original->text().length());
   bool show_tips = (tips_level_ == kTipsChar && length == 1) || tips_level_ == kTipsAll;
   if (show_in_comment_) {
-    text = original->text();
+    // leave text empty for the shadow candidate to show the original text
     if (show_tips) {
       tips = simplified;
       comment_formatter_.Apply(&tips);
@@ -223,11 +223,11 @@ void Simplifier::PushBack(const an<Candidate>& original,
     }
   }
   result->push_back(
-      New<ShadowCandidate>(
+      ArenaNew<ShadowCandidate>(
           original,
           "simplified",
-          text,
-          tips));
+          std::move(text),
+          std::move(tips)));
 }
 
 bool Simplifier::Convert(const an<Candidate>& original,
@@ -4,6 +4,7 @@
 //
 // 2011-07-10 GONG Chen <chen.sst@gmail.com>
 //
+#include <algorithm>
 #include <boost/algorithm/string.hpp>
 #include <boost/range/adaptor/reversed.hpp>
 #include <utf8.h>
@@ -15,6 +16,7 @@
 #include <rime/engine.h>
 #include <rime/schema.h>
 #include <rime/translation.h>
+#include <rime/algo/utilities.h>
 #include <rime/dict/dictionary.h>
 #include <rime/dict/user_dictionary.h>
 #include <rime/gear/charset_filter.h>
@@ -76,7 +78,7 @@ an<Candidate> TableTranslation::Peek() {
   }
   bool incomplete = e->remaining_code_length != 0;
   auto type = incomplete ? "completion" : is_user_phrase ? "user_table" : "table";
-  auto phrase = New<Phrase>(language_, type, start_, end_, e);
+  auto phrase = ArenaNew<Phrase>(language_, type, start_, end_, e);
   if (phrase) {
     phrase->set_comment(comment);
     phrase->set_preedit(preedit_);
@@ -99,7 +101,7 @@ bool TableTranslation::PreferUserPhrase() {
     return false;
   if (iter_.exhausted())
     return true;
-  if (iter_.Peek()->remaining_code_length == 0 &&
+  if (iter_.PeekView().remaining_code_length() == 0 &&
       (uter_.Peek()->remaining_code_length != 0 ||
        is_constructed(uter_.Peek().get())))
     return false;
@@ -238,7 +240,7 @@ static bool starts_with_completion(an<Translation> translation) {
 
 an<Translation> TableTranslator::Query(const string& input,
                                        const Segment& segment) {
-  if (!segment.HasTag(tag_))
+  if (!segment.HasTag(tag_id_))
     return nullptr;
   DLOG(INFO) << "input = '" << input
              << "', [" << segment.start << ", " << segment.end << ")";
@@ -474,7 +476,7 @@ an<Candidate> SentenceTranslation::Peek() {
     code_length = r->first;
     entry = r->second.Peek();
   }
-  auto result = New<Phrase>(
+  auto result = ArenaNew<Phrase>(
       translator_ ? translator_->language() : NULL,
       is_user_phrase ? "user_table" : "table",
       start_,
@@ -565,6 +567,16 @@ TableTranslator::MakeSentence(const string& input, size_t start,
   bool filter_by_charset = enable_charset_filter_ &&
       !engine_->context()->get_option("extended_charset");
   const int max_entries = max_homographs_;
+  // edges of the word graph only depend on the input in between
+  uint64_t revision = user_dict_ ? user_dict_->revision() : 0;
+  size_t stable_length = 0;
+  if (filter_by_charset == last_sentence_filtered_ &&
+      revision == last_sentence_revision_) {
+    stable_length = CommonPrefixLength(input, last_sentence_input_);
+  }
+  last_sentence_input_ = input;
+  last_sentence_filtered_ = filter_by_charset;
+  last_sentence_revision_ = revision;
   DictEntryCollector collector;
   UserDictEntryCollector user_phrase_collector;
   WordGraph graph;
@@ -692,7 +704,8 @@ TableTranslator::MakeSentence(const string& input, size_t start,
   }
   if (auto sentence = poet_->MakeSentence(graph,
                                           input.length(),
-                                          GetPrecedingText(start))) {
+                                          GetPrecedingText(start),
+                                          stable_length)) {
     auto result = Cached<SentenceTranslation>(
         this,
         std::move(sentence),
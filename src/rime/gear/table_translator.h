@@ -30,6 +30,8 @@ class TableTranslator : public Translator,
 
   virtual an<Translation> Query(const string& input,
                                 const Segment& segment);
+  // the user dictionary may be shared with other translators
+  virtual bool parallel_safe() const { return !user_dict(); }
   virtual bool Memorize(const CommitEntry& commit_entry);
 
   an<Translation> MakeSentence(const string& input,
@@ -48,6 +50,10 @@ class TableTranslator : public Translator,
   int max_homographs_ = 1;
   the<Poet> poet_;
   the<UnityTableEncoder> encoder_;
+  // with which the poet has made the last sentence
+  string last_sentence_input_;
+  bool last_sentence_filtered_ = false;
+  uint64_t last_sentence_revision_ = 0;
 };
 
 class TableTranslation : public Translation {
@@ -18,16 +18,40 @@ namespace rime {
 
 bool Patterns::Load(an<ConfigList> patterns) {
   clear();
+  compiled_ = PatternSet();
+  uncompiled_.clear();
   if (!patterns)
     return false;
   for (auto it = patterns->begin(); it != patterns->end(); ++it) {
     if (auto value = As<ConfigValue>(*it)) {
       push_back(boost::regex(value->str()));
+      if (compiled_.Add(value->str(), true) < 0)
+        uncompiled_.push_back(size() - 1);
     }
   }
+  if (!compiled_.empty() && !compiled_.Compile()) {
+    compiled_ = PatternSet();
+    uncompiled_.clear();
+    for (size_t i = 0; i < size(); ++i)
+      uncompiled_.push_back(i);
+  }
   return true;
 }
 
+bool Patterns::MatchWhole(const string& input) const {
+  if (compiled_.compiled()) {
+    vector<size_t> starts;
+    compiled_.Match(input, 0, &starts);
+    if (std::find(starts.begin(), starts.end(), 0) != starts.end())
+      return true;
+  }
+  for (size_t i : uncompiled_) {
+    if (boost::regex_match(input, at(i)))
+      return true;
+  }
+  return false;
+}
+
 // Spans
 
 void Spans::AddVertex(size_t vertex) {
@@ -94,7 +118,13 @@ void Sentence::Extend(const DictEntry& entry,
                       const string& preceding_text,
                       Grammar* grammar) {
   const string& context = empty() ? preceding_text : text();
-  entry_->weight += Grammar::Evaluate(context, entry, is_rear, grammar);
+  Extend(entry, end_pos, Grammar::Evaluate(context, entry, is_rear, grammar));
+}
+
+void Sentence::Extend(const DictEntry& entry,
+                      size_t end_pos,
+                      double entry_weight) {
+  entry_->weight += entry_weight;
   entry_->text.append(entry.text);
   entry_->code.insert(entry_->code.end(),
                       entry.code.begin(),
@@ -119,7 +149,8 @@ TranslatorOptions::TranslatorOptions(const Ticket& ticket) {
   if (Config *config = ticket.schema->config()) {
     config->GetString(ticket.name_space + "/delimiter", &delimiters_) ||
         config->GetString("speller/delimiter", &delimiters_);
-    config->GetString(ticket.name_space + "/tag", &tag_);
+    if (config->GetString(ticket.name_space + "/tag", &tag_))
+      tag_id_ = TagRegistry::Intern(tag_);
     config->GetBool(ticket.name_space + "/contextual_suggestions",
                     &contextual_suggestions_);
     config->GetBool(ticket.name_space + "/enable_completion",
@@ -144,11 +175,7 @@ TranslatorOptions::TranslatorOptions(const Ticket& ticket) {
 bool TranslatorOptions::IsUserDictDisabledFor(const string& input) const {
   if (user_dict_disabling_patterns_.empty())
     return false;
-  for (const auto& pattern : user_dict_disabling_patterns_) {
-    if (boost::regex_match(input, pattern))
-      return true;
-  }
-  return false;
+  return user_dict_disabling_patterns_.MatchWhole(input);
 }
 
 }  // namespace rime
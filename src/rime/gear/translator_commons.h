@@ -11,8 +11,10 @@
 #include <rime/common.h>
 #include <rime/config.h>
 #include <rime/candidate.h>
+#include <rime/segment_tags.h>
 #include <rime/translation.h>
 #include <rime/algo/algebra.h>
+#include <rime/algo/pattern_set.h>
 #include <rime/algo/syllabifier.h>
 #include <rime/dict/vocabulary.h>
 
@@ -23,6 +25,13 @@ namespace rime {
 class Patterns : public vector<boost::regex> {
  public:
   bool Load(an<ConfigList> patterns);
+  // whether any of the patterns matches the whole input
+  bool MatchWhole(const string& input) const;
+
+ private:
+  PatternSet compiled_;
+  // patterns left to boost::regex
+  vector<size_t> uncompiled_;
 };
 
 //
@@ -80,8 +89,8 @@ class Phrase : public Candidate {
         entry_(entry) {
   }
   const string& text() const { return entry_->text; }
-  string comment() const { return entry_->comment; }
-  string preedit() const { return entry_->preedit; }
+  const string& comment() const { return entry_->comment; }
+  const string& preedit() const { return entry_->preedit; }
   void set_comment(const string& comment) {
     entry_->comment = comment;
   }
@@ -114,18 +123,20 @@ class Grammar;
 class Sentence : public Phrase {
  public:
   Sentence(const Language* language)
-      : Phrase(language, "sentence", 0, 0, New<DictEntry>()) {}
+      : Phrase(language, "sentence", 0, 0, ArenaNew<DictEntry>()) {}
   Sentence(const Sentence& other)
       : Phrase(other),
         components_(other.components_),
         syllable_lengths_(other.syllable_lengths_) {
-    entry_ = New<DictEntry>(other.entry());
+    entry_ = ArenaNew<DictEntry>(other.entry());
   }
   void Extend(const DictEntry& entry,
               size_t end_pos,
               bool is_rear,
               const string& preceding_text,
               Grammar* grammar);
+  // extends with an entry already evaluated in the context of the sentence
+  void Extend(const DictEntry& entry, size_t end_pos, double entry_weight);
   void Offset(size_t offset);
 
   bool empty() const {
@@ -159,7 +170,11 @@ class TranslatorOptions {
 
   const string& delimiters() const { return delimiters_; }
   const string& tag() const { return tag_; }
-  void set_tag(const string& tag) { tag_ = tag; }
+  TagId tag_id() const { return tag_id_; }
+  void set_tag(const string& tag) {
+    tag_ = tag;
+    tag_id_ = TagRegistry::Intern(tag);
+  }
   bool contextual_suggestions() const { return contextual_suggestions_; }
   void set_contextual_suggestions(bool enabled) {
     contextual_suggestions_ = enabled;
@@ -176,6 +191,7 @@ class TranslatorOptions {
  protected:
   string delimiters_;
   string tag_ = "abc";
+  TagId tag_id_ = TagRegistry::Intern("abc");
   bool contextual_suggestions_ = false;
   bool enable_completion_ = true;
   bool strict_spelling_ = false;
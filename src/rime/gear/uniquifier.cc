@@ -6,6 +6,7 @@
 //
 #include <rime/candidate.h>
 #include <rime/common.h>
+#include <rime/text_index.h>
 #include <rime/translation.h>
 #include <rime/gear/uniquifier.h>
 
@@ -22,39 +23,44 @@ class UniquifiedTranslation : public CacheTranslation {
 
  protected:
   bool Uniquify();
+  int FindTextMatch(const an<Candidate>& target);
 
   an<Translation> translation_;
   CandidateList* candidates_;
+  // indexes texts of the leading candidates in the list
+  TextIndex index_;
 };
 
 bool UniquifiedTranslation::Next() {
   return CacheTranslation::Next() && Uniquify();
 }
 
-static CandidateList::iterator find_text_match(const an<Candidate>& target,
-                                               CandidateList::iterator begin,
-                                               CandidateList::iterator end) {
-  for (auto iter = begin; iter != end; ++iter) {
-    if ((*iter)->text() == target->text()) {
-      return iter;
-    }
+int UniquifiedTranslation::FindTextMatch(const an<Candidate>& target) {
+  // the menu appends candidates that pass the filter to the list
+  if (index_.size() > candidates_->size()) {
+    index_.Clear();
+  }
+  for (size_t i = index_.size(); i < candidates_->size(); ++i) {
+    index_.Add((*candidates_)[i]->text(), static_cast<int>(i));
   }
-  return end;
+  return index_.Find(target->text(), [this](int i) -> const string& {
+    return (*candidates_)[i]->text();
+  });
 }
 
 bool UniquifiedTranslation::Uniquify() {
   while (!exhausted()) {
     auto next = Peek();
-    CandidateList::iterator previous = find_text_match(
-        next, candidates_->begin(), candidates_->end());
-    if (previous == candidates_->end()) {
+    int match = FindTextMatch(next);
+    if (match < 0) {
       // Encountered a unique candidate.
       return true;
     }
+    auto previous = candidates_->begin() + match;
     auto uniquified = As<UniquifiedCandidate>(*previous);
     if (!uniquified) {
       *previous = uniquified =
-          New<UniquifiedCandidate>(*previous, "uniquified");
+          ArenaNew<UniquifiedCandidate>(*previous, "uniquified");
     }
     uniquified->Append(next);
     CacheTranslation::Next();
@@ -17,6 +17,7 @@
 #include <rime/setup.h>
 #include <rime/ticket.h>
 #include <rime/algo/utilities.h>
+#include <rime/config/config_data.h>
 #include <rime/dict/dictionary.h>
 #include <rime/dict/dict_compiler.h>
 #include <rime/lever/deployment_tasks.h>
@@ -501,6 +502,26 @@ namespace rime
     return false;
   }
 
+  // saves a binary image of the build output, to be loaded in its place
+  static bool UpdateConfigImage(const string &file_name)
+  {
+    the<ResourceResolver> resolver(
+        Service::instance().CreateResourceResolver(
+            {"compiled_config", "build/", ".yaml"}));
+    string compiled_config =
+        resolver->ResolvePath(resolver->ToResourceId(file_name)).string();
+    if (!fs::exists(compiled_config))
+      return false;
+    string image_file = ConfigData::ImageFileName(compiled_config);
+    ConfigData data;
+    // an image is only loaded if made from the same content
+    if (data.LoadFromImage(image_file, compiled_config))
+      return true; // up-to-date
+    // made from the yaml file, so that it reads exactly the same
+    return data.LoadFromFile(compiled_config, nullptr) &&
+           data.SaveToImage(image_file, compiled_config);
+  }
+
   bool ConfigFileUpdate::Run(Deployer *deployer)
   {
     // std::cout << "*************deployer->shared_data_dir  " << deployer->shared_data_dir << std::endl;
@@ -533,6 +554,10 @@ namespace rime
       }
       config.reset(Config::Require("config_builder")->Create(file_name_));
     }
+    if (!UpdateConfigImage(file_name_))
+    {
+      LOG(WARNING) << "no config image for '" << file_name_ << "'.";
+    }
     return true;
   }
 
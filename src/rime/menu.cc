@@ -38,6 +38,13 @@ size_t Menu::Prepare(size_t requested) {
 }
 
 Page* Menu::CreatePage(size_t page_size, size_t page_no) {
+  the<Page> page(new Page);
+  if (!FillPage(page_size, page_no, page.get()))
+    return NULL;
+  return page.release();
+}
+
+bool Menu::FillPage(size_t page_size, size_t page_no, Page* page) {
   size_t start_pos = page_size * page_no;
   size_t end_pos = start_pos + page_size;
   if (end_pos > candidates_.size()) {
@@ -46,19 +53,15 @@ Page* Menu::CreatePage(size_t page_size, size_t page_no) {
     else
       end_pos = Prepare(end_pos);
     if (start_pos >= end_pos)
-      return NULL;
+      return false;
     end_pos = (std::min)(start_pos + page_size, end_pos);
   }
-  Page* page = new Page;
-  if (!page)
-    return NULL;
   page->page_size = page_size;
   page->page_no = page_no;
   page->is_last_page = result_->exhausted() && (end_pos == candidates_.size());
-  std::copy(candidates_.begin() + start_pos,
-            candidates_.begin() + end_pos,
-            std::back_inserter(page->candidates));
-  return page;
+  page->candidates.assign(candidates_.begin() + start_pos,
+                          candidates_.begin() + end_pos);
+  return true;
 }
 
 an<Candidate> Menu::GetCandidateAt(size_t index) {
@@ -33,6 +33,8 @@ class Menu {
 
   RIME_API size_t Prepare(size_t candidate_count);
   RIME_API Page* CreatePage(size_t page_size, size_t page_no);
+  // fills an existing page, reusing its storage
+  RIME_API bool FillPage(size_t page_size, size_t page_no, Page* page);
   an<Candidate> GetCandidateAt(size_t index);
 
   // CAVEAT: returns the number of candidates currently obtained,
@@ -27,6 +27,7 @@ class Voidify {
 
 #define LOG(severity) RIME_NO_LOG
 #define VLOG(verboselevel) RIME_NO_LOG
+#define VLOG_IS_ON(verboselevel) false
 #define LOG_IF(severity, condition) RIME_NO_LOG
 #define LOG_EVERY_N(severity, n) RIME_NO_LOG
 #define LOG_IF_EVERY_N(severity, condition, n) RIME_NO_LOG
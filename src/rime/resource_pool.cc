@@ -0,0 +1,119 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <rime/resource_pool.h>
+
+namespace rime {
+
+static thread_local int pinning_depth = 0;
+
+ResourcePinning::ResourcePinning() {
+  ++pinning_depth;
+}
+
+ResourcePinning::~ResourcePinning() {
+  --pinning_depth;
+}
+
+bool ResourcePinning::active() {
+  return pinning_depth > 0;
+}
+
+static std::atomic<uint64_t> pool_generation{0};
+
+namespace {
+
+struct Pools {
+  std::mutex mutex;
+  set<ResourcePoolBase*> pools;
+  uint64_t clock = 0;
+
+  static Pools& instance() {
+    // never destroyed, as pools owned by static objects may outlive it
+    static Pools* pools = new Pools;
+    return *pools;
+  }
+};
+
+}  // namespace
+
+void ResourcePoolBase::Register() {
+  Pools& pools(Pools::instance());
+  std::lock_guard<std::mutex> lock(pools.mutex);
+  pools.pools.insert(this);
+}
+
+void ResourcePoolBase::Unregister() {
+  Pools& pools(Pools::instance());
+  std::lock_guard<std::mutex> lock(pools.mutex);
+  pools.pools.erase(this);
+}
+
+std::mutex& ResourcePoolBase::mutex() {
+  return Pools::instance().mutex;
+}
+
+uint64_t ResourcePoolBase::Tick() {
+  return ++Pools::instance().clock;
+}
+
+void ResourcePoolBase::Trim(size_t budget) {
+  vector<IdleResource> idle;
+  for (ResourcePoolBase* pool : Pools::instance().pools) {
+    pool->CollectIdleResources(&idle);
+  }
+  size_t total_size = 0;
+  for (const auto& resource : idle) {
+    total_size += resource.size;
+  }
+  if (total_size <= budget)
+    return;
+  std::sort(idle.begin(), idle.end(),
+            [](const IdleResource& a, const IdleResource& b) {
+              return a.last_used < b.last_used;
+            });
+  for (auto& resource : idle) {
+    if (total_size <= budget)
+      break;
+    total_size -= resource.size;
+    resource.release();
+  }
+}
+
+namespace {
+
+struct Invalidations {
+  std::mutex mutex;
+  map<pair<string, string>, uint64_t> generations;
+
+  static Invalidations& instance() {
+    static Invalidations invalidations;
+    return invalidations;
+  }
+};
+
+}  // namespace
+
+void ResourcePoolBase::Invalidate(const string& kind, const string& name) {
+  Invalidations& invalidations(Invalidations::instance());
+  std::lock_guard<std::mutex> lock(invalidations.mutex);
+  invalidations.generations[{kind, name}] = ++pool_generation;
+}
+
+uint64_t ResourcePoolBase::generation() {
+  return pool_generation;
+}
+
+uint64_t ResourcePoolBase::invalidated_in(const string& kind,
+                                          const string& name) {
+  Invalidations& invalidations(Invalidations::instance());
+  std::lock_guard<std::mutex> lock(invalidations.mutex);
+  auto found = invalidations.generations.find({kind, name});
+  return found != invalidations.generations.end() ? found->second : 0;
+}
+
+}  // namespace rime
@@ -0,0 +1,169 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+#ifndef RIME_RESOURCE_POOL_H_
+#define RIME_RESOURCE_POOL_H_
+
+#include <stdint.h>
+#include <mutex>
+#include <rime_api.h>
+#include <rime/common.h>
+
+namespace rime {
+
+// While an instance is alive, read-only resources obtained from pools on the
+// current thread are pinned, i.e. kept loaded after they are no longer in use.
+// Resources of unknown size, eg. user dbs, are never pinned, as they have to
+// be closed for maintenance and sync.
+class ResourcePinning {
+ public:
+  RIME_API ResourcePinning();
+  RIME_API ~ResourcePinning();
+
+  RIME_API static bool active();
+};
+
+class ResourcePoolBase {
+ public:
+  // makes pools of the kind load the named resource anew, eg. after its
+  // files are rebuilt. Users of the old instance keep it until released.
+  RIME_API static void Invalidate(const string& kind, const string& name);
+
+ protected:
+  // a resource kept loaded by a pool while not in use
+  struct IdleResource {
+    uint64_t last_used;
+    size_t size;
+    function<void ()> release;
+  };
+
+  virtual ~ResourcePoolBase() = default;
+
+  // pools take part in trimming while registered
+  RIME_API void Register();
+  RIME_API void Unregister();
+  // lists idle resources of the pool, forgetting those no longer loaded
+  virtual void CollectIdleResources(vector<IdleResource>* idle) = 0;
+
+  // guards the state of all pools
+  RIME_API static std::mutex& mutex();
+  // for ordering uses of resources across pools
+  RIME_API static uint64_t Tick();
+  // releases idle resources of all pools, least recently used first, until
+  // those left fit in the budget. the caller holds mutex().
+  RIME_API static void Trim(size_t budget);
+
+  RIME_API static uint64_t generation();
+  // the generation in which the named resource was last invalidated, or 0.
+  RIME_API static uint64_t invalidated_in(const string& kind,
+                                          const string& name);
+};
+
+// Shares named resources among their users.
+// A read-only resource of known size that is no longer in use is kept loaded
+// if it is pinned, or as long as idle resources of all pools fit in the
+// budget in bytes, in which case the least recently used ones are released
+// first.
+template <class T>
+class ResourcePool : public ResourcePoolBase {
+ public:
+  using SizeOf = function<size_t (const T& resource)>;
+
+  // kind names the resources for invalidation, eg. "table".
+  // resources of unknown size are only shared while in use.
+  explicit ResourcePool(const string& kind, SizeOf size_of = nullptr)
+      : kind_(kind), size_of_(size_of) {
+    Register();
+  }
+  ~ResourcePool() override {
+    Unregister();
+  }
+
+  // budget is the total for all pools, eg. Deployer::resource_cache_size
+  template <class Create>
+  an<T> Get(const string& name, Create create, size_t budget);
+
+ protected:
+  void CollectIdleResources(vector<IdleResource>* idle) override;
+
+ private:
+  struct Entry {
+    weak<T> ref;
+    an<T> kept;
+    bool pinned = false;
+    uint64_t last_used = 0;
+    uint64_t created_in = 0;
+  };
+
+  void Refresh(const string& name, Entry* e);
+
+  string kind_;
+  map<string, Entry> entries_;
+  SizeOf size_of_;
+  uint64_t generation_ = 0;
+};
+
+template <class T>
+template <class Create>
+an<T> ResourcePool<T>::Get(const string& name,
+                           Create create,
+                           size_t budget) {
+  std::lock_guard<std::mutex> lock(mutex());
+  if (generation_ != generation()) {
+    generation_ = generation();
+    for (auto& entry : entries_) {
+      Refresh(entry.first, &entry.second);
+    }
+  }
+  Entry& e(entries_[name]);
+  an<T> resource = e.kept ? e.kept : e.ref.lock();
+  if (!resource) {
+    resource = create();
+    e.ref = resource;
+    e.created_in = generation_;
+  }
+  e.last_used = Tick();
+  if (size_of_ && ResourcePinning::active()) {
+    e.pinned = true;
+  }
+  if (e.pinned || (size_of_ && budget > 0)) {
+    e.kept = resource;
+  }
+  if (size_of_) {
+    Trim(budget);
+  }
+  return resource;
+}
+
+template <class T>
+void ResourcePool<T>::Refresh(const string& name, Entry* e) {
+  if (invalidated_in(kind_, name) <= e->created_in)
+    return;
+  // forget the stale instance; those still using it hold their own refs
+  e->ref.reset();
+  e->kept.reset();
+  e->pinned = false;
+}
+
+template <class T>
+void ResourcePool<T>::CollectIdleResources(vector<IdleResource>* idle) {
+  for (auto it = entries_.begin(); it != entries_.end(); ) {
+    Entry& e(it->second);
+    if (!e.kept && e.ref.expired()) {
+      it = entries_.erase(it);
+      continue;
+    }
+    // idle resources are only referenced by the pool
+    if (size_of_ && e.kept && !e.pinned && e.kept.use_count() == 1) {
+      Entry* entry = &e;
+      idle->push_back({e.last_used, size_of_(*e.kept),
+                       [entry] { entry->kept.reset(); }});
+    }
+    ++it;
+  }
+}
+
+}  // namespace rime
+
+#endif  // RIME_RESOURCE_POOL_H_
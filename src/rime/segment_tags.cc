@@ -0,0 +1,110 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+#include <deque>
+#include <mutex>
+#include <rime/segment_tags.h>
+
+namespace rime {
+
+namespace {
+
+struct TagNames {
+  std::mutex mutex;
+  hash_map<string, TagId> ids;
+  // elements stay in place as more are added
+  std::deque<string> names;
+
+  static TagNames& instance() {
+    static TagNames tag_names;
+    return tag_names;
+  }
+};
+
+int CountBits(uint64_t bits) {
+  int count = 0;
+  for (; bits; bits &= bits - 1)
+    ++count;
+  return count;
+}
+
+int LowestBit(uint64_t bits) {
+  int index = 0;
+  for (; !(bits & 1); bits >>= 1)
+    ++index;
+  return index;
+}
+
+}  // namespace
+
+TagId TagRegistry::Intern(const string& name) {
+  TagNames& tag_names(TagNames::instance());
+  std::lock_guard<std::mutex> lock(tag_names.mutex);
+  auto found = tag_names.ids.find(name);
+  if (found != tag_names.ids.end())
+    return found->second;
+  TagId id = static_cast<TagId>(tag_names.names.size());
+  tag_names.names.push_back(name);
+  tag_names.ids.emplace(name, id);
+  return id;
+}
+
+TagId TagRegistry::Find(const string& name) {
+  TagNames& tag_names(TagNames::instance());
+  std::lock_guard<std::mutex> lock(tag_names.mutex);
+  auto found = tag_names.ids.find(name);
+  return found != tag_names.ids.end() ? found->second : -1;
+}
+
+const string& TagRegistry::Name(TagId id) {
+  TagNames& tag_names(TagNames::instance());
+  std::lock_guard<std::mutex> lock(tag_names.mutex);
+  return tag_names.names.at(id);
+}
+
+void SegmentTags::insert(TagId id) {
+  if (id < 0)
+    return;
+  if (id < kInlineTags) {
+    bits_ |= uint64_t(1) << id;
+    return;
+  }
+  auto pos = std::lower_bound(overflow_.begin(), overflow_.end(), id);
+  if (pos == overflow_.end() || *pos != id)
+    overflow_.insert(pos, id);
+}
+
+void SegmentTags::insert(const SegmentTags& tags) {
+  bits_ |= tags.bits_;
+  for (TagId id : tags.overflow_)
+    insert(id);
+}
+
+void SegmentTags::erase(TagId id) {
+  if (id < 0)
+    return;
+  if (id < kInlineTags) {
+    bits_ &= ~(uint64_t(1) << id);
+    return;
+  }
+  auto pos = std::lower_bound(overflow_.begin(), overflow_.end(), id);
+  if (pos != overflow_.end() && *pos == id)
+    overflow_.erase(pos);
+}
+
+size_t SegmentTags::size() const {
+  return CountBits(bits_) + overflow_.size();
+}
+
+TagId SegmentTags::NextId(TagId id) const {
+  if (id + 1 < kInlineTags) {
+    uint64_t rest = bits_ & (~uint64_t(0) << (id + 1));
+    if (rest)
+      return LowestBit(rest);
+  }
+  auto next = std::upper_bound(overflow_.begin(), overflow_.end(), id);
+  return next != overflow_.end() ? *next : -1;
+}
+
+}  // namespace rime
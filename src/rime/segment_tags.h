@@ -0,0 +1,120 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+#ifndef RIME_SEGMENT_TAGS_H_
+#define RIME_SEGMENT_TAGS_H_
+
+#include <stdint.h>
+#include <algorithm>
+#include <iterator>
+#include <rime_api.h>
+#include <rime/common.h>
+
+namespace rime {
+
+using TagId = int;
+
+// Gives every tag name a small integer id. Ids are shared by all schemas
+// and never reused, so components intern the tags they use once, when
+// they are created, and test segments for the ids afterwards.
+class TagRegistry {
+ public:
+  RIME_API static TagId Intern(const string& name);
+  // returns -1 for a name that was never interned.
+  RIME_API static TagId Find(const string& name);
+  RIME_API static const string& Name(TagId id);
+};
+
+// The tags of a segment, stored as a bitset of tag ids. The set<string>
+// like interface interns or looks up names on the way.
+class SegmentTags {
+ public:
+  class const_iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = string;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const string*;
+    using reference = const string&;
+
+    const_iterator(const SegmentTags* tags, TagId id)
+        : tags_(tags), id_(id) {}
+    const string& operator* () const { return TagRegistry::Name(id_); }
+    const string* operator-> () const { return &**this; }
+    const_iterator& operator++ () {
+      id_ = tags_->NextId(id_);
+      return *this;
+    }
+    const_iterator operator++ (int) {
+      const_iterator it(*this);
+      ++*this;
+      return it;
+    }
+    bool operator== (const const_iterator& other) const {
+      return id_ == other.id_;
+    }
+    bool operator!= (const const_iterator& other) const {
+      return id_ != other.id_;
+    }
+    TagId id() const { return id_; }
+
+   private:
+    const SegmentTags* tags_;
+    TagId id_;
+  };
+  using iterator = const_iterator;
+
+  bool Has(TagId id) const {
+    if (id < 0)
+      return false;
+    if (id < kInlineTags)
+      return (bits_ >> id) & 1;
+    return std::binary_search(overflow_.begin(), overflow_.end(), id);
+  }
+  bool Has(const string& name) const {
+    return Has(TagRegistry::Find(name));
+  }
+  RIME_API void insert(TagId id);
+  void insert(const string& name) { insert(TagRegistry::Intern(name)); }
+  RIME_API void insert(const SegmentTags& tags);
+  RIME_API void erase(TagId id);
+  void erase(const string& name) { erase(TagRegistry::Find(name)); }
+  size_t count(const string& name) const { return Has(name) ? 1 : 0; }
+  const_iterator find(const string& name) const {
+    TagId id = TagRegistry::Find(name);
+    return Has(id) ? const_iterator(this, id) : end();
+  }
+
+  bool empty() const { return bits_ == 0 && overflow_.empty(); }
+  RIME_API size_t size() const;
+  void clear() {
+    bits_ = 0;
+    overflow_.clear();
+  }
+
+  // iterates names in the order of their ids
+  const_iterator begin() const { return const_iterator(this, NextId(-1)); }
+  const_iterator end() const { return const_iterator(this, -1); }
+
+  bool operator== (const SegmentTags& other) const {
+    return bits_ == other.bits_ && overflow_ == other.overflow_;
+  }
+  bool operator!= (const SegmentTags& other) const {
+    return !(*this == other);
+  }
+
+ private:
+  static const TagId kInlineTags = 64;
+
+  // the least id in the set greater than id, or -1
+  RIME_API TagId NextId(TagId id) const;
+
+  uint64_t bits_ = 0;
+  // sorted ids that do not fit in bits_
+  vector<TagId> overflow_;
+};
+
+}  // namespace rime
+
+#endif  // RIME_SEGMENT_TAGS_H_
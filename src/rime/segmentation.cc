@@ -12,7 +12,7 @@
 
 namespace rime {
 
-static const char* kPartialSelectionTag = "partial";
+static const TagId kPartialSelectionTag = TagRegistry::Intern("partial");
 
 void Segment::Close() {
   auto cand = GetSelectedCandidate();
@@ -107,11 +107,7 @@ bool Segmentation::AddSegment(Segment segment) {
   }
   else {
     // rule three: with segments equal in length, merge their tags
-    set<string> result;
-    set_union(last.tags.begin(), last.tags.end(),
-                   segment.tags.begin(), segment.tags.end(),
-                   std::inserter(result, result.begin()));
-    last.tags.swap(result);
+    last.tags.insert(segment.tags);
   }
   return true;
 }
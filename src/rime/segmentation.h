@@ -9,6 +9,7 @@
 
 #include <rime_api.h>
 #include <rime/common.h>
+#include <rime/segment_tags.h>
 
 namespace rime {
 
@@ -26,7 +27,7 @@ struct Segment {
   size_t start = 0;
   size_t end = 0;
   size_t length = 0;
-  set<string> tags;
+  SegmentTags tags;
   an<Menu> menu;
   size_t selected_index = 0;
   string prompt;
@@ -49,7 +50,10 @@ struct Segment {
   bool Reopen(size_t caret_pos);
 
   bool HasTag(const string& tag) const {
-    return tags.find(tag) != tags.end();
+    return tags.Has(tag);
+  }
+  bool HasTag(TagId tag) const {
+    return tags.Has(tag);
   }
 
   an<Candidate> GetCandidateAt(size_t index) const;
@@ -7,19 +7,23 @@
 #include <rime/context.h>
 #include <rime/engine.h>
 #include <rime/resource.h>
+#include <rime/resource_pool.h>
 #include <rime/schema.h>
 #include <rime/service.h>
+#include <rime/thread_pool.h>
 
 using namespace std::placeholders;
 
 namespace rime {
 
-Session::Session() {
+Session::Session(SessionId session_id) {
   engine_.reset(Engine::Create());
   engine_->sink().connect(std::bind(&Session::OnCommit, this, _1));
-  SessionId session_id = reinterpret_cast<SessionId>(this);
   engine_->message_sink().connect(
       std::bind(&Service::Notify, &Service::instance(), session_id, _1, _2));
+  engine_->set_task_runner(
+      std::bind(&Service::PostTask, &Service::instance(), session_id, _1));
+  engine_->set_interrupt_check([this] { return mutex_.contended(); });
 }
 
 bool Session::ProcessKey(const KeyEvent& key_event) {
@@ -63,7 +67,15 @@ Schema* Session::schema() const {
   return engine_ ? engine_->active_engine()->schema() : NULL;
 }
 
-Service::Service() {
+CompositionArena* Session::arena() const {
+  return engine_ ? engine_->active_engine()->arena() : NULL;
+}
+
+static const size_t kNumTaskWorkers = 2;
+
+Service::Service()
+    : task_pool_(new ThreadPool(kNumTaskWorkers)),
+      tasks_(new TaskGroup(task_pool_.get())) {
   deployer_.message_sink().connect(
       std::bind(&Service::Notify, this, 0, _1, _2));
 }
@@ -78,6 +90,7 @@ void Service::StartService() {
 
 void Service::StopService() {
   started_ = false;
+  StopWorkers();
   CleanupAllSessions();
 }
 
@@ -85,10 +98,13 @@ SessionId Service::CreateSession() {
   SessionId id = kInvalidSessionId;
   if (disabled()) return id;
   try {
-    auto session = New<Session>();
+    SessionId session_id = ++last_session_id_;
+    auto session = New<Session>(session_id);
     session->Activate();
-    id = reinterpret_cast<uintptr_t>(session.get());
-    sessions_[id] = session;
+    id = session_id;
+    auto& sessions = shard(id);
+    std::lock_guard<std::mutex> lock(sessions.mutex);
+    sessions.sessions[id] = session;
   }
   catch (const std::exception& ex) {
     LOG(ERROR) << "Error creating session: " << ex.what();
@@ -108,65 +124,134 @@ SessionId Service::CreateSession() {
   return id;
 }
 
+Service::SessionShard& Service::shard(SessionId session_id) {
+  return session_shards_[session_id % kNumSessionShards];
+}
+
 an<Session> Service::GetSession(SessionId session_id) {
-  if (disabled())
-    return nullptr;
-  SessionMap::iterator it = sessions_.find(session_id);
-  if (it != sessions_.end()) {
-    auto& session = it->second;
+  auto session = FindSession(session_id);
+  if (session) {
     session->Activate();
-    return session;
   }
-  return nullptr;
+  return session;
+}
+
+an<Session> Service::FindSession(SessionId session_id) {
+  if (disabled())
+    return nullptr;
+  auto& sessions = shard(session_id);
+  std::lock_guard<std::mutex> lock(sessions.mutex);
+  SessionMap::iterator it = sessions.sessions.find(session_id);
+  return it != sessions.sessions.end() ? it->second : nullptr;
 }
 
 bool Service::DestroySession(SessionId session_id) {
-  auto it = sessions_.find(session_id);
-  if (it == sessions_.end())
-    return false;
-  sessions_.erase(it);
+  an<Session> session;  // released outside of the lock
+  {
+    auto& sessions = shard(session_id);
+    std::lock_guard<std::mutex> lock(sessions.mutex);
+    auto it = sessions.sessions.find(session_id);
+    if (it == sessions.sessions.end())
+      return false;
+    session.swap(it->second);
+    sessions.sessions.erase(it);
+  }
   return true;
 }
 
 void Service::CleanupStaleSessions() {
   time_t now = time(NULL);
-  int count = 0;
-  for (auto it = sessions_.begin(); it != sessions_.end(); ) {
-    if (it->second &&
-        it->second->last_active_time() < now - Session::kLifeSpan) {
-      sessions_.erase(it++);
-      ++count;
-    }
-    else {
-      ++it;
+  vector<an<Session>> stale_sessions;
+  for (auto& sessions : session_shards_) {
+    std::lock_guard<std::mutex> lock(sessions.mutex);
+    for (auto it = sessions.sessions.begin();
+         it != sessions.sessions.end(); ) {
+      if (it->second &&
+          it->second->last_active_time() < now - Session::kLifeSpan) {
+        stale_sessions.push_back(std::move(it->second));
+        sessions.sessions.erase(it++);
+      }
+      else {
+        ++it;
+      }
     }
   }
-  if (count > 0) {
-    LOG(INFO) << "Recycled " << count << " stale sessions.";
+  if (!stale_sessions.empty()) {
+    LOG(INFO) << "Recycled " << stale_sessions.size() << " stale sessions.";
   }
 }
 
 void Service::CleanupAllSessions() {
-  sessions_.clear();
+  for (auto& sessions : session_shards_) {
+    SessionMap released;
+    {
+      std::lock_guard<std::mutex> lock(sessions.mutex);
+      released.swap(sessions.sessions);
+    }
+  }
+}
+
+bool Service::PreloadSchema(const string& schema_id) {
+  if (disabled())
+    return false;
+  LOG(INFO) << "preloading schema: " << schema_id;
+  ResourcePinning pinning;
+  // dictionaries are pinned as the engine's components obtain them;
+  // user dbs are closed with the engine
+  the<Engine> engine(Engine::Create());
+  auto schema = new Schema(schema_id);
+  if (schema->config()->IsNull("schema")) {
+    LOG(ERROR) << "schema not found: " << schema_id;
+    delete schema;
+    return false;
+  }
+  engine->ApplySchema(schema);
+  return true;
 }
 
 void Service::SetNotificationHandler(const NotificationHandler& handler) {
+  std::lock_guard<std::mutex> lock(mutex_);
   notification_handler_ = handler;
 }
 
 void Service::ClearNotificationHandler() {
+  std::lock_guard<std::mutex> lock(mutex_);
   notification_handler_ = nullptr;
 }
 
 void Service::Notify(SessionId session_id,
                      const string& message_type,
                      const string& message_value) {
-  if (notification_handler_) {
+  NotificationHandler handler;
+  {
     std::lock_guard<std::mutex> lock(mutex_);
-    notification_handler_(session_id,
-                          message_type.c_str(),
-                          message_value.c_str());
+    handler = notification_handler_;
   }
+  // called without the lock, as the handler may call back into the api,
+  // eg. from the background worker
+  if (handler) {
+    handler(session_id, message_type.c_str(), message_value.c_str());
+  }
+}
+
+void Service::PostTask(SessionId session_id, function<void ()> task) {
+  if (stopping_)
+    return;
+  tasks_->Run([this, session_id, task] {
+    if (stopping_)
+      return;
+    if (auto session = FindSession(session_id)) {
+      std::lock_guard<SessionMutex> lock(session->mutex());
+      task();
+    }
+  });
+}
+
+void Service::StopWorkers() {
+  // pending tasks return right away
+  stopping_ = true;
+  tasks_->Wait();
+  stopping_ = false;
 }
 
 ResourceResolver* Service::CreateResourceResolver(const ResourceType& type) {
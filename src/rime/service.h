@@ -9,6 +9,7 @@
 
 #include <stdint.h>
 #include <time.h>
+#include <atomic>
 #include <mutex>
 #include <rime/common.h>
 #include <rime/deployer.h>
@@ -23,16 +24,37 @@ using NotificationHandler = function<void (SessionId session_id,
                                                 const char* message_type,
                                                 const char* message_value)>;
 
+class CompositionArena;
 class Context;
 class Engine;
 class KeyEvent;
 class Schema;
+class TaskGroup;
+class ThreadPool;
+
+// A recursive mutex that counts the threads waiting to lock it, so that
+// background tasks holding it can yield to api calls.
+class SessionMutex {
+ public:
+  void lock() {
+    ++waiting_;
+    mutex_.lock();
+    --waiting_;
+  }
+  bool try_lock() { return mutex_.try_lock(); }
+  void unlock() { mutex_.unlock(); }
+  bool contended() const { return waiting_ > 0; }
+
+ private:
+  std::recursive_mutex mutex_;
+  std::atomic<int> waiting_{0};
+};
 
 class Session {
  public:
   static const int kLifeSpan = 5 * 60;  // seconds
 
-  Session();
+  explicit Session(SessionId session_id);
   bool ProcessKey(const KeyEvent& key_event);
   void Activate();
   void ResetCommitText();
@@ -42,14 +64,20 @@ class Session {
 
   Context* context() const;
   Schema* schema() const;
+  CompositionArena* arena() const;
   time_t last_active_time() const { return last_active_time_; }
   const string& commit_text() const { return commit_text_; }
+  // held by api calls operating on the session
+  SessionMutex& mutex() { return mutex_; }
 
  private:
   void OnCommit(const string& commit_text);
 
+  SessionMutex mutex_;
   the<Engine> engine_;
-  time_t last_active_time_ = 0;
+  // written by api calls holding only the session mutex, and read by
+  // CleanupStaleSessions() holding only the shard lock
+  std::atomic<time_t> last_active_time_{0};
   string commit_text_;
 };
 
@@ -69,12 +97,19 @@ class Service {
   void CleanupStaleSessions();
   void CleanupAllSessions();
 
+  // loads and pins resources required by the schema in advance
+  bool PreloadSchema(const string& schema_id);
+
   void SetNotificationHandler(const NotificationHandler& handler);
   void ClearNotificationHandler();
   void Notify(SessionId session_id,
               const string& message_type,
               const string& message_value);
 
+  // runs a task on a background worker, with the session locked;
+  // the task is dropped if the session is gone by then.
+  void PostTask(SessionId session_id, function<void ()> task);
+
   ResourceResolver* CreateResourceResolver(const ResourceType& type);
   ResourceResolver* CreateUserSpecificResourceResolver(const ResourceType& type);
 
@@ -87,11 +122,29 @@ class Service {
   Service();
 
   using SessionMap = map<SessionId, an<Session>>;
-  SessionMap sessions_;
+  // sessions are distributed over shards, each guarded by its own lock
+  struct SessionShard {
+    std::mutex mutex;
+    SessionMap sessions;
+  };
+  static const size_t kNumSessionShards = 16;
+  SessionShard& shard(SessionId session_id);
+  an<Session> FindSession(SessionId session_id);
+  void StopWorkers();
+
+  SessionShard session_shards_[kNumSessionShards];
+  // ids are never reused, so that a stale id cannot reach a new session
+  std::atomic<SessionId> last_session_id_{kInvalidSessionId};
   Deployer deployer_;
   NotificationHandler notification_handler_;
   std::mutex mutex_;
-  bool started_ = false;
+  std::atomic<bool> started_{false};
+
+  // background tasks run on a few workers of their own, as they block on
+  // session locks and must not be run by threads waiting on the shared pool
+  the<ThreadPool> task_pool_;
+  the<TaskGroup> tasks_;
+  std::atomic<bool> stopping_{false};
 };
 
 }  // namespace rime
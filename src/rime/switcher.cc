@@ -20,6 +20,8 @@
 
 namespace rime {
 
+static const TagId kPagingTag = TagRegistry::Intern("paging");
+
 Switcher::Switcher(const Ticket& ticket) : Processor(ticket) {
   context_->set_option("dumb", true);  // not going to commit anything
 
@@ -104,7 +106,7 @@ void Switcher::HighlightNextSchema() {
   }
   while (!option || option->type() != "schema");
   seg.selected_index = index;
-  seg.tags.insert("paging");
+  seg.tags.insert(kPagingTag);
   return;
 }
 
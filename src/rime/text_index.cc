@@ -0,0 +1,47 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+#include <rime/text_index.h>
+
+namespace rime {
+
+static const size_t kInitialCapacity = 16;  // a power of 2
+
+void TextIndex::Add(const string& text, int value) {
+  // keep the table at most half full
+  if ((size_ + 1) * 2 > slots_.size()) {
+    Grow();
+  }
+  size_t fingerprint = Fingerprint(text);
+  size_t mask = slots_.size() - 1;
+  size_t i = fingerprint & mask;
+  while (slots_[i].value >= 0) {
+    i = (i + 1) & mask;
+  }
+  slots_[i].fingerprint = fingerprint;
+  slots_[i].value = value;
+  ++size_;
+}
+
+void TextIndex::Clear() {
+  slots_.clear();
+  size_ = 0;
+}
+
+void TextIndex::Grow() {
+  vector<Slot> slots(slots_.empty() ? kInitialCapacity : slots_.size() * 2);
+  size_t mask = slots.size() - 1;
+  for (const Slot& slot : slots_) {
+    if (slot.value < 0)
+      continue;
+    size_t i = slot.fingerprint & mask;
+    while (slots[i].value >= 0) {
+      i = (i + 1) & mask;
+    }
+    slots[i] = slot;
+  }
+  slots_.swap(slots);
+}
+
+}  // namespace rime
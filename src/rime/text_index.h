@@ -0,0 +1,63 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+#ifndef RIME_TEXT_INDEX_H_
+#define RIME_TEXT_INDEX_H_
+
+#include <rime_api.h>
+#include <rime/common.h>
+
+namespace rime {
+
+// Finds texts by value, eg. the position of a candidate in a list, without
+// keeping copies of them. Texts are hashed into an open addressing table
+// of fingerprints; on a fingerprint match, the text the value refers to is
+// compared to rule out a collision.
+class TextIndex {
+ public:
+  // returns the value of an indexed text equal to text, or -1.
+  // text_of(value) gives the text a value refers to.
+  template <class TextOf>
+  int Find(const string& text, TextOf text_of) const;
+  // indexes text, which is not in the index yet, by a non-negative value.
+  RIME_API void Add(const string& text, int value);
+  RIME_API void Clear();
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+ private:
+  struct Slot {
+    size_t fingerprint = 0;
+    int value = -1;
+  };
+
+  static size_t Fingerprint(const string& text) {
+    return std::hash<string>()(text);
+  }
+  void Grow();
+
+  vector<Slot> slots_;
+  size_t size_ = 0;
+};
+
+template <class TextOf>
+int TextIndex::Find(const string& text, TextOf text_of) const {
+  if (slots_.empty())
+    return -1;
+  size_t fingerprint = Fingerprint(text);
+  size_t mask = slots_.size() - 1;
+  for (size_t i = fingerprint & mask; slots_[i].value >= 0;
+       i = (i + 1) & mask) {
+    if (slots_[i].fingerprint == fingerprint &&
+        text_of(slots_[i].value) == text) {
+      return slots_[i].value;
+    }
+  }
+  return -1;
+}
+
+}  // namespace rime
+
+#endif  // RIME_TEXT_INDEX_H_
@@ -0,0 +1,148 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+#include <algorithm>
+#include <boost/scope_exit.hpp>
+#include <rime/thread_pool.h>
+
+namespace rime {
+
+static const size_t kMaxSharedWorkers = 4;
+
+ThreadPool::ThreadPool(size_t num_workers) {
+  for (size_t i = 0; i < (std::max)(num_workers, size_t(1)); ++i) {
+    queues_.emplace_back(new Queue);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(idle_mutex_);
+    stopping_ = true;
+  }
+  work_available_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+ThreadPool& ThreadPool::instance() {
+  static ThreadPool pool((std::min)(
+      size_t(std::thread::hardware_concurrency()), kMaxSharedWorkers));
+  return pool;
+}
+
+void ThreadPool::Start() {
+  for (size_t i = 0; i < queues_.size(); ++i) {
+    workers_.emplace_back(&ThreadPool::Work, this, i);
+  }
+}
+
+void ThreadPool::Submit(Item item) {
+  std::call_once(started_, &ThreadPool::Start, this);
+  {
+    // counted before it is queued so that the count never goes negative
+    std::lock_guard<std::mutex> lock(idle_mutex_);
+    ++num_queued_;
+  }
+  Queue& queue(*queues_[next_queue_++ % queues_.size()]);
+  {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.items.push_back(std::move(item));
+  }
+  work_available_.notify_one();
+}
+
+bool ThreadPool::Queue::Take(TaskGroup* group, bool from_back, Item* item) {
+  if (items.empty())
+    return false;
+  if (!group) {
+    if (from_back) {
+      *item = std::move(items.back());
+      items.pop_back();
+    }
+    else {
+      *item = std::move(items.front());
+      items.pop_front();
+    }
+    return true;
+  }
+  auto found = std::find_if(items.begin(), items.end(),
+                            [group](const Item& x) {
+                              return x.group == group;
+                            });
+  if (found == items.end())
+    return false;
+  *item = std::move(*found);
+  items.erase(found);
+  return true;
+}
+
+bool ThreadPool::RunOne(size_t worker, TaskGroup* group) {
+  Item item;
+  bool found = false;
+  size_t n = queues_.size();
+  if (worker < n) {
+    Queue& own(*queues_[worker]);
+    std::lock_guard<std::mutex> lock(own.mutex);
+    found = own.Take(group, false, &item);
+  }
+  for (size_t i = 1; !found && i <= n; ++i) {
+    Queue& other(*queues_[(worker + i) % n]);
+    std::lock_guard<std::mutex> lock(other.mutex);
+    found = other.Take(group, true, &item);
+  }
+  if (!found)
+    return false;
+  --num_queued_;
+  TaskGroup* item_group = item.group;
+  // a task that throws is done all the same, or its group waits forever
+  BOOST_SCOPE_EXIT( (item_group) ) {
+    item_group->Done();
+  }
+  BOOST_SCOPE_EXIT_END
+  item.task();
+  return true;
+}
+
+void ThreadPool::Work(size_t worker) {
+  while (true) {
+    if (RunOne(worker))
+      continue;
+    std::unique_lock<std::mutex> lock(idle_mutex_);
+    work_available_.wait(lock, [this] {
+      return stopping_ || num_queued_ > 0;
+    });
+    if (stopping_ && num_queued_ == 0)
+      return;
+  }
+}
+
+void TaskGroup::Run(ThreadPool::Task task) {
+  ++pending_;
+  pool_->Submit(ThreadPool::Item{std::move(task), this});
+}
+
+void TaskGroup::Done() {
+  // the waiting thread may destroy the group as soon as it is unlocked
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (--pending_ == 0)
+    all_done_.notify_all();
+}
+
+void TaskGroup::Wait() {
+  while (pending_ > 0) {
+    // help out rather than block. tasks of other groups, eg. a batch of a
+    // dict compiler, are not taken, lest they hold up the waiting thread
+    if (pool_->RunOne(pool_->num_workers(), this))
+      continue;
+    // the remaining tasks are running on workers
+    std::unique_lock<std::mutex> lock(mutex_);
+    all_done_.wait(lock, [this] { return pending_ == 0; });
+  }
+  // wait for Done() to release the lock
+  std::lock_guard<std::mutex> lock(mutex_);
+}
+
+}  // namespace rime
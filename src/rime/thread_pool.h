@@ -0,0 +1,97 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+#ifndef RIME_THREAD_POOL_H_
+#define RIME_THREAD_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <rime_api.h>
+#include <rime/common.h>
+
+namespace rime {
+
+class TaskGroup;
+
+// A fixed number of worker threads, each with a queue of its own. A worker
+// takes tasks from the front of its queue, and when that is empty, steals
+// from the back of the others'. Workers are started on first use.
+class ThreadPool {
+ public:
+  using Task = function<void ()>;
+
+  RIME_API explicit ThreadPool(size_t num_workers);
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator= (const ThreadPool&) = delete;
+  RIME_API ~ThreadPool();
+
+  size_t num_workers() const { return queues_.size(); }
+
+  // shared by all engines; bounded by the number of cores
+  RIME_API static ThreadPool& instance();
+
+ private:
+  friend class TaskGroup;
+
+  struct Item {
+    Task task;
+    TaskGroup* group;
+  };
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Item> items;
+
+    // takes an item of the group, or any item if group is null
+    bool Take(TaskGroup* group, bool from_back, Item* item);
+  };
+
+  void Submit(Item item);
+  // runs one queued task, of the group if given, trying the queue of
+  // worker first
+  bool RunOne(size_t worker, TaskGroup* group = nullptr);
+  void Work(size_t worker);
+  void Start();
+
+  vector<the<Queue>> queues_;
+  vector<std::thread> workers_;
+  std::once_flag started_;
+  std::atomic<size_t> next_queue_{0};
+  // wakes up idle workers
+  std::mutex idle_mutex_;
+  std::condition_variable work_available_;
+  std::atomic<size_t> num_queued_{0};
+  bool stopping_ = false;
+};
+
+// Tasks run on a pool and waited for together.
+class TaskGroup {
+ public:
+  explicit TaskGroup(ThreadPool* pool) : pool_(pool) {}
+  TaskGroup(const TaskGroup&) = delete;
+  TaskGroup& operator= (const TaskGroup&) = delete;
+  ~TaskGroup() { Wait(); }
+
+  RIME_API void Run(ThreadPool::Task task);
+  // returns when all tasks of the group are done, running its queued tasks
+  // on the calling thread meanwhile, so it is safe to wait on a worker
+  // thread. tasks of other groups are left to the workers.
+  RIME_API void Wait();
+
+ private:
+  friend class ThreadPool;
+
+  void Done();
+
+  ThreadPool* pool_;
+  std::atomic<size_t> pending_{0};
+  std::mutex mutex_;
+  std::condition_variable all_done_;
+};
+
+}  // namespace rime
+
+#endif  // RIME_THREAD_POOL_H_
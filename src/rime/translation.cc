@@ -210,7 +210,9 @@ DistinctTranslation::DistinctTranslation(an<Translation> translation)
 bool DistinctTranslation::Next() {
   if (exhausted())
     return false;
-  candidate_set_.insert(Peek()->text());
+  auto candidate = Peek();
+  passed_index_.Add(candidate->text(), static_cast<int>(passed_.size()));
+  passed_.push_back(candidate);
   do {
     CacheTranslation::Next();
   }
@@ -220,7 +222,9 @@ bool DistinctTranslation::Next() {
 }
 
 bool DistinctTranslation::AlreadyHas(const string& text) const {
-  return candidate_set_.find(text) != candidate_set_.end();
+  return passed_index_.Find(text, [this](int i) -> const string& {
+    return passed_[i]->text();
+  }) >= 0;
 }
 
 // PrefetchTranslation
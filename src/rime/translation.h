@@ -11,6 +11,7 @@
 #include <rime_api.h>
 #include <rime/candidate.h>
 #include <rime/common.h>
+#include <rime/text_index.h>
 
 namespace rime {
 
@@ -130,7 +131,9 @@ class DistinctTranslation : public CacheTranslation {
  protected:
   bool AlreadyHas(const string& text) const;
 
-  set<string> candidate_set_;
+  // candidates passed so far, indexed by text
+  CandidateList passed_;
+  TextIndex passed_index_;
 };
 
 class PrefetchTranslation : public Translation {
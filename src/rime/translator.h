@@ -28,6 +28,11 @@ class Translator : public Class<Translator, const Ticket&> {
   virtual an<Translation> Query(const string& input,
                                         const Segment& segment) = 0;
 
+  // whether Query() may run on another thread, concurrently with the
+  // queries of other parallel safe translators of the engine.
+  // translators that share state, eg. a user dictionary, should not.
+  virtual bool parallel_safe() const { return false; }
+
  protected:
   Engine* engine_;
   string name_space_;
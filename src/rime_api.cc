@@ -7,6 +7,7 @@
 #include <cstring>
 #include <sstream>
 #include <boost/format.hpp>
+#include <rime/arena.h>
 #include <rime/common.h>
 #include <rime/composition.h>
 #include <rime/config.h>
@@ -43,6 +44,10 @@ static void setup_deployer(RimeTraits *traits)
     deployer.distribution_code_name = traits->distribution_code_name;
   if (PROVIDED(traits, distribution_version))
     deployer.distribution_version = traits->distribution_version;
+  if (RIME_STRUCT_HAS_MEMBER(*traits, traits->resource_cache_size))
+    deployer.resource_cache_size = traits->resource_cache_size;
+  if (PROVIDED(traits, mapped_file_policy))
+    deployer.mapped_file_policy = traits->mapped_file_policy;
 }
 
 RIME_API void RimeSetupLogging(const char *app_name)
@@ -187,6 +192,13 @@ RIME_API Bool RimeDeploySchema(const char *schema_file)
   return Bool(deployer.RunTask("schema_update", string(schema_file)));
 }
 
+RIME_API Bool RimePreloadSchema(const char *schema_id)
+{
+  if (!schema_id)
+    return False;
+  return Bool(Service::instance().PreloadSchema(schema_id));
+}
+
 RIME_API Bool RimeDeployConfigFile(const char *file_name,
                                    const char *version_key)
 {
@@ -239,6 +251,7 @@ RIME_API Bool RimeProcessKey(RimeSessionId session_id, int keycode, int mask)
   an<Session> session(Service::instance().GetSession(session_id));
   if (!session)
     return False;
+  std::lock_guard<SessionMutex> lock(session->mutex());
   return Bool(session->ProcessKey(KeyEvent(keycode, mask)));
 }
 
@@ -247,6 +260,7 @@ RIME_API Bool RimeCommitComposition(RimeSessionId session_id)
   an<Session> session(Service::instance().GetSession(session_id));
   if (!session)
     return False;
+  std::lock_guard<SessionMutex> lock(session->mutex());
   return Bool(session->CommitComposition());
 }
 
@@ -255,6 +269,7 @@ RIME_API void RimeClearComposition(RimeSessionId session_id)
   an<Session> session(Service::instance().GetSession(session_id));
   if (!session)
     return;
+  std::lock_guard<SessionMutex> lock(session->mutex());
   session->ClearComposition();
 }
 
@@ -264,7 +279,7 @@ static void rime_candidate_copy(RimeCandidate *dest, const an<Candidate> &src)
 {
   dest->text = new char[src->text().length() + 1];
   std::strcpy(dest->text, src->text().c_str());
-  string comment(src->comment());
+  const string& comment(src->comment());
   if (!comment.empty())
   {
     dest->comment = new char[comment.length() + 1];
@@ -285,9 +300,12 @@ RIME_API Bool RimeGetContext(RimeSessionId session_id, RimeContext *context)
   an<Session> session(Service::instance().GetSession(session_id));
   if (!session)
     return False;
+  std::lock_guard<SessionMutex> lock(session->mutex());
   Context *ctx = session->context();
   if (!ctx)
     return False;
+  // candidates are fetched lazily as the menu is prepared
+  ArenaScope arena_scope(session->arena());
   if (ctx->IsComposing())
   {
     Preedit preedit = ctx->GetPreedit();
@@ -386,6 +404,248 @@ RIME_API Bool RimeFreeContext(RimeContext *context)
   return True;
 }
 
+namespace {
+
+// strings referred to by a context snapshot, reused between updates
+struct ContextSnapshotStorage
+{
+  string preedit;
+  string commit_text_preview;
+  // candidates shown on the current page; they keep at most page_size
+  // arena blocks until the next snapshot
+  Page page;
+  // scratch page to compare with
+  Page next_page;
+  vector<string> texts;
+  vector<string> comments;
+  vector<RimeCandidate> candidates;
+  string schema_id;
+  int page_size = 0;
+  string select_keys;
+  // the config item the labels were read from; replaced when the schema
+  // config is reloaded or the item is set anew
+  an<ConfigList> select_labels_source;
+  vector<string> select_labels;
+  vector<char *> select_label_ptrs;
+};
+
+} // namespace
+
+// returns true if dest has changed
+static bool rime_snapshot_update(string *dest, const string &src)
+{
+  if (*dest == src)
+    return false;
+  dest->assign(src);
+  return true;
+}
+
+static char *rime_snapshot_text(const string &text)
+{
+  return const_cast<char *>(text.c_str());
+}
+
+static bool rime_snapshot_same_page(const Page &a, const Page &b)
+{
+  // candidates are kept alive by the page, so their addresses identify them
+  return a.page_size == b.page_size &&
+         a.page_no == b.page_no &&
+         a.is_last_page == b.is_last_page &&
+         a.candidates == b.candidates;
+}
+
+static void rime_snapshot_copy_page(ContextSnapshotStorage *storage,
+                                    RimeMenu *menu)
+{
+  const CandidateList &page_candidates(storage->page.candidates);
+  size_t n = page_candidates.size();
+  storage->texts.resize(n);
+  storage->comments.resize(n);
+  storage->candidates.resize(n);
+  for (size_t i = 0; i < n; ++i)
+  {
+    const an<Candidate> &cand(page_candidates[i]);
+    storage->texts[i].assign(cand->text());
+    storage->comments[i].assign(cand->comment());
+    RimeCandidate &dest(storage->candidates[i]);
+    dest.text = rime_snapshot_text(storage->texts[i]);
+    dest.comment = storage->comments[i].empty()
+                       ? nullptr
+                       : rime_snapshot_text(storage->comments[i]);
+    dest.reserved = nullptr;
+  }
+  menu->num_candidates = static_cast<int>(n);
+  menu->candidates = n > 0 ? storage->candidates.data() : nullptr;
+}
+
+// returns true if select keys or labels have changed
+static bool rime_snapshot_update_select_labels(ContextSnapshotStorage *storage,
+                                               Schema *schema,
+                                               int page_size)
+{
+  if (!schema)
+  {
+    bool changed = !storage->schema_id.empty();
+    storage->schema_id.clear();
+    storage->select_keys.clear();
+    storage->select_labels_source.reset();
+    storage->select_labels.clear();
+    storage->select_label_ptrs.clear();
+    return changed;
+  }
+  an<ConfigList> select_labels =
+      schema->config()
+          ? schema->config()->GetList("menu/alternative_select_labels")
+          : nullptr;
+  if (schema->schema_id() == storage->schema_id &&
+      page_size == storage->page_size &&
+      schema->select_keys() == storage->select_keys &&
+      select_labels == storage->select_labels_source)
+    return false;
+  storage->schema_id = schema->schema_id();
+  storage->page_size = page_size;
+  storage->select_keys = schema->select_keys();
+  storage->select_labels_source = select_labels;
+  storage->select_labels.clear();
+  if (select_labels && (size_t)page_size <= select_labels->size())
+  {
+    for (size_t i = 0; i < (size_t)page_size; ++i)
+    {
+      an<ConfigValue> value = select_labels->GetValueAt(i);
+      storage->select_labels.push_back(value ? value->str() : string());
+    }
+  }
+  storage->select_label_ptrs.clear();
+  for (const string &label : storage->select_labels)
+  {
+    storage->select_label_ptrs.push_back(rime_snapshot_text(label));
+  }
+  return true;
+}
+
+RIME_API Bool RimeGetContextSnapshot(RimeSessionId session_id,
+                                     RimeContextSnapshot *snapshot)
+{
+  if (!snapshot || snapshot->data_size <= 0)
+    return False;
+  an<Session> session(Service::instance().GetSession(session_id));
+  if (!session)
+    return False;
+  std::lock_guard<SessionMutex> lock(session->mutex());
+  Context *ctx = session->context();
+  if (!ctx)
+    return False;
+  // candidates are fetched lazily as the menu is prepared
+  ArenaScope arena_scope(session->arena());
+  auto storage = static_cast<ContextSnapshotStorage *>(snapshot->storage);
+  if (!storage)
+  {
+    storage = new ContextSnapshotStorage;
+    snapshot->storage = storage;
+  }
+  int changes = 0;
+
+  RimeComposition &composition(snapshot->composition);
+  if (ctx->IsComposing())
+  {
+    Preedit preedit = ctx->GetPreedit();
+    if (rime_snapshot_update(&storage->preedit, preedit.text) ||
+        !composition.preedit ||
+        composition.cursor_pos != (int)preedit.caret_pos ||
+        composition.sel_start != (int)preedit.sel_start ||
+        composition.sel_end != (int)preedit.sel_end)
+    {
+      changes |= RIME_CONTEXT_COMPOSITION_CHANGED;
+    }
+    composition.length = storage->preedit.length();
+    composition.preedit = rime_snapshot_text(storage->preedit);
+    composition.cursor_pos = preedit.caret_pos;
+    composition.sel_start = preedit.sel_start;
+    composition.sel_end = preedit.sel_end;
+    if (rime_snapshot_update(&storage->commit_text_preview,
+                             ctx->GetCommitText()))
+    {
+      changes |= RIME_CONTEXT_COMMIT_TEXT_PREVIEW_CHANGED;
+    }
+  }
+  else
+  {
+    if (composition.preedit)
+      changes |= RIME_CONTEXT_COMPOSITION_CHANGED;
+    composition = RimeComposition();
+    storage->preedit.clear();
+    if (!storage->commit_text_preview.empty())
+    {
+      changes |= RIME_CONTEXT_COMMIT_TEXT_PREVIEW_CHANGED;
+      storage->commit_text_preview.clear();
+    }
+  }
+  snapshot->commit_text_preview =
+      storage->commit_text_preview.empty()
+          ? nullptr
+          : rime_snapshot_text(storage->commit_text_preview);
+
+  RimeMenu &menu(snapshot->menu);
+  Page &next_page(storage->next_page);
+  next_page.candidates.clear();
+  int highlighted = 0;
+  if (ctx->HasMenu())
+  {
+    Segment &seg(ctx->composition().back());
+    int page_size = 5;
+    Schema *schema = session->schema();
+    if (schema)
+      page_size = schema->page_size();
+    int selected_index = seg.selected_index;
+    int page_no = selected_index / page_size;
+    if (seg.menu->FillPage(page_size, page_no, &next_page))
+    {
+      highlighted = selected_index % page_size;
+      if (rime_snapshot_update_select_labels(storage, schema, page_size))
+        changes |= RIME_CONTEXT_MENU_CHANGED;
+    }
+  }
+  if (next_page.candidates.empty())
+  {
+    next_page.page_size = 0;
+    next_page.page_no = 0;
+    next_page.is_last_page = false;
+  }
+  if (!rime_snapshot_same_page(next_page, storage->page))
+  {
+    changes |= RIME_CONTEXT_MENU_CHANGED;
+    std::swap(storage->page, next_page);
+    rime_snapshot_copy_page(storage, &menu);
+    menu.page_size = storage->page.page_size;
+    menu.page_no = storage->page.page_no;
+    menu.is_last_page = Bool(storage->page.is_last_page);
+  }
+  // drop references to candidates no longer shown
+  next_page.candidates.clear();
+  if (menu.highlighted_candidate_index != highlighted)
+  {
+    changes |= RIME_CONTEXT_HIGHLIGHT_CHANGED;
+    menu.highlighted_candidate_index = highlighted;
+  }
+  bool has_menu = menu.num_candidates > 0;
+  menu.select_keys = has_menu && !storage->select_keys.empty()
+                         ? rime_snapshot_text(storage->select_keys)
+                         : nullptr;
+  snapshot->select_labels = has_menu && !storage->select_label_ptrs.empty()
+                                ? storage->select_label_ptrs.data()
+                                : nullptr;
+  snapshot->changes = changes;
+  return True;
+}
+
+RIME_API void RimeFreeContextSnapshot(RimeContextSnapshot *snapshot)
+{
+  if (!snapshot || snapshot->data_size <= 0)
+    return;
+  delete static_cast<ContextSnapshotStorage *>(snapshot->storage);
+  RIME_STRUCT_CLEAR(*snapshot);
+}
+
 RIME_API Bool RimeGetCommit(RimeSessionId session_id, RimeCommit *commit)
 {
   if (!commit)
@@ -394,6 +654,7 @@ RIME_API Bool RimeGetCommit(RimeSessionId session_id, RimeCommit *commit)
   an<Session> session(Service::instance().GetSession(session_id));
   if (!session)
     return False;
+  std::lock_guard<SessionMutex> lock(session->mutex());
   const string &commit_text(session->commit_text());
   if (!commit_text.empty())
   {
@@ -422,6 +683,7 @@ RIME_API Bool RimeGetStatus(RimeSessionId session_id, RimeStatus *status)
   an<Session> session(Service::instance().GetSession(session_id));
   if (!session)
     return False;
+  std::lock_guard<SessionMutex> lock(session->mutex());
   Schema *schema = session->schema();
   Context *ctx = session->context();
   if (!schema || !ctx)
@@ -452,6 +714,18 @@ RIME_API Bool RimeFreeStatus(RimeStatus *status)
 
 // Accessing candidate list
 
+namespace {
+
+// what RimeCandidateListIterator::ptr points to between Begin and End.
+// Next() locks the session, and stops once the session is gone or its
+// current menu is no longer the one the iteration started on.
+struct CandidateListState {
+  weak<Session> session;
+  an<Menu> menu;
+};
+
+}  // namespace
+
 RIME_API Bool RimeCandidateListFromIndex(RimeSessionId session_id,
                                          RimeCandidateListIterator *iterator,
                                          int index)
@@ -461,11 +735,13 @@ RIME_API Bool RimeCandidateListFromIndex(RimeSessionId session_id,
   an<Session> session(Service::instance().GetSession(session_id));
   if (!session)
     return False;
+  std::lock_guard<SessionMutex> lock(session->mutex());
   Context *ctx = session->context();
   if (!ctx || !ctx->HasMenu())
     return False;
   memset(iterator, 0, sizeof(RimeCandidateListIterator));
-  iterator->ptr = ctx->composition().back().menu.get();
+  iterator->ptr = new CandidateListState{session,
+                                         ctx->composition().back().menu};
   iterator->index = index - 1;
   return True;
 }
@@ -480,11 +756,19 @@ RIME_API Bool RimeCandidateListNext(RimeCandidateListIterator *iterator)
 {
   if (!iterator)
     return False;
-  Menu *menu = reinterpret_cast<Menu *>(iterator->ptr);
-  if (!menu)
+  auto state = reinterpret_cast<CandidateListState *>(iterator->ptr);
+  if (!state)
+    return False;
+  an<Session> session = state->session.lock();
+  if (!session)
+    return False;
+  std::lock_guard<SessionMutex> lock(session->mutex());
+  Context *ctx = session->context();
+  if (!ctx || !ctx->HasMenu() ||
+      ctx->composition().back().menu != state->menu)
     return False;
   ++iterator->index;
-  if (auto cand = menu->GetCandidateAt((size_t)iterator->index))
+  if (auto cand = state->menu->GetCandidateAt((size_t)iterator->index))
   {
     delete[] iterator->candidate.text;
     delete[] iterator->candidate.comment;
@@ -498,6 +782,7 @@ RIME_API void RimeCandidateListEnd(RimeCandidateListIterator *iterator)
 {
   if (!iterator)
     return;
+  delete reinterpret_cast<CandidateListState *>(iterator->ptr);
   delete[] iterator->candidate.text;
   delete[] iterator->candidate.comment;
   memset(iterator, 0, sizeof(RimeCandidateListIterator));
@@ -510,6 +795,7 @@ RIME_API void RimeSetOption(RimeSessionId session_id, const char *option, Bool v
   an<Session> session(Service::instance().GetSession(session_id));
   if (!session)
     return;
+  std::lock_guard<SessionMutex> lock(session->mutex());
   Context *ctx = session->context();
   if (!ctx)
     return;
@@ -521,6 +807,7 @@ RIME_API Bool RimeGetOption(RimeSessionId session_id, const char *option)
   an<Session> session(Service::instance().GetSession(session_id));
   if (!session)
     return False;
+  std::lock_guard<SessionMutex> lock(session->mutex());
   Context *ctx = session->context();
   if (!ctx)
     return False;
@@ -532,6 +819,7 @@ RIME_API void RimeSetProperty(RimeSessionId session_id, const char *prop, const
   an<Session> session(Service::instance().GetSession(session_id));
   if (!session)
     return;
+  std::lock_guard<SessionMutex> lock(session->mutex());
   Context *ctx = session->context();
   if (!ctx)
     return;
@@ -544,6 +832,7 @@ RIME_API Bool RimeGetProperty(RimeSessionId session_id, const char *prop,
   an<Session> session(Service::instance().GetSession(session_id));
   if (!session)
     return False;
+  std::lock_guard<SessionMutex> lock(session->mutex());
   Context *ctx = session->context();
   if (!ctx)
     return False;
@@ -617,6 +906,7 @@ RIME_API Bool RimeGetCurrentSchema(RimeSessionId session_id, char *schema_id, si
   an<Session> session(Service::instance().GetSession(session_id));
   if (!session)
     return False;
+  std::lock_guard<SessionMutex> lock(session->mutex());
   Schema *schema = session->schema();
   if (!schema)
     return False;
@@ -631,6 +921,7 @@ RIME_API Bool RimeSelectSchema(RimeSessionId session_id, const char *schema_id)
   an<Session> session(Service::instance().GetSession(session_id));
   if (!session)
     return False;
+  std::lock_guard<SessionMutex> lock(session->mutex());
   session->ApplySchema(new Schema(schema_id));
   return True;
 }
@@ -868,6 +1159,7 @@ RIME_API Bool RimeSimulateKeySequence(RimeSessionId session_id, const char *key_
   an<Session> session(Service::instance().GetSession(session_id));
   if (!session)
     return False;
+  std::lock_guard<SessionMutex> lock(session->mutex());
   KeySequence keys;
   if (!keys.Parse(key_sequence))
   {
@@ -1078,6 +1370,7 @@ const char *RimeGetInput(RimeSessionId session_id)
   an<Session> session(Service::instance().GetSession(session_id));
   if (!session)
     return NULL;
+  std::lock_guard<SessionMutex> lock(session->mutex());
   Context *ctx = session->context();
   if (!ctx)
     return NULL;
@@ -1089,6 +1382,7 @@ size_t RimeGetCaretPos(RimeSessionId session_id)
   an<Session> session(Service::instance().GetSession(session_id));
   if (!session)
     return 0;
+  std::lock_guard<SessionMutex> lock(session->mutex());
   Context *ctx = session->context();
   if (!ctx)
     return 0;
@@ -1100,6 +1394,7 @@ Bool RimeSelectCandidate(RimeSessionId session_id, size_t index)
   an<Session> session(Service::instance().GetSession(session_id));
   if (!session)
     return False;
+  std::lock_guard<SessionMutex> lock(session->mutex());
   Context *ctx = session->context();
   if (!ctx)
     return False;
@@ -1111,6 +1406,7 @@ Bool RimeSelectCandidateOnCurrentPage(RimeSessionId session_id, size_t index)
   an<Session> session(Service::instance().GetSession(session_id));
   if (!session)
     return False;
+  std::lock_guard<SessionMutex> lock(session->mutex());
   Context *ctx = session->context();
   if (!ctx || !ctx->HasMenu())
     return False;
@@ -1135,6 +1431,7 @@ void RimeSetCaretPos(RimeSessionId session_id, size_t caret_pos)
   an<Session> session(Service::instance().GetSession(session_id));
   if (!session)
     return;
+  std::lock_guard<SessionMutex> lock(session->mutex());
   Context *ctx = session->context();
   if (!ctx)
     return;
@@ -1227,6 +1524,9 @@ RIME_API RimeApi *rime_get_api()
     s_api.candidate_list_next = &RimeCandidateListNext;
     s_api.candidate_list_end = &RimeCandidateListEnd;
     s_api.candidate_list_from_index = &RimeCandidateListFromIndex;
+    s_api.preload_schema = &RimePreloadSchema;
+    s_api.get_context_snapshot = &RimeGetContextSnapshot;
+    s_api.free_context_snapshot = &RimeFreeContextSnapshot;
   }
   return &s_api;
 }
@@ -87,6 +87,15 @@ typedef struct rime_traits_t {
    *  Value is passed to Glog library using FLAGS_log_dir variable.
    */
   const char* log_dir;
+  /*! Bytes of memory mapped dictionaries to keep loaded after no session
+   *  uses them, so that switching back does not reload them.
+   *  0 (default) releases them at once. See also preload_schema.
+   */
+  size_t resource_cache_size;
+  /*! Hints for loading memory mapped dictionaries, separated by spaces:
+   *  prefetch, random_access, lock_memory.
+   */
+  const char* mapped_file_policy;
 } RimeTraits;
 
 typedef struct {
@@ -135,6 +144,30 @@ typedef struct rime_context_t {
   char** select_labels;
 } RimeContext;
 
+//! Parts of a context snapshot that differ from the previous snapshot
+#define RIME_CONTEXT_COMPOSITION_CHANGED 0x1
+#define RIME_CONTEXT_COMMIT_TEXT_PREVIEW_CHANGED 0x2
+#define RIME_CONTEXT_MENU_CHANGED 0x4
+#define RIME_CONTEXT_HIGHLIGHT_CHANGED 0x8
+
+/*!
+ *  Updated in place by RimeGetContextSnapshot, reusing storage of the
+ *  previous snapshot. Strings are valid until the next update.
+ *  Should be initialized by calling RIME_STRUCT_INIT(Type, var);
+ *  and released by RimeFreeContextSnapshot.
+ */
+typedef struct rime_context_snapshot_t {
+  int data_size;
+  //! RIME_CONTEXT_*_CHANGED flags
+  int changes;
+  RimeComposition composition;
+  RimeMenu menu;
+  char* commit_text_preview;
+  char** select_labels;
+  //! owned by the library
+  void* storage;
+} RimeContextSnapshot;
+
 /*!
  *  Should be initialized by calling RIME_STRUCT_INIT(Type, var);
  */
@@ -212,6 +245,9 @@ RIME_API void RimeSetupLogging(const char* app_name);
  *   + session_id = 0, message_type="deploy", message_value="start"
  *   + session_id = 0, message_type="deploy", message_value="success"
  *   + session_id = 0, message_type="deploy", message_value="failure"
+ * - on candidates made in the background, eg. with async_sentence:
+ *   + message_type="candidates", message_value="sentence"
+ *   the context should be fetched again.
  *
  *   handler will be called with context_object as the first parameter
  *   every time an event occurs in librime, until RimeFinalize() is called.
@@ -238,6 +274,8 @@ RIME_API void RimeDeployerInitialize(RimeTraits *traits);
 RIME_API Bool RimePrebuildAllSchemas();
 RIME_API Bool RimeDeployWorkspace();
 RIME_API Bool RimeDeploySchema(const char *schema_file);
+//! Load resources used by a deployed schema, and keep them loaded
+RIME_API Bool RimePreloadSchema(const char *schema_id);
 RIME_API Bool RimeDeployConfigFile(const char *file_name, const char *version_key);
 
 RIME_API Bool RimeSyncUserData();
@@ -265,6 +303,10 @@ RIME_API Bool RimeGetCommit(RimeSessionId session_id, RimeCommit* commit);
 RIME_API Bool RimeFreeCommit(RimeCommit* commit);
 RIME_API Bool RimeGetContext(RimeSessionId session_id, RimeContext* context);
 RIME_API Bool RimeFreeContext(RimeContext* context);
+//! Update a snapshot of the context, copying only what has changed
+RIME_API Bool RimeGetContextSnapshot(RimeSessionId session_id,
+                                     RimeContextSnapshot* snapshot);
+RIME_API void RimeFreeContextSnapshot(RimeContextSnapshot* snapshot);
 RIME_API Bool RimeGetStatus(RimeSessionId session_id, RimeStatus* status);
 RIME_API Bool RimeFreeStatus(RimeStatus* status);
 
@@ -380,6 +422,9 @@ typedef struct rime_api_t {
    *    + session_id = 0, message_type="deploy", message_value="start"
    *    + session_id = 0, message_type="deploy", message_value="success"
    *    + session_id = 0, message_type="deploy", message_value="failure"
+   *  - on candidates made in the background, eg. with async_sentence:
+   *    + message_type="candidates", message_value="sentence"
+   *    the context should be fetched again.
    *
    *  handler will be called with context_object as the first parameter
    *  every time an event occurs in librime, until RimeFinalize() is called.
@@ -533,6 +578,15 @@ typedef struct rime_api_t {
   Bool (*candidate_list_from_index)(RimeSessionId session_id,
                                     RimeCandidateListIterator* iterator,
                                     int index);
+
+  //! Load dictionaries used by a deployed schema, and keep them loaded.
+  //! User dictionaries are not kept open, so that they can be synced.
+  Bool (*preload_schema)(const char* schema_id);
+
+  //! update a snapshot of the context, copying only what has changed
+  Bool (*get_context_snapshot)(RimeSessionId session_id,
+                               RimeContextSnapshot* snapshot);
+  void (*free_context_snapshot)(RimeContextSnapshot* snapshot);
 } RimeApi;
 
 //! API entry
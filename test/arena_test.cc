@@ -0,0 +1,93 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+#include <gtest/gtest.h>
+#include <rime/arena.h>
+#include <rime/candidate.h>
+#include <rime/gear/poet.h>
+#include <rime/gear/translator_commons.h>
+
+using namespace rime;
+
+TEST(RimeArenaTest, AllocateInScope) {
+  size_t num_blocks = CompositionArena::num_live_blocks();
+  CompositionArena arena;
+  an<Candidate> a, b;
+  {
+    ArenaScope scope(&arena);
+    a = ArenaNew<SimpleCandidate>("test", 0, 1, "alpha");
+    b = ArenaNew<SimpleCandidate>("test", 1, 2, "beta");
+  }
+  EXPECT_EQ(num_blocks + 1, CompositionArena::num_live_blocks());
+  EXPECT_EQ("alpha", a->text());
+  EXPECT_EQ("beta", b->text());
+  // allocated on the heap out of scope, or in the scope of no arena
+  auto c = ArenaNew<SimpleCandidate>("test", 2, 3, "gamma");
+  {
+    ArenaScope no_arena(nullptr);
+    auto d = ArenaNew<SimpleCandidate>("test", 3, 4, "delta");
+    EXPECT_EQ("delta", d->text());
+  }
+  EXPECT_EQ(num_blocks + 1, CompositionArena::num_live_blocks());
+}
+
+TEST(RimeArenaTest, ObjectsOutliveComposition) {
+  size_t num_blocks = CompositionArena::num_live_blocks();
+  an<Candidate> survivor;
+  {
+    CompositionArena arena;
+    ArenaScope scope(&arena);
+    for (int i = 0; i < 1000; ++i) {
+      auto cand = ArenaNew<SimpleCandidate>("test", 0, 1, "temporary");
+      if (i == 10)
+        survivor = cand;
+    }
+    arena.Reset();
+    EXPECT_EQ("temporary", survivor->text());
+  }
+  // the survivor keeps its own block, and only that
+  EXPECT_EQ(num_blocks + 1, CompositionArena::num_live_blocks());
+  EXPECT_EQ("temporary", survivor->text());
+  survivor.reset();
+  EXPECT_EQ(num_blocks, CompositionArena::num_live_blocks());
+}
+
+TEST(RimeArenaTest, NestedScopes) {
+  CompositionArena outer, inner;
+  EXPECT_EQ(nullptr, CompositionArena::current());
+  {
+    ArenaScope outer_scope(&outer);
+    EXPECT_EQ(&outer, CompositionArena::current());
+    {
+      ArenaScope inner_scope(&inner);
+      EXPECT_EQ(&inner, CompositionArena::current());
+    }
+    EXPECT_EQ(&outer, CompositionArena::current());
+  }
+  EXPECT_EQ(nullptr, CompositionArena::current());
+}
+
+TEST(RimeArenaTest, PoetStatesStayOffTheArena) {
+  Poet poet(nullptr, nullptr);
+  WordGraph graph;
+  const char* words[] = {"a", "b", "c", "d"};
+  for (int i = 0; i < 4; ++i) {
+    auto e = New<DictEntry>();
+    e->text = words[i];
+    e->weight = -1.0;
+    graph[i][i + 1].push_back(e);
+  }
+  size_t num_blocks = CompositionArena::num_live_blocks();
+  {
+    CompositionArena arena;
+    ArenaScope scope(&arena);
+    auto sentence = poet.MakeSentence(graph, 4, "");
+    ASSERT_TRUE(bool(sentence));
+    EXPECT_EQ("abcd", sentence->text());
+    // the result is a composition object, allocated from the arena
+    EXPECT_EQ(num_blocks + 1, CompositionArena::num_live_blocks());
+  }
+  // the states kept by the poet for the next call do not pin the block
+  EXPECT_EQ(num_blocks, CompositionArena::num_live_blocks());
+}
@@ -5,9 +5,13 @@
 // 2011-04-06 Zou xu <zouivex@gmail.com>
 //
 
+#include <ctime>
+#include <fstream>
+#include <boost/filesystem.hpp>
 #include <gtest/gtest.h>
 #include <rime/component.h>
 #include <rime/config.h>
+#include <rime/config/config_data.h>
 
 using namespace rime;
 
@@ -298,3 +302,129 @@ TEST(RimeConfigListKeyPathTest, Greetings) {
   EXPECT_TRUE(config->GetInt("list/@last/id", &id));
   EXPECT_EQ(6, id);
 }
+
+TEST(RimeConfigImageTest, RoundTrip) {
+  const string source_file("config_test.yaml");
+  const string image_file(ConfigData::ImageFileName("config_image_test"));
+  {
+    ConfigData data;
+    ASSERT_TRUE(data.LoadFromFile(source_file, nullptr));
+    ASSERT_TRUE(data.SaveToImage(image_file, source_file));
+  }
+  auto data = New<ConfigData>();
+  ASSERT_TRUE(data->LoadFromImage(image_file, source_file));
+  Config config(data);
+  bool bool_value = true;
+  EXPECT_TRUE(config.GetBool("terrans/tank/seiged", &bool_value));
+  EXPECT_FALSE(bool_value);
+  int int_value = 0;
+  EXPECT_TRUE(config.GetInt("terrans/supply/produced", &int_value));
+  EXPECT_EQ(0x1c, int_value);
+  EXPECT_FALSE(config.GetInt("terrans/tank/cost/time", &int_value));
+  double double_value = 0.;
+  EXPECT_TRUE(config.GetDouble("terrans/math/pi", &double_value));
+  EXPECT_DOUBLE_EQ(3.1415926, double_value);
+  string str;
+  EXPECT_TRUE(config.GetString("protoss/air_force/@2", &str));
+  EXPECT_EQ("carrier", str);
+  EXPECT_EQ(4u, config.GetListSize("protoss/air_force"));
+  EXPECT_TRUE(config.IsNull("zerg/hydralisk"));
+  EXPECT_TRUE(config.IsNull("zerg/queen/name"));
+  EXPECT_TRUE(config.GetString("/zerg/queen", &str));
+  EXPECT_EQ("Kerrigan", str);
+  // changes are visible on the paths that were indexed
+  EXPECT_TRUE(config.SetString("zerg/queen", "Abathur"));
+  EXPECT_TRUE(config.GetString("zerg/queen", &str));
+  EXPECT_EQ("Abathur", str);
+  EXPECT_TRUE(config.SetInt("zerg/zergling/lost", 0));
+  EXPECT_TRUE(config.GetInt("zerg/zergling/lost", &int_value));
+  EXPECT_EQ(0, int_value);
+  // an image is not loaded for a different source file
+  ConfigData other;
+  EXPECT_FALSE(other.LoadFromImage(image_file, "config_compiler_test.yaml"));
+}
+
+TEST(RimeConfigImageTest, FindItemsAddedInPlace) {
+  const string source_file("config_test.yaml");
+  const string image_file(ConfigData::ImageFileName("config_image_test"));
+  {
+    ConfigData data;
+    ASSERT_TRUE(data.LoadFromFile(source_file, nullptr));
+    ASSERT_TRUE(data.SaveToImage(image_file, source_file));
+  }
+  auto data = New<ConfigData>();
+  ASSERT_TRUE(data->LoadFromImage(image_file, source_file));
+  Config config(data);
+  auto zerg = config.GetMap("zerg");
+  ASSERT_TRUE(bool(zerg));
+  // not through the config, so the path index is kept
+  zerg->Set("overlord", New<ConfigValue>("flying"));
+  string str;
+  EXPECT_TRUE(config.GetString("zerg/overlord", &str));
+  EXPECT_EQ("flying", str);
+  EXPECT_TRUE(config.GetString("zerg/queen", &str));
+  EXPECT_EQ("Kerrigan", str);
+}
+
+TEST(RimeConfigImageTest, FindItemsReplacedInPlace) {
+  const string source_file("config_test.yaml");
+  const string image_file(ConfigData::ImageFileName("config_image_test"));
+  {
+    ConfigData data;
+    ASSERT_TRUE(data.LoadFromFile(source_file, nullptr));
+    ASSERT_TRUE(data.SaveToImage(image_file, source_file));
+  }
+  auto data = New<ConfigData>();
+  ASSERT_TRUE(data->LoadFromImage(image_file, source_file));
+  Config config(data);
+  auto zerg = config.GetMap("zerg");
+  ASSERT_TRUE(bool(zerg));
+  // replacing existing keys, not through the config
+  zerg->Set("queen", New<ConfigValue>("Abathur"));
+  auto zergling = New<ConfigMap>();
+  zergling->Set("lost", New<ConfigValue>("0"));
+  zerg->Set("zergling", zergling);
+  zerg->Set("lurker", nullptr);
+  string str;
+  EXPECT_TRUE(config.GetString("zerg/queen", &str));
+  EXPECT_EQ("Abathur", str);
+  int int_value = -1;
+  EXPECT_TRUE(config.GetInt("zerg/zergling/lost", &int_value));
+  EXPECT_EQ(0, int_value);
+  EXPECT_TRUE(config.IsNull("zerg/lurker/burrowed"));
+  // and a map further up the path
+  auto root = As<ConfigMap>(data->root);
+  ASSERT_TRUE(bool(root));
+  root->Set("zerg", New<ConfigMap>());
+  EXPECT_TRUE(config.IsNull("zerg/queen"));
+  EXPECT_TRUE(config.IsNull("zerg/zergling/lost"));
+}
+
+TEST(RimeConfigImageTest, OutOfDateWithSameSizeAndTime) {
+  namespace fs = boost::filesystem;
+  const string source_file("config_image_test.yaml");
+  const string image_file(ConfigData::ImageFileName(source_file));
+  {
+    std::ofstream out(source_file.c_str());
+    out << "version: 1\n";
+  }
+  ConfigData data;
+  ASSERT_TRUE(data.LoadFromFile(source_file, nullptr));
+  ASSERT_TRUE(data.SaveToImage(image_file, source_file));
+  std::time_t write_time = fs::last_write_time(source_file);
+  {
+    std::ofstream out(source_file.c_str());
+    out << "version: 2\n";
+  }
+  fs::last_write_time(source_file, write_time);
+  ConfigData stale;
+  EXPECT_FALSE(stale.LoadFromImage(image_file, source_file));
+  ASSERT_TRUE(stale.LoadFromFile(source_file, nullptr));
+  ASSERT_TRUE(stale.SaveToImage(image_file, source_file));
+  auto updated = New<ConfigData>();
+  ASSERT_TRUE(updated->LoadFromImage(image_file, source_file));
+  Config config(updated);
+  int version = 0;
+  EXPECT_TRUE(config.GetInt("version", &version));
+  EXPECT_EQ(2, version);
+}
@@ -0,0 +1,195 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+#include <sstream>
+#include <gtest/gtest.h>
+#include <rime_api.h>
+#include <rime/candidate.h>
+#include <rime/composition.h>
+#include <rime/config.h>
+#include <rime/context.h>
+#include <rime/menu.h>
+#include <rime/schema.h>
+#include <rime/service.h>
+#include <rime/translation.h>
+
+using namespace rime;
+
+static Schema* MakeSchema(const string& schema_id, const string& labels) {
+  auto config = new Config;
+  std::istringstream yaml("menu:\n  alternative_select_labels: " + labels);
+  config->LoadFromStream(yaml);
+  return new Schema(schema_id, config);
+}
+
+class RimeContextSnapshotTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    Service& service(Service::instance());
+    service.StartService();
+    session_id_ = service.CreateSession();
+    session_ = service.GetSession(session_id_);
+    ASSERT_TRUE(bool(session_));
+    session_->ApplySchema(MakeSchema("alpha", "[A, B, C, D, E]"));
+    RIME_STRUCT_INIT(RimeContextSnapshot, snapshot_);
+  }
+
+  void TearDown() override {
+    RimeFreeContextSnapshot(&snapshot_);
+    session_.reset();
+    Service::instance().DestroySession(session_id_);
+  }
+
+  // shows a menu of candidates "<input>0", "<input>1", ... for the input
+  void ShowMenu(const string& input, int num_candidates) {
+    Context* ctx = session_->context();
+    ctx->set_input(input);
+    auto translation = New<FifoTranslation>();
+    for (int i = 0; i < num_candidates; ++i) {
+      translation->Append(New<SimpleCandidate>(
+          "test", 0, input.length(), input + std::to_string(i)));
+    }
+    Segment segment(0, input.length());
+    segment.status = Segment::kGuess;
+    segment.menu = New<Menu>();
+    segment.menu->AddTranslation(translation);
+    Composition composition;
+    composition.Reset(input);
+    composition.AddSegment(segment);
+    ctx->set_composition(std::move(composition));
+  }
+
+  void Highlight(size_t index) {
+    session_->context()->composition().back().selected_index = index;
+  }
+
+  int TakeSnapshot() {
+    EXPECT_TRUE(RimeGetContextSnapshot(session_id_, &snapshot_));
+    return snapshot_.changes;
+  }
+
+  SessionId session_id_ = kInvalidSessionId;
+  an<Session> session_;
+  RimeContextSnapshot snapshot_ = {0};
+};
+
+TEST_F(RimeContextSnapshotTest, ChangeFlags) {
+  EXPECT_EQ(0, TakeSnapshot());
+  EXPECT_EQ(nullptr, snapshot_.composition.preedit);
+  EXPECT_EQ(0, snapshot_.menu.num_candidates);
+
+  ShowMenu("abc", 8);
+  EXPECT_EQ(RIME_CONTEXT_COMPOSITION_CHANGED |
+            RIME_CONTEXT_COMMIT_TEXT_PREVIEW_CHANGED |
+            RIME_CONTEXT_MENU_CHANGED,
+            TakeSnapshot());
+  EXPECT_STREQ("abc", snapshot_.composition.preedit);
+  EXPECT_STREQ("abc0", snapshot_.commit_text_preview);
+  ASSERT_EQ(5, snapshot_.menu.num_candidates);
+  EXPECT_STREQ("abc4", snapshot_.menu.candidates[4].text);
+  EXPECT_EQ(0, snapshot_.menu.page_no);
+  EXPECT_FALSE(snapshot_.menu.is_last_page);
+  EXPECT_EQ(0, snapshot_.menu.highlighted_candidate_index);
+
+  // nothing has changed
+  EXPECT_EQ(0, TakeSnapshot());
+
+  Highlight(2);
+  EXPECT_EQ(RIME_CONTEXT_COMMIT_TEXT_PREVIEW_CHANGED |
+            RIME_CONTEXT_HIGHLIGHT_CHANGED,
+            TakeSnapshot());
+  EXPECT_EQ(2, snapshot_.menu.highlighted_candidate_index);
+  EXPECT_STREQ("abc2", snapshot_.commit_text_preview);
+
+  // turning to the next page
+  Highlight(6);
+  EXPECT_EQ(RIME_CONTEXT_COMMIT_TEXT_PREVIEW_CHANGED |
+            RIME_CONTEXT_MENU_CHANGED |
+            RIME_CONTEXT_HIGHLIGHT_CHANGED,
+            TakeSnapshot());
+  EXPECT_EQ(1, snapshot_.menu.page_no);
+  EXPECT_TRUE(snapshot_.menu.is_last_page);
+  ASSERT_EQ(3, snapshot_.menu.num_candidates);
+  EXPECT_STREQ("abc5", snapshot_.menu.candidates[0].text);
+  EXPECT_EQ(1, snapshot_.menu.highlighted_candidate_index);
+
+  session_->context()->Clear();
+  EXPECT_EQ(RIME_CONTEXT_COMPOSITION_CHANGED |
+            RIME_CONTEXT_COMMIT_TEXT_PREVIEW_CHANGED |
+            RIME_CONTEXT_MENU_CHANGED |
+            RIME_CONTEXT_HIGHLIGHT_CHANGED,
+            TakeSnapshot());
+  EXPECT_EQ(nullptr, snapshot_.composition.preedit);
+  EXPECT_EQ(nullptr, snapshot_.commit_text_preview);
+  EXPECT_EQ(0, snapshot_.menu.num_candidates);
+  EXPECT_EQ(nullptr, snapshot_.menu.candidates);
+  EXPECT_EQ(nullptr, snapshot_.select_labels);
+}
+
+TEST_F(RimeContextSnapshotTest, ReuseBuffers) {
+  ShowMenu("abc", 8);
+  TakeSnapshot();
+  const char* preedit = snapshot_.composition.preedit;
+  const RimeCandidate* candidates = snapshot_.menu.candidates;
+  char** select_labels = snapshot_.select_labels;
+  ASSERT_NE(nullptr, select_labels);
+
+  // the same page of a new menu is not copied again
+  ShowMenu("abc", 8);
+  EXPECT_EQ(0, TakeSnapshot() & ~RIME_CONTEXT_MENU_CHANGED);
+  EXPECT_EQ(preedit, snapshot_.composition.preedit);
+  EXPECT_EQ(candidates, snapshot_.menu.candidates);
+  EXPECT_EQ(select_labels, snapshot_.select_labels);
+
+  Highlight(1);
+  TakeSnapshot();
+  EXPECT_EQ(preedit, snapshot_.composition.preedit);
+  EXPECT_EQ(candidates, snapshot_.menu.candidates);
+  EXPECT_EQ(select_labels, snapshot_.select_labels);
+
+  // strings are updated in place
+  ShowMenu("abd", 8);
+  EXPECT_TRUE(TakeSnapshot() & RIME_CONTEXT_COMPOSITION_CHANGED);
+  EXPECT_STREQ("abd", snapshot_.composition.preedit);
+  EXPECT_STREQ("abd0", snapshot_.menu.candidates[0].text);
+  EXPECT_EQ(candidates, snapshot_.menu.candidates);
+}
+
+TEST_F(RimeContextSnapshotTest, SelectLabelsFollowSchema) {
+  ShowMenu("abc", 3);
+  EXPECT_TRUE(TakeSnapshot() & RIME_CONTEXT_MENU_CHANGED);
+  ASSERT_NE(nullptr, snapshot_.select_labels);
+  EXPECT_STREQ("A", snapshot_.select_labels[0]);
+  EXPECT_STREQ("E", snapshot_.select_labels[4]);
+
+  // switching schemas
+  session_->ApplySchema(MakeSchema("beta", "[a, b, c, d, e]"));
+  ShowMenu("abc", 3);
+  EXPECT_TRUE(TakeSnapshot() & RIME_CONTEXT_MENU_CHANGED);
+  ASSERT_NE(nullptr, snapshot_.select_labels);
+  EXPECT_STREQ("a", snapshot_.select_labels[0]);
+
+  // reloading the schema with the same id
+  session_->ApplySchema(MakeSchema("beta", "[1, 2, 3, 4, 5]"));
+  ShowMenu("abc", 3);
+  EXPECT_TRUE(TakeSnapshot() & RIME_CONTEXT_MENU_CHANGED);
+  ASSERT_NE(nullptr, snapshot_.select_labels);
+  EXPECT_STREQ("1", snapshot_.select_labels[0]);
+
+  // updating the config in place
+  Config* config = session_->schema()->config();
+  auto labels = New<ConfigList>();
+  for (const char* label : {"i", "ii", "iii", "iv", "v"}) {
+    labels->Append(New<ConfigValue>(label));
+  }
+  config->SetItem("menu/alternative_select_labels", labels);
+  EXPECT_EQ(RIME_CONTEXT_MENU_CHANGED, TakeSnapshot());
+  ASSERT_NE(nullptr, snapshot_.select_labels);
+  EXPECT_STREQ("iv", snapshot_.select_labels[3]);
+
+  // select keys set by the schema
+  session_->schema()->set_select_keys("asdfg");
+  EXPECT_EQ(RIME_CONTEXT_MENU_CHANGED, TakeSnapshot());
+  EXPECT_STREQ("asdfg", snapshot_.menu.select_keys);
+}
@@ -154,3 +154,17 @@ TEST_F(RimeCorrectorTest, CaseMultipleEdges1) {
   ASSERT_FALSE(sp2.end() == sp2.find(syllable_id_["jue"]));
   ASSERT_TRUE(sp2[syllable_id_["jue"]].type == rime::kNormalSpelling);
 }
+
+TEST(RimeEditDistanceCorrectorTest, RestrictedDistance) {
+  rime::EditDistanceCorrector corrector("edit_distance_test.correction.bin");
+  EXPECT_EQ(0, corrector.RestrictedDistance("chang", "chang", 5));
+  // adjacent keys
+  EXPECT_EQ(1, corrector.RestrictedDistance("chang", "chsng", 5));
+  // transposition
+  EXPECT_EQ(2, corrector.RestrictedDistance("chang", "chnag", 5));
+  // insertion and deletion
+  EXPECT_EQ(2, corrector.RestrictedDistance("ju", "jue", 5));
+  EXPECT_EQ(2, corrector.RestrictedDistance("chang", "chaang", 5));
+  // gives up as soon as the threshold is exceeded
+  EXPECT_LT(1, corrector.RestrictedDistance("chang", "tuan", 1));
+}
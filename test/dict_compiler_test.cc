@@ -0,0 +1,121 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+#include <fstream>
+#include <iterator>
+#include <gtest/gtest.h>
+#include <rime/common.h>
+#include <rime/thread_pool.h>
+#include <rime/dict/dict_compiler.h>
+#include <rime/dict/dictionary.h>
+
+using namespace rime;
+
+static const char* kOutputFiles[] = {
+  "dict_compiler_test.table.bin",
+  "dict_compiler_test.prism.bin",
+  "dict_compiler_test.reverse.bin",
+};
+
+static string ReadFile(const string& file_name) {
+  std::ifstream fin(file_name.c_str(), std::ios::binary);
+  return string(std::istreambuf_iterator<char>(fin),
+                std::istreambuf_iterator<char>());
+}
+
+// writes a dict importing another, with enough phrases without codes to be
+// encoded in parallel. with_stems gives some characters a stem, and lists
+// them once more without code among the phrases, so that each becomes a
+// word with a new code after some phrases made of it have been encoded.
+static void WriteDictFiles(bool with_stems) {
+  const int kNumChars = 64;
+  const int kNumPhrases = 4000;
+  vector<string> chars;
+  for (int i = 0; i < kNumChars; ++i) {
+    // U+4E00 and on
+    int c = 0x4e00 + i;
+    string utf8;
+    utf8 += char(0xe0 | (c >> 12));
+    utf8 += char(0x80 | ((c >> 6) & 0x3f));
+    utf8 += char(0x80 | (c & 0x3f));
+    chars.push_back(utf8);
+  }
+  std::ofstream main_dict("dict_compiler_test.dict.yaml");
+  main_dict << "---\n"
+            << "name: dict_compiler_test\n"
+            << "version: \"1.0\"\n"
+            << "sort: by_weight\n";
+  if (with_stems) {
+    main_dict << "columns:\n"
+              << "  - text\n"
+              << "  - code\n"
+              << "  - weight\n"
+              << "  - stem\n";
+  }
+  main_dict << "import_tables:\n"
+            << "  - dict_compiler_test_phrases\n"
+            << "...\n\n";
+  for (int i = 0; i < kNumChars; ++i) {
+    main_dict << chars[i] << "\ts" << i % 40 << "\t" << 100 + i;
+    if (with_stems && i % 4 == 0)
+      main_dict << "\tz" << i % 9;
+    main_dict << "\n";
+    if (i % 5 == 0) {
+      // a second reading
+      main_dict << chars[i] << "\tt" << i % 7 << "\t" << 10 + i << "\n";
+    }
+  }
+  std::ofstream phrases("dict_compiler_test_phrases.dict.yaml");
+  phrases << "---\n"
+          << "name: dict_compiler_test_phrases\n"
+          << "version: \"1.0\"\n"
+          << "sort: by_weight\n"
+          << "...\n\n";
+  for (int i = 0; i < kNumPhrases; ++i) {
+    if (with_stems && i % 100 == 50) {
+      // encoded by its stem
+      phrases << chars[(i / 100 * 4) % kNumChars] << "\t\t" << i % 89 << "\n";
+    }
+    string phrase = chars[i % kNumChars] + chars[(i / kNumChars) % kNumChars];
+    if (i % 3 == 0)
+      phrase += chars[(i * 7) % kNumChars];
+    phrases << phrase << "\t\t" << i % 97 << "\n";
+  }
+}
+
+static bool Compile(ThreadPool* thread_pool) {
+  Dictionary dict("dict_compiler_test",
+                  New<Table>("dict_compiler_test.table.bin"),
+                  New<Prism>("dict_compiler_test.prism.bin"));
+  DictCompiler compiler(&dict);
+  compiler.set_options(DictCompiler::kRebuild);
+  compiler.set_thread_pool(thread_pool);
+  return compiler.Compile("");
+}
+
+static void ExpectParallelBuildMatchesSerial() {
+  ASSERT_TRUE(Compile(nullptr));
+  vector<string> serial;
+  for (const char* file_name : kOutputFiles) {
+    serial.push_back(ReadFile(file_name));
+    EXPECT_FALSE(serial.back().empty()) << file_name;
+  }
+  ThreadPool thread_pool(4);
+  ASSERT_TRUE(Compile(&thread_pool));
+  for (size_t i = 0; i < serial.size(); ++i) {
+    EXPECT_TRUE(serial[i] == ReadFile(kOutputFiles[i])) << kOutputFiles[i];
+  }
+}
+
+TEST(RimeDictCompilerTest, ParallelBuildMatchesSerial) {
+  WriteDictFiles(false);
+  ExpectParallelBuildMatchesSerial();
+}
+
+// phrases encoded in parallel with words updated earlier in the same batch
+// are encoded again in order
+TEST(RimeDictCompilerTest, ParallelBuildWithWordsUpdatedInBatch) {
+  WriteDictFiles(true);
+  ExpectParallelBuildMatchesSerial();
+}
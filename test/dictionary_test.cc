@@ -102,3 +102,72 @@ TEST_F(RimeDictionaryTest, ScriptLookup) {
   EXPECT_EQ(9, e3->text.length());
   EXPECT_FALSE(d7.Next());
 }
+
+TEST_F(RimeDictionaryTest, ScriptLookupMergesChunksByWeight) {
+  ASSERT_TRUE(dict_->loaded());
+  rime::SyllableGraph g;
+  rime::Syllabifier s;
+  rime::string input("shurufa");
+  ASSERT_TRUE(s.BuildSyllableGraph(input, *dict_->prism(), &g) > 0);
+  auto c = dict_->Lookup(g, 0);
+  ASSERT_TRUE(bool(c));
+  ASSERT_TRUE(c->find(3) != c->end());
+  rime::DictEntryIterator& d3((*c)[3]);
+  size_t count = 0;
+  double previous_weight = 0.0;
+  do {
+    auto e = d3.Peek();
+    ASSERT_TRUE(bool(e));
+    if (count > 0) {
+      EXPECT_LE(e->weight, previous_weight);
+    }
+    previous_weight = e->weight;
+    ++count;
+  } while (d3.Next());
+  EXPECT_EQ(d3.entry_count(), count);
+}
+
+TEST_F(RimeDictionaryTest, PeekedEntryOutlivesIteration) {
+  ASSERT_TRUE(dict_->loaded());
+  rime::DictEntryIterator it;
+  dict_->LookupWords(&it, "z", true);
+  ASSERT_FALSE(it.exhausted());
+  auto view = it.PeekView();
+  ASSERT_TRUE(bool(view));
+  auto first = it.Peek();
+  ASSERT_TRUE(bool(first));
+  EXPECT_EQ(view.text(), first->text);
+  EXPECT_EQ(view.weight(), first->weight);
+  rime::string first_text = first->text;
+  ASSERT_TRUE(it.Next());
+  // storage of a retained entry is never recycled
+  auto second = it.Peek();
+  ASSERT_TRUE(bool(second));
+  EXPECT_NE(first.get(), second.get());
+  EXPECT_EQ(first_text, first->text);
+}
+
+TEST(RimeDictEntryIteratorTest, SkipInChunkOrder) {
+  rime::Table table("dict_entry_iterator_test.table.bin");
+  rime::table::Entry first[2];
+  first[0].weight = 1.0;
+  first[1].weight = 0.2;
+  rime::table::Entry second[2];
+  second[0].weight = 0.9;
+  second[1].weight = 0.8;
+  rime::DictEntryIterator iter;
+  for (const rime::table::Entry* entries : {first, second}) {
+    rime::dictionary::Chunk chunk;
+    chunk.entries = entries;
+    chunk.size = 2;
+    iter.AddChunk(std::move(chunk), &table);
+  }
+  double w = iter.PeekView().weight() - first[0].weight;
+  // entries are yielded by weight, but skipped chunk by chunk
+  ASSERT_TRUE(iter.Skip(2));
+  EXPECT_FLOAT_EQ(w + second[0].weight, iter.PeekView().weight());
+  ASSERT_TRUE(iter.Next());
+  EXPECT_FLOAT_EQ(w + second[1].weight, iter.PeekView().weight());
+  EXPECT_FALSE(iter.Next());
+  EXPECT_FALSE(iter.Skip(1));
+}
@@ -0,0 +1,61 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+#include <gtest/gtest.h>
+#include <rime/gear/grammar.h>
+
+using namespace rime;
+
+namespace {
+
+class CountingGrammar : public Grammar {
+ public:
+  double Query(const string& context,
+               const string& word,
+               bool is_rear) override {
+    ++queries;
+    return -double(context.length() * 10 + word.length()) - is_rear;
+  }
+  int queries = 0;
+};
+
+DictEntry MakeEntry(const string& text) {
+  DictEntry entry;
+  entry.text = text;
+  return entry;
+}
+
+}  // namespace
+
+TEST(RimeGrammarCacheTest, MemoizeScoresByText) {
+  CountingGrammar grammar;
+  GrammarCache cache;
+  DictEntry a(MakeEntry("a")), bc(MakeEntry("bc"));
+  vector<const DictEntry*> entries = {&a, &bc};
+  vector<double> weights;
+  cache.Evaluate("x", entries, false, &grammar, &weights);
+  EXPECT_EQ(2, grammar.queries);
+  ASSERT_EQ(2u, weights.size());
+  EXPECT_EQ(-11.0, weights[0]);
+  EXPECT_EQ(-12.0, weights[1]);
+  cache.Evaluate("x", entries, false, &grammar, &weights);
+  EXPECT_EQ(2, grammar.queries);
+  EXPECT_EQ(-12.0, weights[1]);
+  // a different context, word or position is queried again
+  cache.Evaluate("xy", entries, false, &grammar, &weights);
+  EXPECT_EQ(4, grammar.queries);
+  EXPECT_EQ(-21.0, weights[0]);
+  cache.Evaluate("x", entries, true, &grammar, &weights);
+  EXPECT_EQ(6, grammar.queries);
+  EXPECT_EQ(-12.0, weights[0]);
+  DictEntry d(MakeEntry("d"));
+  entries.push_back(&d);
+  cache.Evaluate("x", entries, false, &grammar, &weights);
+  EXPECT_EQ(7, grammar.queries);
+  EXPECT_EQ(-11.0, weights[2]);
+  cache.Clear();
+  EXPECT_EQ(0u, cache.size());
+  cache.Evaluate("x", entries, false, &grammar, &weights);
+  EXPECT_EQ(10, grammar.queries);
+}
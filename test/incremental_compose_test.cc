@@ -0,0 +1,183 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+#include <sstream>
+#include <gtest/gtest.h>
+#include <rime/candidate.h>
+#include <rime/common.h>
+#include <rime/component.h>
+#include <rime/composition.h>
+#include <rime/config.h>
+#include <rime/context.h>
+#include <rime/engine.h>
+#include <rime/registry.h>
+#include <rime/schema.h>
+#include <rime/segmentation.h>
+#include <rime/segmentor.h>
+#include <rime/translation.h>
+#include <rime/translator.h>
+
+using namespace rime;
+
+// makes a segment of each character
+class CharSegmentor : public Segmentor {
+ public:
+  explicit CharSegmentor(const Ticket& ticket) : Segmentor(ticket) {}
+
+  bool Proceed(Segmentation* segmentation) override {
+    size_t k = segmentation->GetCurrentStartPosition();
+    if (k == segmentation->input().length())
+      return false;
+    Segment segment(k, k + 1);
+    segment.tags.insert("abc");
+    segmentation->AddSegment(segment);
+    return false;
+  }
+};
+
+// translates a segment into its input in upper case, counting the queries
+class CountingTranslator : public Translator {
+ public:
+  CountingTranslator(const Ticket& ticket, int* num_queries)
+      : Translator(ticket), num_queries_(num_queries) {}
+
+  an<Translation> Query(const string& input,
+                        const Segment& segment) override {
+    ++*num_queries_;
+    string text(input);
+    for (char& ch : text) {
+      ch = toupper(ch);
+    }
+    return New<UniqueTranslation>(
+        New<SimpleCandidate>("test", segment.start, segment.end, text));
+  }
+
+ private:
+  int* num_queries_;
+};
+
+class CountingTranslatorComponent : public CountingTranslator::Component {
+ public:
+  explicit CountingTranslatorComponent(int* num_queries)
+      : num_queries_(num_queries) {}
+
+  CountingTranslator* Create(const Ticket& ticket) override {
+    return new CountingTranslator(ticket, num_queries_);
+  }
+
+ private:
+  int* num_queries_;
+};
+
+class RimeIncrementalComposeTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    Registry& r = Registry::instance();
+    r.Register("char_segmentor", new Component<CharSegmentor>);
+    r.Register("counting_translator",
+               new CountingTranslatorComponent(&num_queries_));
+    engine_.reset(Engine::Create());
+    ApplySchema(true);
+    ctx_ = engine_->context();
+  }
+
+  void TearDown() override {
+    engine_.reset();
+    Registry& r = Registry::instance();
+    r.Unregister("char_segmentor");
+    r.Unregister("counting_translator");
+  }
+
+  void ApplySchema(bool incremental_compose) {
+    auto config = new Config;
+    std::istringstream yaml(
+        string("engine:\n") +
+        "  incremental_compose: " +
+        (incremental_compose ? "true" : "false") + "\n"
+        "  segmentors: [char_segmentor]\n"
+        "  translators: [counting_translator]\n");
+    config->LoadFromStream(yaml);
+    engine_->ApplySchema(new Schema("incremental_compose_test", config));
+  }
+
+  // returns the number of queries made for the change
+  template <class Change>
+  int Count(Change change) {
+    num_queries_ = 0;
+    change();
+    return num_queries_;
+  }
+
+  an<Menu> MenuAt(size_t start) {
+    for (const Segment& segment : ctx_->composition()) {
+      if (segment.start == start)
+        return segment.menu;
+    }
+    return nullptr;
+  }
+
+  int num_queries_ = 0;
+  the<Engine> engine_;
+  Context* ctx_ = nullptr;
+};
+
+TEST_F(RimeIncrementalComposeTest, ReuseOnCaretMove) {
+  EXPECT_EQ(4, Count([&] { ctx_->PushInput("abcd"); }));
+  EXPECT_EQ("ABCD", ctx_->GetCommitText());
+  auto menu = MenuAt(3);
+  ASSERT_TRUE(bool(menu));
+  // segments before the caret are kept by the composition
+  EXPECT_EQ(0, Count([&] { ctx_->set_caret_pos(2); }));
+  EXPECT_EQ(2u, ctx_->composition().size());
+  // those dropped are taken back from the engine
+  EXPECT_EQ(0, Count([&] { ctx_->set_caret_pos(4); }));
+  EXPECT_EQ(4u, ctx_->composition().size());
+  EXPECT_EQ(menu, MenuAt(3));
+  EXPECT_EQ("ABCD", ctx_->GetCommitText());
+}
+
+TEST_F(RimeIncrementalComposeTest, TranslateAgainWhenDisabled) {
+  ApplySchema(false);
+  EXPECT_EQ(4, Count([&] { ctx_->PushInput("abcd"); }));
+  EXPECT_EQ(0, Count([&] { ctx_->set_caret_pos(2); }));
+  EXPECT_EQ(2, Count([&] { ctx_->set_caret_pos(4); }));
+}
+
+TEST_F(RimeIncrementalComposeTest, InvalidateOnOptionUpdate) {
+  ctx_->PushInput("abcd");
+  auto menu = MenuAt(3);
+  EXPECT_EQ(4, Count([&] { ctx_->set_option("test_option", true); }));
+  EXPECT_NE(menu, MenuAt(3));
+  EXPECT_EQ(0, Count([&] { ctx_->set_caret_pos(2); }));
+  EXPECT_EQ(0, Count([&] { ctx_->set_caret_pos(4); }));
+}
+
+TEST_F(RimeIncrementalComposeTest, InvalidateOnDeleteCandidate) {
+  // as memory components do after deleting an entry from the user dict
+  ctx_->delete_notifier().connect([](Context* ctx) {
+    ctx->RefreshNonConfirmedComposition();
+  });
+  ctx_->PushInput("abcd");
+  ctx_->set_caret_pos(2);
+  EXPECT_EQ(2, Count([&] { ctx_->DeleteCurrentSelection(); }));
+  // segments translated before the deletion are not brought back
+  EXPECT_EQ(2, Count([&] { ctx_->set_caret_pos(4); }));
+}
+
+TEST_F(RimeIncrementalComposeTest, InvalidateOnCommit) {
+  ctx_->PushInput("abcd");
+  ctx_->set_caret_pos(2);
+  EXPECT_TRUE(ctx_->Commit());
+  EXPECT_EQ(4, Count([&] { ctx_->PushInput("abcd"); }));
+}
+
+TEST_F(RimeIncrementalComposeTest, NoReuseAfterInsertion) {
+  ctx_->PushInput("abcd");
+  ctx_->set_caret_pos(2);
+  EXPECT_EQ(1, Count([&] { ctx_->PushInput('x'); }));
+  EXPECT_EQ("abxcd", ctx_->input());
+  // segments after the insertion have moved, and are translated again
+  EXPECT_EQ(2, Count([&] { ctx_->set_caret_pos(5); }));
+  EXPECT_EQ("ABXCD", ctx_->GetCommitText());
+}
@@ -0,0 +1,101 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+#include <random>
+#include <boost/regex.hpp>
+#include <gtest/gtest.h>
+#include <rime/algo/pattern_set.h>
+
+using namespace rime;
+
+static const char* kSearchPatterns[] = {
+  "^[a-z][-_.0-9a-z]*@.*$",
+  "[A-Z][-_+.'0-9A-Za-z]*$",
+  "^(www[.]|https?:|ftp:|mailto:).*$|^[a-z]+[.].+$",
+  "P:[a-z']*;?$",
+  "`[a-z]*'?$",
+  "^/([0-9]0?|[A-Za-z]+)$",
+  "(?:ab|a)+?b{1,3}$",
+  "[^a-c]\\.\\d*$",
+  "^$",
+};
+
+static const char* kWholePatterns[] = {
+  "z.*",
+  "^yyy.*$",
+  "a(b|c)*d?",
+  "[[:alpha:]]+",  // falls back
+};
+
+static string RandomInput(std::mt19937* rng) {
+  static const char kAlphabet[] = "abcdwz.:@`'/P;A1-_";
+  std::uniform_int_distribution<int> length(0, 8);
+  std::uniform_int_distribution<int> letter(0, sizeof(kAlphabet) - 2);
+  string input;
+  for (int n = length(*rng); n > 0; --n)
+    input += kAlphabet[letter(*rng)];
+  return input;
+}
+
+TEST(RimePatternSetTest, UnsupportedPatterns) {
+  PatternSet patterns;
+  EXPECT_EQ(-1, patterns.Add("(?<![A-Z]):[^;]*;?$"));
+  EXPECT_EQ(-1, patterns.Add("(a)\\1$"));
+  EXPECT_EQ(-1, patterns.Add("\\bword$"));
+  EXPECT_EQ(-1, patterns.Add("a*+$"));
+  // matches are expected to end at the end of input
+  EXPECT_EQ(-1, patterns.Add("abc"));
+  EXPECT_EQ(-1, patterns.Add("^a$|b"));
+  EXPECT_EQ(-1, patterns.Add("a$b$"));
+  EXPECT_EQ(0, patterns.Add("abc", true));
+  EXPECT_EQ(1u, patterns.size());
+}
+
+TEST(RimePatternSetTest, SearchLikeRegex) {
+  PatternSet patterns;
+  vector<boost::regex> regexes;
+  for (const char* pattern : kSearchPatterns) {
+    ASSERT_EQ(int(regexes.size()), patterns.Add(pattern)) << pattern;
+    regexes.push_back(boost::regex(pattern));
+  }
+  ASSERT_TRUE(patterns.Compile());
+  std::mt19937 rng(2024);
+  vector<size_t> starts;
+  for (int i = 0; i < 5000; ++i) {
+    string input = RandomInput(&rng);
+    size_t from = input.empty() ? 0 : rng() % (input.length() + 1);
+    patterns.Match(input, from, &starts);
+    string active_input = input.substr(from);
+    for (size_t k = 0; k < regexes.size(); ++k) {
+      boost::smatch m;
+      size_t expected = boost::regex_search(active_input, m, regexes[k]) ?
+          from + m.position() : string::npos;
+      EXPECT_EQ(expected, starts[k])
+          << kSearchPatterns[k] << " on '" << input << "' from " << from;
+    }
+  }
+}
+
+TEST(RimePatternSetTest, MatchWholeLikeRegex) {
+  PatternSet patterns;
+  vector<int> ids;
+  for (const char* pattern : kWholePatterns) {
+    ids.push_back(patterns.Add(pattern, true));
+  }
+  EXPECT_EQ(-1, ids.back());
+  ASSERT_TRUE(patterns.Compile());
+  std::mt19937 rng(2025);
+  vector<size_t> starts;
+  for (int i = 0; i < 2000; ++i) {
+    string input = RandomInput(&rng);
+    patterns.Match(input, 0, &starts);
+    for (size_t k = 0; k < ids.size(); ++k) {
+      if (ids[k] < 0)
+        continue;
+      bool expected = boost::regex_match(input, boost::regex(kWholePatterns[k]));
+      EXPECT_EQ(expected, starts[ids[k]] == 0)
+          << kWholePatterns[k] << " on '" << input << "'";
+    }
+  }
+}
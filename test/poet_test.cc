@@ -0,0 +1,47 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+#include <gtest/gtest.h>
+#include <rime/candidate.h>
+#include <rime/gear/poet.h>
+#include <rime/gear/translator_commons.h>
+
+using namespace rime;
+
+static void AddEdge(WordGraph* graph, int start, int end,
+                    const string& text, double weight) {
+  auto e = New<DictEntry>();
+  e->text = text;
+  e->weight = weight;
+  (*graph)[start][end].push_back(e);
+}
+
+static WordGraph MakeGraph() {
+  WordGraph graph;
+  const char* words[] = {"a", "b", "c", "d", "e"};
+  for (int i = 0; i < 5; ++i) {
+    AddEdge(&graph, i, i + 1, words[i], -1.0);
+  }
+  AddEdge(&graph, 1, 3, "BC", -0.5);
+  AddEdge(&graph, 3, 5, "DE", -3.0);
+  return graph;
+}
+
+TEST(RimePoetTest, ResumeInterruptedSentence) {
+  WordGraph graph = MakeGraph();
+  Poet expected_poet(nullptr, nullptr);
+  auto expected = expected_poet.MakeSentence(graph, 5, "");
+  ASSERT_TRUE(bool(expected));
+
+  Poet poet(nullptr, nullptr);
+  int checks = 0;
+  auto interrupted = [&checks] { return ++checks > 3; };
+  EXPECT_FALSE(bool(poet.MakeSentence(graph, 5, "", 0, interrupted)));
+  EXPECT_EQ(4, checks);
+  // the graph is unchanged, so all of it is stable
+  auto sentence = poet.MakeSentence(graph, 5, "", 5);
+  ASSERT_TRUE(bool(sentence));
+  EXPECT_EQ(expected->text(), sentence->text());
+  EXPECT_DOUBLE_EQ(expected->weight(), sentence->weight());
+}
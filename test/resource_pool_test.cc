@@ -0,0 +1,129 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+#include <gtest/gtest.h>
+#include <rime/resource_pool.h>
+
+using namespace rime;
+
+namespace {
+
+struct Resource {
+  size_t size;
+};
+
+class RimeResourcePoolTest : public ::testing::Test {
+ protected:
+  RimeResourcePoolTest()
+      : pool_("resource", [](const Resource& r) { return r.size; }) {}
+
+  an<Resource> Get(const string& name, size_t size, size_t budget) {
+    return pool_.Get(name, [&] {
+      ++created_;
+      return New<Resource>(Resource{size});
+    }, budget);
+  }
+
+  ResourcePool<Resource> pool_;
+  int created_ = 0;
+};
+
+}  // namespace
+
+TEST_F(RimeResourcePoolTest, ShareResourceInUse) {
+  auto a = Get("a", 10, 0);
+  auto b = Get("a", 10, 0);
+  EXPECT_EQ(a, b);
+  EXPECT_EQ(1, created_);
+  a.reset();
+  b.reset();
+  Get("a", 10, 0);
+  EXPECT_EQ(2, created_);
+}
+
+TEST_F(RimeResourcePoolTest, KeepIdleResourcesWithinBudget) {
+  Get("a", 10, 25);
+  Get("b", 10, 25);
+  Get("a", 10, 25);
+  Get("c", 10, 25);
+  EXPECT_EQ(3, created_);
+  // idle resources exceed the budget; the least recently used "b" goes
+  Get("d", 10, 25);
+  EXPECT_EQ(4, created_);
+  Get("a", 10, 25);
+  Get("c", 10, 25);
+  EXPECT_EQ(4, created_);
+  Get("b", 10, 25);
+  EXPECT_EQ(5, created_);
+}
+
+TEST_F(RimeResourcePoolTest, ShareBudgetAmongPools) {
+  ResourcePool<Resource> other_pool(
+      "other_resource", [](const Resource& r) { return r.size; });
+  int other_created = 0;
+  auto get_other = [&](const string& name, size_t size) {
+    return other_pool.Get(name, [&] {
+      ++other_created;
+      return New<Resource>(Resource{size});
+    }, 25);
+  };
+  Get("a", 10, 25);
+  get_other("b", 10);
+  Get("c", 10, 25);
+  EXPECT_EQ(2, created_);
+  EXPECT_EQ(1, other_created);
+  // idle resources of both pools exceed the budget; the least recently
+  // used "a" goes to make room for "d" of the other pool
+  get_other("d", 10);
+  Get("c", 10, 25);
+  get_other("b", 10);
+  EXPECT_EQ(2, created_);
+  EXPECT_EQ(2, other_created);
+  Get("a", 10, 25);
+  EXPECT_EQ(3, created_);
+}
+
+TEST_F(RimeResourcePoolTest, KeepPinnedResources) {
+  {
+    ResourcePinning pinning;
+    Get("a", 10, 0);
+  }
+  Get("b", 10, 0);
+  Get("a", 10, 0);
+  EXPECT_EQ(2, created_);
+  ResourcePoolBase::Invalidate("resource", "a");
+  Get("a", 10, 0);
+  EXPECT_EQ(3, created_);
+}
+
+TEST(RimeResourcePoolUnsizedTest, DoNotPinResourcesOfUnknownSize) {
+  ResourcePool<Resource> pool("unsized_resource");
+  int created = 0;
+  auto create = [&] {
+    ++created;
+    return New<Resource>(Resource{10});
+  };
+  {
+    ResourcePinning pinning;
+    pool.Get("a", create, 100);
+  }
+  // eg. a user db is closed once no longer in use
+  pool.Get("a", create, 100);
+  EXPECT_EQ(2, created);
+}
+
+TEST_F(RimeResourcePoolTest, InvalidateByName) {
+  auto a = Get("a", 10, 0);
+  auto b = Get("b", 10, 0);
+  ResourcePoolBase::Invalidate("resource", "a");
+  // other kinds of resources under the same name are not affected
+  ResourcePoolBase::Invalidate("other_resource", "b");
+  // the user of the stale instance keeps it, new users get a fresh one
+  auto a2 = Get("a", 10, 0);
+  EXPECT_NE(a, a2);
+  EXPECT_EQ(a2, Get("a", 10, 0));
+  // resources in use under other names are still shared
+  EXPECT_EQ(b, Get("b", 10, 0));
+  EXPECT_EQ(3, created_);
+}
@@ -0,0 +1,64 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+#include <gtest/gtest.h>
+#include <rime/segment_tags.h>
+
+using namespace rime;
+
+TEST(RimeSegmentTagsTest, InternTagNames) {
+  TagId abc = TagRegistry::Intern("abc");
+  EXPECT_LE(0, abc);
+  EXPECT_EQ(abc, TagRegistry::Intern("abc"));
+  EXPECT_EQ(abc, TagRegistry::Find("abc"));
+  EXPECT_EQ("abc", TagRegistry::Name(abc));
+  EXPECT_NE(abc, TagRegistry::Intern("segment_tags_test"));
+  EXPECT_EQ(-1, TagRegistry::Find("segment_tags_test_unknown"));
+}
+
+TEST(RimeSegmentTagsTest, InsertAndErase) {
+  SegmentTags tags;
+  EXPECT_TRUE(tags.empty());
+  tags.insert("abc");
+  tags.insert(TagRegistry::Intern("punct"));
+  tags.insert("abc");
+  EXPECT_EQ(2u, tags.size());
+  EXPECT_TRUE(tags.Has("abc"));
+  EXPECT_TRUE(tags.Has(TagRegistry::Find("punct")));
+  EXPECT_EQ(1u, tags.count("punct"));
+  EXPECT_FALSE(tags.Has("segment_tags_test_unknown"));
+  EXPECT_TRUE(tags.find("raw") == tags.end());
+  tags.erase("abc");
+  tags.erase("segment_tags_test_unknown");
+  EXPECT_EQ(1u, tags.size());
+  EXPECT_FALSE(tags.Has("abc"));
+  tags.clear();
+  EXPECT_TRUE(tags.empty());
+}
+
+TEST(RimeSegmentTagsTest, ManyTags) {
+  SegmentTags tags;
+  set<string> names;
+  for (int i = 0; i < 200; i += 3) {
+    string name = "segment_tags_test_" + std::to_string(i);
+    tags.insert(name);
+    names.insert(name);
+  }
+  EXPECT_EQ(names.size(), tags.size());
+  set<string> iterated;
+  TagId last = -1;
+  for (auto it = tags.begin(); it != tags.end(); ++it) {
+    EXPECT_LT(last, it.id());
+    last = it.id();
+    iterated.insert(*it);
+  }
+  EXPECT_EQ(names, iterated);
+  SegmentTags copy;
+  copy.insert(tags);
+  EXPECT_TRUE(copy == tags);
+  for (const string& name : names) {
+    copy.erase(name);
+  }
+  EXPECT_TRUE(copy.empty());
+}
@@ -0,0 +1,200 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <gtest/gtest.h>
+#include <rime_api.h>
+#include <rime/context.h>
+#include <rime/deployer.h>
+#include <rime/engine.h>
+#include <rime/key_event.h>
+#include <rime/schema.h>
+#include <rime/service.h>
+#include <rime/setup.h>
+
+using namespace rime;
+
+TEST(RimeServiceTest, ConcurrentSessions) {
+  const int kNumThreads = 8;
+  const int kNumRounds = 10;
+  const int kNumKeys = 100;
+  Service& service(Service::instance());
+  service.StartService();
+  std::atomic<int> failures{0};
+  std::atomic<bool> running{true};
+  // recycles stale sessions while others are being used
+  std::thread cleaner([&] {
+    while (running) {
+      service.CleanupStaleSessions();
+      std::this_thread::yield();
+    }
+  });
+  vector<std::thread> clients;
+  for (int i = 0; i < kNumThreads; ++i) {
+    clients.emplace_back([&] {
+      for (int round = 0; round < kNumRounds; ++round) {
+        SessionId id = service.CreateSession();
+        if (id == kInvalidSessionId) {
+          ++failures;
+          continue;
+        }
+        for (int k = 0; k < kNumKeys; ++k) {
+          an<Session> session = service.GetSession(id);
+          if (!session) {
+            ++failures;
+            break;
+          }
+          std::lock_guard<SessionMutex> lock(session->mutex());
+          session->ProcessKey(KeyEvent('a' + k % 26, 0));
+          if (!session->context()) {
+            ++failures;
+          }
+        }
+        if (!service.DestroySession(id)) {
+          ++failures;
+        }
+      }
+    });
+  }
+  for (auto& client : clients) {
+    client.join();
+  }
+  running = false;
+  cleaner.join();
+  EXPECT_EQ(0, failures);
+  service.CleanupAllSessions();
+  service.StopService();
+}
+
+TEST(RimeServiceTest, BackgroundTasks) {
+  Service& service(Service::instance());
+  service.StartService();
+  SessionId id = service.CreateSession();
+  ASSERT_NE(kInvalidSessionId, id);
+  std::promise<bool> done;
+  service.PostTask(id, [&] { done.set_value(true); });
+  auto result = done.get_future();
+  ASSERT_EQ(std::future_status::ready,
+            result.wait_for(std::chrono::seconds(5)));
+  EXPECT_TRUE(result.get());
+  // tasks for a destroyed session are dropped
+  EXPECT_TRUE(service.DestroySession(id));
+  std::atomic<bool> ran{false};
+  service.PostTask(id, [&] { ran = true; });
+  std::promise<void> flushed;
+  SessionId other = service.CreateSession();
+  // session ids are not reused
+  EXPECT_NE(id, other);
+  service.PostTask(other, [&] { flushed.set_value(); });
+  ASSERT_EQ(std::future_status::ready,
+            flushed.get_future().wait_for(std::chrono::seconds(5)));
+  EXPECT_FALSE(ran);
+  service.CleanupAllSessions();
+  service.StopService();
+}
+
+TEST(RimeServiceTest, EngineCancelsPendingTasks) {
+  vector<Engine::Task> queued;
+  the<Engine> engine(Engine::Create());
+  engine->set_task_runner([&](Engine::Task task) { queued.push_back(task); });
+  int ran = 0;
+  ASSERT_TRUE(engine->PostTask([&] { ++ran; }));
+  queued.back()();
+  EXPECT_EQ(1, ran);
+  // posted before a schema change
+  ASSERT_TRUE(engine->PostTask([&] { ++ran; }));
+  engine->ApplySchema(new Schema);
+  queued.back()();
+  EXPECT_EQ(1, ran);
+  // posted by a destroyed engine
+  ASSERT_TRUE(engine->PostTask([&] { ++ran; }));
+  engine.reset();
+  queued.back()();
+  EXPECT_EQ(1, ran);
+}
+
+// types into sessions of a deployed schema from several threads, while
+// another thread walks their candidate lists. Sessions share the user
+// dictionary. Build with ENABLE_TSAN to check for data races.
+TEST(RimeServiceTest, ConcurrentTyping) {
+  const int kNumThreads = 4;
+  const int kNumRounds = 20;
+  const char* kKeySequences[] = {
+    "bai",
+    "baitian{space}",
+    "banfa{BackSpace}{BackSpace}{Return}",
+    "bangzhu{Down}{Left}{space}",
+    "baoxian{Escape}",
+    "bei'jing{Page_Down}{Page_Up}{Home}{End}2",
+  };
+  LoadModules(kDeployerModules);
+  Service& service(Service::instance());
+  service.StartService();
+  ASSERT_TRUE(service.deployer().RunTask("schema_update",
+                                         string("typing_test.schema.yaml")));
+  std::atomic<int> failures{0};
+  std::atomic<bool> running{true};
+  std::mutex sessions_mutex;
+  vector<RimeSessionId> sessions;
+  vector<std::thread> typists;
+  for (int i = 0; i < kNumThreads; ++i) {
+    typists.emplace_back([&] {
+      RimeSessionId id = RimeCreateSession();
+      if (!id || !RimeSelectSchema(id, "typing_test")) {
+        ++failures;
+        return;
+      }
+      {
+        std::lock_guard<std::mutex> lock(sessions_mutex);
+        sessions.push_back(id);
+      }
+      for (int round = 0; round < kNumRounds; ++round) {
+        for (const char* keys : kKeySequences) {
+          if (!RimeSimulateKeySequence(id, keys))
+            ++failures;
+          RIME_STRUCT(RimeCommit, commit);
+          if (RimeGetCommit(id, &commit))
+            RimeFreeCommit(&commit);
+        }
+        RimeClearComposition(id);
+      }
+    });
+  }
+  // walks the candidate lists of sessions that are being typed into
+  std::thread reader([&] {
+    while (running) {
+      vector<RimeSessionId> ids;
+      {
+        std::lock_guard<std::mutex> lock(sessions_mutex);
+        ids = sessions;
+      }
+      for (RimeSessionId id : ids) {
+        RimeCandidateListIterator iterator = {0};
+        if (RimeCandidateListBegin(id, &iterator)) {
+          for (int k = 0; k < 20 && RimeCandidateListNext(&iterator); ++k) {
+            if (!iterator.candidate.text)
+              ++failures;
+          }
+          RimeCandidateListEnd(&iterator);
+        }
+      }
+      std::this_thread::yield();
+    }
+  });
+  for (auto& typist : typists) {
+    typist.join();
+  }
+  running = false;
+  reader.join();
+  EXPECT_EQ(0, failures);
+  for (RimeSessionId id : sessions) {
+    EXPECT_TRUE(RimeDestroySession(id));
+  }
+  service.CleanupAllSessions();
+  service.StopService();
+}
@@ -160,3 +160,80 @@ TEST_F(RimeSyllabifierTest, TransposedSyllableGraph) {
   ASSERT_FALSE(NULL == g.indices[0][syllable_id_["chan"]][0]);
   EXPECT_EQ(4, g.indices[0][syllable_id_["chan"]][0]->end_pos);
 }
+
+TEST_F(RimeSyllabifierTest, FlatSyllableGraph) {
+  rime::Syllabifier s;
+  rime::SyllableGraph g;
+  const rime::string input("changan");
+  s.BuildSyllableGraph(input, *prism_, &g);
+  const rime::FlatSyllableGraph& f(g.flat());
+  ASSERT_EQ(input.length() + 1, f.vertices.size());
+  EXPECT_TRUE(f.HasVertex(0));
+  EXPECT_FALSE(f.HasVertex(1));
+  EXPECT_TRUE(f.HasVertex(4));
+  EXPECT_TRUE(f.HasVertex(5));
+  EXPECT_TRUE(f.HasVertex(7));
+  // chan, chang sorted by end position
+  ASSERT_EQ(2, f.edges_end(0) - f.edges_begin(0));
+  EXPECT_EQ(syllable_id_["chan"], f.edges_begin(0)[0].syllable_id);
+  EXPECT_EQ(4, f.edges_begin(0)[0].properties.end_pos);
+  EXPECT_EQ(syllable_id_["chang"], f.edges_begin(0)[1].syllable_id);
+  EXPECT_EQ(5, f.edges_begin(0)[1].properties.end_pos);
+  EXPECT_EQ(f.edges_begin(1), f.edges_end(1));
+  // gan$
+  auto gan = f.FindEdge(4, 7, syllable_id_["gan"]);
+  ASSERT_FALSE(NULL == gan);
+  EXPECT_EQ(rime::kNormalSpelling, gan->properties.type);
+  EXPECT_TRUE(NULL == f.FindEdge(4, 7, syllable_id_["an"]));
+  EXPECT_FALSE(NULL == f.FindEdge(5, 7, syllable_id_["an"]));
+}
+
+TEST(RimeSyllableGraphTest, Flatten) {
+  rime::SyllableGraph g;
+  g.input_length = 4;
+  g.interpreted_length = 4;
+  g.vertices[0] = rime::kNormalSpelling;
+  g.vertices[2] = rime::kNormalSpelling;
+  g.edges[0][2][1].type = rime::kNormalSpelling;
+  // nothing is made of a graph that has not been flattened
+  EXPECT_FALSE(g.flat().HasVertex(0));
+  g.Flatten();
+  const rime::FlatSyllableGraph& f(g.flat());
+  EXPECT_TRUE(f.HasVertex(2));
+  EXPECT_FALSE(f.HasVertex(4));
+  EXPECT_FALSE(NULL == f.FindEdge(0, 2, 1));
+  // changes to the map-based view take effect when flattened again
+  g.vertices[4] = rime::kNormalSpelling;
+  g.edges[2][4][2].type = rime::kNormalSpelling;
+  g.Flatten();
+  EXPECT_TRUE(g.flat().HasVertex(4));
+  EXPECT_FALSE(NULL == g.flat().FindEdge(2, 4, 2));
+}
+
+TEST_F(RimeSyllabifierTest, ReuseSpellingsOfPreviousInput) {
+  rime::Syllabifier s, t, u;
+  rime::SyllableGraph g, h, k;
+  s.BuildSyllableGraph("changa", *prism_, &g);
+  s.BuildSyllableGraph("changan", *prism_, &g);
+  t.TakeMatches(&s);
+  t.BuildSyllableGraph("changanhan", *prism_, &h);
+  u.BuildSyllableGraph("changanhan", *prism_, &k);
+  EXPECT_EQ(k.interpreted_length, h.interpreted_length);
+  EXPECT_EQ(k.vertices, h.vertices);
+  EXPECT_EQ(k.interpreted_length, h.CommonPrefixLength(k));
+  EXPECT_EQ(k.flat().edges.size(), h.flat().edges.size());
+}
+
+TEST_F(RimeSyllabifierTest, CommonPrefixLength) {
+  rime::Syllabifier s;
+  rime::SyllableGraph g, h, k;
+  s.BuildSyllableGraph("changan", *prism_, &g);
+  s.BuildSyllableGraph("changanhan", *prism_, &h);
+  s.BuildSyllableGraph("chang", *prism_, &k);
+  EXPECT_EQ(g.interpreted_length, g.CommonPrefixLength(g));
+  // the longer input only adds edges from the end of the shorter one
+  EXPECT_EQ(7, g.CommonPrefixLength(h));
+  EXPECT_EQ(7, h.CommonPrefixLength(g));
+  // chan' is no longer a valid path in 'chang'
+  EXPECT_EQ(0, g.CommonPrefixLength(k));
+}
@@ -4,6 +4,7 @@
 //
 // 2011-07-03 GONG Chen <chen.sst@gmail.com>
 //
+#include <fstream>
 #include <gtest/gtest.h>
 #include <rime/algo/syllabifier.h>
 #include <rime/dict/table.h>
@@ -181,25 +182,26 @@ TEST_F(RimeTableTest, QueryWithSyllableGraph) {
   g.indices[2][2].push_back(&g.edges[2][4][2]);
   g.indices[4][3].push_back(&g.edges[4][7][3]);
   g.indices[7][4].push_back(&g.edges[7][9][4]);
+  g.Flatten();
 
   rime::TableQueryResult result;
   ASSERT_TRUE(table_->Query(g, 0, &result));
   EXPECT_EQ(2, result.size());
-  ASSERT_TRUE(result.find(2) != result.end());
+  ASSERT_TRUE(result.Has(2));
   ASSERT_EQ(1, result[2].size());
   EXPECT_STREQ("yi", Text(result[2].front()).c_str());
-  ASSERT_TRUE(result.find(7) != result.end());
+  ASSERT_TRUE(result.Has(7));
   ASSERT_EQ(2, result[7].size());
   EXPECT_STREQ("yi-er-san", Text(result[7].front()).c_str());
   EXPECT_STREQ("yi-er-san-si", Text(result[7].back()).c_str());
   ASSERT_EQ(1, result[7].back().extra_code()->size);
   EXPECT_EQ(4, result[7].back().extra_code()->at[0]);
-  ASSERT_TRUE(result.find(6) == result.end());
-  ASSERT_TRUE(result.find(7) != result.end());
+  ASSERT_FALSE(result.Has(6));
+  ASSERT_TRUE(result.Has(7));
 
   ASSERT_TRUE(table_->Query(g, 2, &result));
   EXPECT_EQ(1, result.size());
-  ASSERT_TRUE(result.find(4) != result.end());
+  ASSERT_TRUE(result.Has(4));
   ASSERT_EQ(1, result[4].size());
   EXPECT_STREQ("er", Text(result[4].front()).c_str());
   EXPECT_TRUE(result[4].front().Next());
@@ -208,3 +210,50 @@ TEST_F(RimeTableTest, QueryWithSyllableGraph) {
   EXPECT_STREQ("lia", Text(result[4].front()).c_str());
   EXPECT_FALSE(result[4].front().Next());
 }
+
+// a table of the previous format has no short string area, and refers to
+// all strings by their ids in the string table.
+// as long strings are stored that way in both formats, a table holding
+// none but long strings is a valid v4 table once its format is changed.
+TEST_F(RimeTableTest, LoadTableOfFormatV4) {
+  const char v4_file_name[] = "table_v4_test.bin";
+  {
+    rime::Table table(v4_file_name);
+    table.Remove();
+    rime::Syllabary syll;
+    syll.insert("alpha");
+    syll.insert("bravo");
+    rime::Vocabulary voc;
+    auto d = rime::New<rime::DictEntry>();
+    d->code.push_back(0);
+    d->text = "alpha-one";
+    d->weight = 1.0;
+    voc[0].entries.push_back(d);
+    d = rime::New<rime::DictEntry>(*d);
+    d->code.back() = 1;
+    d->text = "bravo-two";
+    voc[1].entries.push_back(d);
+    ASSERT_TRUE(table.Build(syll, voc, 2));
+    ASSERT_TRUE(table.Save());
+    table.Close();
+  }
+  {
+    std::fstream file(v4_file_name,
+                      std::ios::in | std::ios::out | std::ios::binary);
+    const char kFormatV4[rime::table::Metadata::kFormatMaxLength] =
+        "Rime::Table/4.0";
+    file.write(kFormatV4, sizeof(kFormatV4));
+    ASSERT_TRUE(file.good());
+  }
+  rime::Table table(v4_file_name);
+  ASSERT_TRUE(table.Load());
+  EXPECT_EQ("alpha", table.GetSyllableById(0));
+  EXPECT_EQ("bravo", table.GetSyllableById(1));
+  rime::TableAccessor v = table.QueryWords(1);
+  ASSERT_FALSE(v.exhausted());
+  EXPECT_EQ("bravo-two", table.GetEntryText(*v.entry()));
+  // alongside the v5 table of the fixture, with short strings inline
+  v = table_->QueryWords(1);
+  ASSERT_FALSE(v.exhausted());
+  EXPECT_EQ("yi", Text(v));
+}
@@ -0,0 +1,43 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+#include <gtest/gtest.h>
+#include <rime/candidate.h>
+#include <rime/text_index.h>
+#include <rime/translation.h>
+
+using namespace rime;
+
+TEST(RimeTextIndexTest, FindAddedTexts) {
+  vector<string> texts;
+  TextIndex index;
+  auto text_of = [&](int i) -> const string& { return texts[i]; };
+  for (int i = 0; i < 1000; ++i) {
+    texts.push_back(std::to_string(i * 7));
+    index.Add(texts.back(), i);
+  }
+  EXPECT_EQ(1000u, index.size());
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_EQ(i, index.Find(std::to_string(i * 7), text_of));
+  }
+  EXPECT_EQ(-1, index.Find("1", text_of));
+  EXPECT_EQ(-1, index.Find("", text_of));
+  index.Clear();
+  EXPECT_TRUE(index.empty());
+  EXPECT_EQ(-1, index.Find("0", text_of));
+}
+
+TEST(RimeTextIndexTest, DistinctTranslation) {
+  auto fifo = New<FifoTranslation>();
+  for (const char* text : {"a", "b", "a", "c", "b", "a", "d"}) {
+    fifo->Append(New<SimpleCandidate>("test", 0, 1, text));
+  }
+  DistinctTranslation distinct(fifo);
+  string result;
+  while (!distinct.exhausted()) {
+    result += distinct.Peek()->text();
+    distinct.Next();
+  }
+  EXPECT_EQ("abcd", result);
+}
@@ -0,0 +1,111 @@
+//
+// Copyright RIME Developers
+// Distributed under the BSD License
+//
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <gtest/gtest.h>
+#include <rime/thread_pool.h>
+
+using namespace rime;
+
+TEST(RimeThreadPoolTest, RunTaskGroup) {
+  ThreadPool pool(3);
+  vector<int> results(100);
+  TaskGroup group(&pool);
+  for (int i = 0; i < 100; ++i) {
+    group.Run([i, &results] { results[i] = i * i; });
+  }
+  group.Wait();
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(i * i, results[i]);
+  }
+}
+
+TEST(RimeThreadPoolTest, ConcurrentAndNestedGroups) {
+  ThreadPool pool(2);
+  std::atomic<int> count{0};
+  vector<std::thread> clients;
+  for (int k = 0; k < 4; ++k) {
+    clients.emplace_back([&] {
+      for (int round = 0; round < 50; ++round) {
+        TaskGroup group(&pool);
+        for (int i = 0; i < 4; ++i) {
+          group.Run([&] {
+            // waiting on a worker thread must not deadlock
+            TaskGroup nested(&pool);
+            nested.Run([&] { ++count; });
+            nested.Wait();
+          });
+        }
+      }
+    });
+  }
+  for (auto& client : clients) {
+    client.join();
+  }
+  EXPECT_EQ(4 * 50 * 4, count);
+}
+
+// blocks the only worker of a pool until released
+class BusyWorker {
+ public:
+  explicit BusyWorker(ThreadPool* pool) : group_(pool) {
+    group_.Run([this] {
+      started_ = true;
+      while (!released_) {
+        std::this_thread::yield();
+      }
+    });
+    while (!started_) {
+      std::this_thread::yield();
+    }
+  }
+  ~BusyWorker() {
+    released_ = true;
+    group_.Wait();
+  }
+
+ private:
+  std::atomic<bool> started_{false};
+  std::atomic<bool> released_{false};
+  TaskGroup group_;
+};
+
+TEST(RimeThreadPoolTest, WaitOnlyRunsTasksOfTheGroup) {
+  ThreadPool pool(1);
+  std::atomic<bool> other_task_done{false};
+  TaskGroup other(&pool);
+  {
+    BusyWorker busy(&pool);
+    other.Run([&] { other_task_done = true; });
+    TaskGroup group(&pool);
+    std::thread::id task_thread;
+    group.Run([&] { task_thread = std::this_thread::get_id(); });
+    group.Wait();
+    EXPECT_EQ(std::this_thread::get_id(), task_thread);
+    // left in the queue of the busy worker
+    EXPECT_FALSE(other_task_done);
+  }
+  other.Wait();
+  EXPECT_TRUE(other_task_done);
+}
+
+TEST(RimeThreadPoolTest, TaskThrowingOnWaitingThread) {
+  ThreadPool pool(1);
+  BusyWorker busy(&pool);
+  bool caught = false;
+  {
+    TaskGroup group(&pool);
+    group.Run([] { throw std::runtime_error("failed task"); });
+    try {
+      group.Wait();
+    }
+    catch (const std::runtime_error&) {
+      caught = true;
+    }
+    // the group is done, or this would never return
+  }
+  EXPECT_TRUE(caught);
+}
@@ -40,6 +40,26 @@ TEST(RimeUserDbTest, AccessRecordByKey) {
   ASSERT_FALSE(db.loaded());
 }
 
+TEST(RimeUserDbTest, RevisionCountsChanges) {
+  TestDb db("user_db_test");
+  if (db.Exists())
+    db.Remove();
+  db.Open();
+  auto revision = db.revision();
+  string value;
+  EXPECT_FALSE(db.Fetch("abc", &value));
+  EXPECT_EQ(revision, db.revision());
+  EXPECT_TRUE(db.Update("abc", "ZYX"));
+  EXPECT_NE(revision, db.revision());
+  revision = db.revision();
+  EXPECT_TRUE(db.Erase("abc"));
+  EXPECT_NE(revision, db.revision());
+  revision = db.revision();
+  EXPECT_FALSE(db.Erase("abc"));
+  EXPECT_EQ(revision, db.revision());
+  EXPECT_TRUE(db.Close());
+}
+
 TEST(RimeUserDbTest, Query) {
   TestDb db("user_db_test");
   if (db.Exists())
@@ -89,3 +109,33 @@ TEST(RimeUserDbTest, Query) {
   }
   db.Close();
 }
+
+TEST(RimeUserDbValueTest, PackAndUnpack) {
+  UserDbValue v;
+  v.commits = -3;
+  v.dee = 1.234;
+  v.tick = 5678;
+  string text = v.Pack();
+  EXPECT_EQ("c=-3 d=1.234 t=5678", text);
+  EXPECT_FALSE(UserDbValue::IsBinary(text));
+  string binary = v.PackBinary();
+  EXPECT_TRUE(UserDbValue::IsBinary(binary));
+  EXPECT_LT(binary.length(), text.length());
+  for (const string& packed : {text, binary}) {
+    UserDbValue u;
+    EXPECT_TRUE(u.Unpack(packed));
+    EXPECT_EQ(-3, u.commits);
+    EXPECT_DOUBLE_EQ(1.234, u.dee);
+    EXPECT_EQ(TickCount(5678), u.tick);
+  }
+  UserDbValue u;
+  EXPECT_FALSE(u.Unpack(binary.substr(0, 3)));
+  EXPECT_FALSE(u.Unpack(binary + "x"));
+  EXPECT_FALSE(u.Unpack("c=x"));
+  EXPECT_FALSE(u.Unpack("c=2 garbage"));
+  // a failed parse leaves the fields alone
+  EXPECT_FALSE(u.Unpack("c=2 d=1.5 t=x"));
+  EXPECT_EQ(0, u.commits);
+  EXPECT_EQ(0.0, u.dee);
+  EXPECT_EQ(TickCount(0), u.tick);
+}